@@ -28,6 +28,7 @@ else()
 endif()
 
 find_package(OpenGL REQUIRED)
+find_package(Threads REQUIRED)
 find_package(GLEW REQUIRED)
 find_package(glfw3 REQUIRED)
 find_package(glm REQUIRED)
@@ -5,11 +5,21 @@
 // constants
 uniform mat4 view_projection_matrix;
 
+#ifdef INSTANCED_SPRITES
+uniform usampler2D tex_0;
+
+// per instance attributes
+in vec3 in_pos0; // first corner position on ground plane and depth
+in vec4 in_pos1; // width and height axes on ground plane
+in vec4 in_texcoord0; // u0, v0, u1, v1
+in uint in_color0; // palette index
+#else
 // attributes
 in vec3 in_pos0;
 in vec2 in_texcoord0;
 in uint in_color0; // palette index
 in uvec2 in_textureSize; // sprite texture size in pixels
+#endif
 
 // pass to fragment shader
 out vec2 Texcoord;
@@ -18,6 +28,24 @@ flat out uint PaletteIndex;
 out vec2 SpriteTextureSize;
 out vec2 SpriteTexelSize;
 
+#ifdef INSTANCED_SPRITES
+// entry point
+void main() 
+{
+    // quad corners are indexed 0, 1, 2, 1, 2, 3
+    vec2 cornerFactors = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    vec2 cornerPosition = in_pos0.xy + in_pos1.xy * cornerFactors.x + in_pos1.zw * cornerFactors.y;
+
+    Texcoord = mix(in_texcoord0.xy, in_texcoord0.zw, cornerFactors);
+    Position = vec3(cornerPosition.x, in_pos0.z, cornerPosition.y);
+    PaletteIndex = in_color0;
+    SpriteTextureSize = vec2(textureSize(tex_0, 0));
+    SpriteTexelSize = vec2(1.0 / SpriteTextureSize.x, 1.0 / SpriteTextureSize.y);
+
+    vec4 vertexPosition = view_projection_matrix * vec4(Position, 1.0);
+    gl_Position = vertexPosition;
+}
+#else
 // entry point
 void main() 
 {
@@ -30,6 +58,7 @@ void main()
     vec4 vertexPosition = view_projection_matrix * vec4(in_pos0, 1.0);
     gl_Position = vertexPosition;
 }
+#endif
 
 #endif
 
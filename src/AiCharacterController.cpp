@@ -132,7 +132,7 @@ bool AiCharacterController::ScanForExplosions()
 
     BroadcastEvent eventData;
     glm::vec2 position2 = mCharacter->mTransform.GetPosition2();
-    if (gBroadcastEvents.PeekClosestEvent(eBroadcastEvent_Explosion, position2, eventData))
+    if (gBroadcastEvents.PeekClosestEvent(eBroadcastEvent_Explosion, position2, gGameParams.mAiReactOnExplosionsDistance, eventData))
     {
         if (glm::distance2(eventData.mPosition, position2) > reactionDistance2) // too far away
             return false;
@@ -148,7 +148,7 @@ bool AiCharacterController::ScanForGunshots()
 
     BroadcastEvent eventData;
     glm::vec2 position2 = mCharacter->mTransform.GetPosition2();
-    if (gBroadcastEvents.PeekClosestEvent(eBroadcastEvent_GunShot, position2, eventData))
+    if (gBroadcastEvents.PeekClosestEvent(eBroadcastEvent_GunShot, position2, gGameParams.mAiReactOnGunshotsDistance, eventData))
     {
         if (eventData.mCharacter == mCharacter) // hear own gunshots
             return false; 
@@ -161,7 +161,48 @@ bool AiCharacterController::ScanForGunshots()
     return false;
 }
 
-void AiCharacterController::OnCharacterUpdateFrame()
+void AiCharacterController::ThinkFrame(cxx::randomizer& thinkRand)
+{
+    mThinkRand = &thinkRand;
+    UpdateActivity();
+    mThinkRand = nullptr;
+}
+
+void AiCharacterController::ApplyThinkActions()
+{
+    if (mFollowTargetChanged)
+    {
+        mFollowPedestrian = mNextFollowTarget;
+        mNextFollowTarget = nullptr;
+        mFollowTargetChanged = false;
+    }
+
+    if (mLeaveCar)
+    {
+        mLeaveCar = false;
+        if (mCharacter->IsCarDriver())
+        {
+            mCharacter->LeaveCar();
+        }
+    }
+}
+
+void AiCharacterController::SetFollowTarget(Pedestrian* pedestrian)
+{
+    // assigning handle modifies target object so it is deferred
+    mNextFollowTarget = pedestrian;
+    mFollowTargetChanged = true;
+}
+
+Pedestrian* AiCharacterController::GetFollowTarget() const
+{
+    if (mFollowTargetChanged)
+        return mNextFollowTarget;
+
+    return mFollowPedestrian;
+}
+
+void AiCharacterController::UpdateActivity()
 {
     // choose current activity
     if (mAiMode == ePedestrianAiMode_None)
@@ -261,7 +302,7 @@ void AiCharacterController::UpdateWandering()
 void AiCharacterController::StartPanic()
 {
     mAiMode = ePedestrianAiMode_Panic;
-    mFollowPedestrian.reset();
+    SetFollowTarget(nullptr);
 
     mRunToTarget = true;
 
@@ -275,7 +316,7 @@ void AiCharacterController::StartPanic()
 void AiCharacterController::StartWandering()
 {
     mAiMode = ePedestrianAiMode_Wandering;
-    mFollowPedestrian.reset();
+    SetFollowTarget(nullptr);
 
     mCtlState.Clear();
     if (!ChooseWalkWaypoint(false) || !ContinueWalkToWaypoint(mDefaultNearDistance))
@@ -300,32 +341,47 @@ bool AiCharacterController::ChooseWalkWaypoint(bool isPanic)
 
     glm::ivec3 currentLogPos = Convert::MetersToMapUnits(mCharacter->mTransform.mPosition);
     glm::ivec3 newWayPoint (0, 0, 0);
-    for (eMapDirection curr: moveDirs)
-    {
-        glm::ivec3 moveBlockPos = currentLogPos + GetVectorFromMapDirection(curr);
 
-        const MapBlockInfo* blockInfo = gGameMap.GetBlockInfo(moveBlockPos.x, moveBlockPos.z, moveBlockPos.y);
-
-        eGroundType groundType = blockInfo->mGroundType;
-        if (groundType == eGroundType_Pawement)
+    // wandering follows navigation graph, pavements are preferred over road crossings
+    if (!isPanic)
+    {
+        glm::ivec3 wanderBlock = currentLogPos;
+        int wanderDirection = currentMapDirection;
+        debug_assert(mThinkRand);
+        if (gMapNavigation.StepWander(eNavAgent_Pedestrian, wanderBlock, wanderDirection, *mThinkRand))
         {
-            newWayPoint = moveBlockPos;
-            break;
+            newWayPoint = wanderBlock;
         }
+    }
 
-        if (isPanic)
+    // panic and characters off navigation graph probe neighbour blocks
+    if (newWayPoint == glm::ivec3(0, 0, 0))
+    {
+        for (eMapDirection curr: moveDirs)
         {
-            if ((groundType == eGroundType_Field) || (groundType == eGroundType_Road))
+            glm::ivec3 moveBlockPos = currentLogPos + GetVectorFromMapDirection(curr);
+
+            eGroundType groundType = gGameMap.GetGroundType(moveBlockPos.x, moveBlockPos.z, moveBlockPos.y);
+            if (groundType == eGroundType_Pawement)
             {
                 newWayPoint = moveBlockPos;
                 break;
             }
 
-            bool canSuicide = HasAiFlags(PedestrianAiFlags_LemmingBehavior);
-            if (canSuicide && (groundType == eGroundType_Air))
+            if (isPanic)
             {
-                newWayPoint = moveBlockPos;
-                break;
+                if ((groundType == eGroundType_Field) || (groundType == eGroundType_Road))
+                {
+                    newWayPoint = moveBlockPos;
+                    break;
+                }
+
+                bool canSuicide = HasAiFlags(PedestrianAiFlags_LemmingBehavior);
+                if (canSuicide && (groundType == eGroundType_Air))
+                {
+                    newWayPoint = moveBlockPos;
+                    break;
+                }
             }
         }
     }
@@ -337,8 +393,9 @@ bool AiCharacterController::ChooseWalkWaypoint(bool isPanic)
     }
 
     // choose random point within block
-    float randomSubPosx = gCarnageGame.mGameRand.generate_float(0.1f, 0.9f);
-    float randomSubPosy = gCarnageGame.mGameRand.generate_float(0.1f, 0.9f);
+    debug_assert(mThinkRand);
+    float randomSubPosx = mThinkRand->generate_float(0.1f, 0.9f);
+    float randomSubPosy = mThinkRand->generate_float(0.1f, 0.9f);
     mDestinationPoint.x = Convert::MapUnitsToMeters(newWayPoint.x * 1.0f) + Convert::MapUnitsToMeters(randomSubPosx);
     mDestinationPoint.y = Convert::MapUnitsToMeters(newWayPoint.z * 1.0f) + Convert::MapUnitsToMeters(randomSubPosy);
     return true;
@@ -367,7 +424,7 @@ bool AiCharacterController::ContinueWalkToWaypoint(float distance)
 void AiCharacterController::StartDrivingCar()
 {
     mAiMode = ePedestrianAiMode_DrivingCar;
-    mFollowPedestrian.reset();
+    SetFollowTarget(nullptr);
 
     mCtlState.Clear();
     if (!ChooseDriveWaypoint() || !ContinueDriveToWaypoint())
@@ -381,6 +438,7 @@ void AiCharacterController::StopDriving()
     if (!mCharacter->IsCarDriver())
         return;
 
+    mDrivePath.Clear();
     mCtlState.Clear();
 
     float currentSpeed = mCharacter->mCurrentCar->GetCurrentSpeed();
@@ -390,7 +448,7 @@ void AiCharacterController::StopDriving()
     }
     else
     {
-        mCharacter->LeaveCar();
+        mLeaveCar = true;
     }
 }
 
@@ -421,30 +479,95 @@ void AiCharacterController::UpdateDrivingCar()
 
 bool AiCharacterController::ChooseDriveWaypoint()
 {
-    // todo: implement
+    // pick random region nearby and follow route to its goal, drivers heading to same region share cached route field
+    const int MaxTripDistance = 16;
+    const int MaxAttempts = 4;
+
+    glm::ivec3 currentLogPos = Convert::MetersToMapUnits(mCharacter->mCurrentCar->mTransform.mPosition);
+    if (!gMapNavigation.IsNavigable(eNavAgent_Car, currentLogPos.x, currentLogPos.z))
+        return false;
+
+    debug_assert(mThinkRand);
+    for (int iattempt = 0; iattempt < MaxAttempts; ++iattempt)
+    {
+        glm::ivec3 destinationLogPos;
+        if (!gMapNavigation.GetRegionGoal(eNavAgent_Car, 
+            currentLogPos.x + mThinkRand->generate_int(-MaxTripDistance, MaxTripDistance), 
+            currentLogPos.z + mThinkRand->generate_int(-MaxTripDistance, MaxTripDistance), destinationLogPos))
+        {
+            continue;
+        }
+
+        if (gMapNavigation.FindPath(eNavAgent_Car, currentLogPos, destinationLogPos, mDrivePath) && 
+            mDrivePath.mWaypoints.size() > 1)
+        {
+            mDrivePathIndex = 0;
+            return true;
+        }
+    }
+    mDrivePath.Clear();
     return false;
 }
 
 bool AiCharacterController::ContinueDriveToWaypoint()
 {
-    // todo: implement
-    return false;
+    const float ReachWaypointDistance = Convert::MapUnitsToMeters(0.5f);
+    const float SlowdownAngle = 45.0f;
+
+    Vehicle* currentCar = mCharacter->mCurrentCar;
+    glm::vec2 currentPos2 = currentCar->mTransform.GetPosition2();
+
+    // skip reached waypoints
+    for (; mDrivePathIndex < (int) mDrivePath.mWaypoints.size(); ++mDrivePathIndex)
+    {
+        const glm::ivec3& currWaypoint = mDrivePath.mWaypoints[mDrivePathIndex];
+        mDestinationPoint.x = Convert::MapUnitsToMeters(currWaypoint.x + 0.5f);
+        mDestinationPoint.y = Convert::MapUnitsToMeters(currWaypoint.z + 0.5f);
+        if (glm::distance2(currentPos2, mDestinationPoint) > ReachWaypointDistance * ReachWaypointDistance)
+            break;
+    }
+
+    if (mDrivePathIndex >= (int) mDrivePath.mWaypoints.size())
+    {
+        mDrivePath.Clear();
+        mCtlState.Clear();
+        return false;
+    }
+
+    // steer towards waypoint, positive steer direction turns clockwise
+    glm::vec2 toTarget = mDestinationPoint - currentPos2;
+    cxx::angle_t desiredAngle = cxx::angle_t::from_radians(::atan2f(toTarget.y, toTarget.x));
+    float angleDelta = cxx::wrap_angle_neg_180(desiredAngle.mDegrees - currentCar->mTransform.mOrientation.mDegrees);
+
+    mCtlState.mSteerDirection = glm::clamp(angleDelta / SlowdownAngle, -1.0f, 1.0f);
+    mCtlState.mAcceleration = (fabs(angleDelta) < SlowdownAngle) ? 1.0f : 0.25f;
+    return true;
 }
 
 void AiCharacterController::FollowPedestrian(Pedestrian* pedestrian)
+{
+    // called outside of think phase
+    mThinkRand = &gCarnageGame.mGameRand;
+    StartFollowPedestrian(pedestrian);
+    mThinkRand = nullptr;
+    ApplyThinkActions();
+}
+
+void AiCharacterController::StartFollowPedestrian(Pedestrian* pedestrian)
 {
     if (pedestrian == mCharacter || pedestrian == nullptr)
     {
         StartWandering();
         return;
     }
-    mFollowPedestrian = pedestrian;
+    SetFollowTarget(pedestrian);
     StartFollowTarget();
 }
 
 void AiCharacterController::StartFollowTarget()
 {
-    if (!mFollowPedestrian)
+    Pedestrian* followTarget = GetFollowTarget();
+    if (followTarget == nullptr)
     {
         debug_assert(false);
         StartWandering();
@@ -454,7 +577,7 @@ void AiCharacterController::StartFollowTarget()
     mCtlState.Clear();
     mAiMode = ePedestrianAiMode_FollowTarget;
 
-    mDestinationPoint = mFollowPedestrian->mTransform.GetPosition2();
+    mDestinationPoint = followTarget->mTransform.GetPosition2();
 }
 
 void AiCharacterController::UpdateFollowTarget()
@@ -465,7 +588,8 @@ void AiCharacterController::UpdateFollowTarget()
         return;
     }
 
-    if (!mFollowPedestrian || mFollowPedestrian->IsDead())
+    Pedestrian* followTarget = GetFollowTarget();
+    if (followTarget == nullptr || followTarget->IsDead())
     {
         StartWandering();
         return;
@@ -475,7 +599,7 @@ void AiCharacterController::UpdateFollowTarget()
         return;
 
     glm::vec2 characterPosition2 = mCharacter->mTransform.GetPosition2();
-    glm::vec2 targetPosition2 = mFollowPedestrian->mTransform.GetPosition2();
+    glm::vec2 targetPosition2 = followTarget->mTransform.GetPosition2();
 
     float distanceToTarget2 = glm::distance2(characterPosition2, targetPosition2);
     if (distanceToTarget2 < glm::pow(mFollowNearDistance, 2.0f))
@@ -484,7 +608,7 @@ void AiCharacterController::UpdateFollowTarget()
         return;
     }
 
-    mRunToTarget = mFollowPedestrian->IsRunning() || (distanceToTarget2 > glm::pow(mFollowFarDistance, 2.0f));
+    mRunToTarget = followTarget->IsRunning() || (distanceToTarget2 > glm::pow(mFollowFarDistance, 2.0f));
     mDestinationPoint = targetPosition2 + glm::normalize(targetPosition2 - characterPosition2) * mFollowNearDistance;
     ContinueWalkToWaypoint(mFollowNearDistance);
 }
@@ -523,7 +647,7 @@ bool AiCharacterController::TryFollowHumanCharacterNearby()
 
     if (bestHumanCharacter)
     {
-        FollowPedestrian(bestHumanCharacter);
+        StartFollowPedestrian(bestHumanCharacter);
         return true;
     }
     return false;
@@ -2,6 +2,7 @@
 
 #include "CharacterController.h"
 #include "Pedestrian.h"
+#include "MapNavigation.h"
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -37,12 +38,13 @@ decl_enum_as_flags(PedestrianAiFlags);
 // defines ai character controller
 class AiCharacterController final: public CharacterController
 {
+    friend class AiManager;
+
 public:
     AiCharacterController(Pedestrian* character);
 
     // process controller logic
     void DebugDraw(DebugRenderer& debugRender) override;
-    void OnCharacterUpdateFrame() override;
 
     void ChangeAiFlags(PedestrianAiFlags enableFlags, PedestrianAiFlags disableFlags);
     bool HasAiFlags(PedestrianAiFlags aiFlags) const;
@@ -51,6 +53,21 @@ public:
     void FollowPedestrian(Pedestrian* pedestrian);
 
 private:
+    // Think phase, modifies only controller own data so different controllers might think simultaneously,
+    // actions that affect other objects are deferred until apply phase
+    // @param thinkRand: Randomizer owned by calling job
+    void ThinkFrame(cxx::randomizer& thinkRand);
+
+    // Apply phase, performs deferred actions, must be called serially
+    void ApplyThinkActions();
+
+    // Deferred actions
+    void SetFollowTarget(Pedestrian* pedestrian);
+    Pedestrian* GetFollowTarget() const;
+
+    void StartFollowPedestrian(Pedestrian* pedestrian);
+
+    void UpdateActivity();
     void UpdatePanic();
     void UpdateWandering();
     void UpdateDrivingCar();
@@ -91,4 +108,19 @@ private:
     float mFollowFarDistance;
 
     bool mRunToTarget = false;
+
+    // current route while driving
+    NavPath mDrivePath;
+    int mDrivePathIndex = 0;
+
+    // think phase results
+    cxx::randomizer* mThinkRand = nullptr; // valid during think phase only
+    Pedestrian* mNextFollowTarget = nullptr;
+    bool mFollowTargetChanged = false;
+    bool mLeaveCar = false;
+
+    // level of detail, managed by AiManager
+    eAiLodTier mLodTier = eAiLodTier_Near;
+    unsigned int mLodSlot = 0; // frame offset of reduced rate updates
+    bool mLodUpdatePending = true; // due but not updated yet, new controllers start immediately
 };
\ No newline at end of file
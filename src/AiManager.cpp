@@ -2,6 +2,9 @@
 #include "AiManager.h"
 #include "AiCharacterController.h"
 #include "Pedestrian.h"
+#include "CarnageGame.h"
+#include "JobsManager.h"
+#include "FrameProfiler.h"
 
 AiManager gAiManager;
 
@@ -26,6 +29,137 @@ void AiManager::UpdateFrame()
     {
         cxx::erase_elements(mCharacterControllers, nullptr);
     }
+
+    ScheduleControllers();
+    ThinkControllers();
+}
+
+void AiManager::ScheduleControllers()
+{
+    ++mFramesCounter;
+    mAiStats = AiStats();
+
+    mViewAreas.clear();
+    for (HumanPlayer* humanPlayer: gCarnageGame.mHumanPlayers)
+    {
+        if (humanPlayer)
+        {
+            mViewAreas.push_back(humanPlayer->mViewCamera.mOnScreenMapArea);
+        }
+    }
+
+    const size_t numControllers = mCharacterControllers.size();
+    if (mBudgetCursor >= numControllers)
+    {
+        mBudgetCursor = 0;
+    }
+
+    mThinkControllers.clear();
+
+    // start from controllers that were deferred on previous frame so none of them starve
+    int budgetLeft = gGameParams.mAiMaxUpdatesPerFrame;
+    size_t nextBudgetCursor = mBudgetCursor;
+    for (size_t icurr = 0; icurr < numControllers; ++icurr)
+    {
+        size_t iController = (mBudgetCursor + icurr) % numControllers;
+
+        AiCharacterController* currController = mCharacterControllers[iController];
+        currController->mLodTier = GetControllerLodTier(currController);
+        ++mAiStats.mControllersCount[currController->mLodTier];
+
+        unsigned int updateInterval = (unsigned int) GetLodTierUpdateInterval(currController->mLodTier);
+        if ((mFramesCounter + currController->mLodSlot) % updateInterval == 0)
+        {
+            currController->mLodUpdatePending = true;
+        }
+
+        if (!currController->mLodUpdatePending)
+            continue;
+
+        if (currController->mLodTier != eAiLodTier_Near)
+        {
+            if (budgetLeft == 0)
+            {
+                if (mAiStats.mDeferredControllersCount++ == 0)
+                {
+                    nextBudgetCursor = iController;
+                }
+                continue;
+            }
+            --budgetLeft;
+        }
+
+        currController->mLodUpdatePending = false;
+        mThinkControllers.push_back(currController);
+        ++mAiStats.mUpdatedControllersCount[currController->mLodTier];
+    }
+    mBudgetCursor = nextBudgetCursor;
+
+    // keep controllers order independent of budget cursor
+    std::sort(mThinkControllers.begin(), mThinkControllers.end(), [](const AiCharacterController* lhs, const AiCharacterController* rhs)
+        {
+            return lhs->mLodSlot < rhs->mLodSlot;
+        });
+}
+
+void AiManager::ThinkControllers()
+{
+    // each job gets own randomizer derived from game randomizer, jobs always process same controllers
+    // in same order so results depend only on game seed but not on number of worker threads
+    const unsigned int frameSeed = (unsigned int) gCarnageGame.mGameRand.generate_int();
+
+    const int numControllers = (int) mThinkControllers.size();
+    const int numJobs = (numControllers + ControllersPerJob - 1) / ControllersPerJob;
+    gJobsManager.ParallelFor(numJobs, [this, numControllers, frameSeed](int jobIndex)
+        {
+            PROFILER_SCOPE("AiThink");
+
+            cxx::randomizer thinkRand (frameSeed + (unsigned int) jobIndex);
+            for (int icurr = jobIndex * ControllersPerJob, iend = std::min(icurr + ControllersPerJob, numControllers); icurr < iend; ++icurr)
+            {
+                mThinkControllers[icurr]->ThinkFrame(thinkRand);
+            }
+        });
+
+    for (AiCharacterController* currController: mThinkControllers)
+    {
+        currController->ApplyThinkActions();
+    }
+}
+
+eAiLodTier AiManager::GetControllerLodTier(AiCharacterController* controller) const
+{
+    // no views, nobody sees anything
+    if (mViewAreas.empty())
+        return eAiLodTier_Far;
+
+    glm::vec2 position2 = controller->mCharacter->mTransform.GetPosition2();
+
+    float minDistance2 = std::numeric_limits<float>::max();
+    for (const cxx::aabbox2d_t& currArea: mViewAreas)
+    {
+        glm::vec2 closestPoint = glm::clamp(position2, currArea.mMin, currArea.mMax);
+        minDistance2 = std::min(minDistance2, glm::distance2(position2, closestPoint));
+    }
+
+    if (minDistance2 <= glm::pow(gGameParams.mAiLodNearDistance, 2.0f))
+        return eAiLodTier_Near;
+
+    if (minDistance2 <= glm::pow(gGameParams.mAiLodMidDistance, 2.0f))
+        return eAiLodTier_Mid;
+
+    return eAiLodTier_Far;
+}
+
+int AiManager::GetLodTierUpdateInterval(eAiLodTier lodTier) const
+{
+    if (lodTier == eAiLodTier_Mid)
+        return std::max(gGameParams.mAiLodMidUpdateInterval, 1);
+
+    if (lodTier == eAiLodTier_Far)
+        return std::max(gGameParams.mAiLodFarUpdateInterval, 1);
+
+    return 1;
 }
 
 void AiManager::DebugDraw(DebugRenderer& debugRender)
@@ -44,6 +178,7 @@ void AiManager::ReleaseAiControllers()
     }
 
     mCharacterControllers.clear();
+    mThinkControllers.clear();
 }
 
 AiCharacterController* AiManager::CreateAiController(Pedestrian* pedestrian)
@@ -61,6 +196,7 @@ AiCharacterController* AiManager::CreateAiController(Pedestrian* pedestrian)
     }
 
     AiCharacterController* controller = new AiCharacterController(pedestrian);
+    controller->mLodSlot = mControllersCounter++;
     mCharacterControllers.push_back(controller);
     return controller;
 }
@@ -3,13 +3,28 @@
 class AiCharacterController;
 class DebugRenderer;
 
+// Ai controllers updates of last frame
+struct AiStats
+{
+public:
+    int mControllersCount[eAiLodTier_COUNT] = {};
+    int mUpdatedControllersCount[eAiLodTier_COUNT] = {};
+    int mDeferredControllersCount = 0; // due controllers skipped because of frame budget
+};
+
 // Artificial Intelligence manager class
 class AiManager final: public cxx::noncopyable
 {
+public:
+    // readonly
+    AiStats mAiStats;
+
 public:
     AiManager();
 
-    // Update all ai character controllers
+    // Update ai character controllers depending on distance to human players views,
+    // far controllers are updated at reduced rates spread across frames and limited by per frame budget;
+    // controllers think simultaneously on worker threads and then their decisions are applied serially
     void UpdateFrame();
     void DebugDraw(DebugRenderer& debugRender);
 
@@ -21,8 +36,24 @@ public:
     void ReleaseAiControllers();
     void ReleaseAiController(AiCharacterController* controller);
 
+private:
+    // controllers processed by single think job
+    static const int ControllersPerJob = 32;
+
+    void ScheduleControllers();
+    void ThinkControllers();
+
+    eAiLodTier GetControllerLodTier(AiCharacterController* controller) const;
+    int GetLodTierUpdateInterval(eAiLodTier lodTier) const;
+
 private:
     std::vector<AiCharacterController*> mCharacterControllers;
+    std::vector<AiCharacterController*> mThinkControllers; // scheduled for current frame
+    std::vector<cxx::aabbox2d_t> mViewAreas; // human players views of current frame
+
+    unsigned int mFramesCounter = 0;
+    unsigned int mControllersCounter = 0; // used to spread controllers updates across frames
+    size_t mBudgetCursor = 0; // first controller to be served when budget is exceeded
 };
 
 extern AiManager gAiManager;
\ No newline at end of file
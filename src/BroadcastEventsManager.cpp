@@ -12,6 +12,10 @@ BroadcastEventsManager::BroadcastEventsManager()
 void BroadcastEventsManager::ClearEvents()
 {
     mEventsList.clear();
+    mEventsGridDirty = true;
+
+    mEventsExaminedCount = 0;
+    mEventsExaminedCounter = 0;
 }
 
 void BroadcastEventsManager::UpdateFrame()
@@ -30,7 +34,10 @@ void BroadcastEventsManager::UpdateFrame()
         }
         // remove expired event
         curr_event_iterator = mEventsList.erase(curr_event_iterator);
+        mEventsGridDirty = true;
     }
+
+    mEventsExaminedCount = mEventsExaminedCounter.exchange(0);
 }
 
 void BroadcastEventsManager::RegisterEvent(eBroadcastEvent eventType, GameObject* subject, Pedestrian* character, float durationTime)
@@ -62,6 +69,7 @@ void BroadcastEventsManager::RegisterEvent(eBroadcastEvent eventType, GameObject
             evData.mEventTimestamp = currentGameTime;
             evData.mEventDurationTime = durationTime;
             evData.mPosition = subject->mTransform.GetPosition2();
+            mEventsGridDirty = true;
             return;
         }
     }
@@ -76,6 +84,7 @@ void BroadcastEventsManager::RegisterEvent(eBroadcastEvent eventType, GameObject
     evData.mPosition = subject->mTransform.GetPosition2();
     evData.mSubject = subject;
     evData.mCharacter = character;
+    mEventsGridDirty = true;
 
     // notify current gamestate controller
     if (gCarnageGame.mCurrentGamestate)
@@ -109,6 +118,7 @@ void BroadcastEventsManager::RegisterEvent(eBroadcastEvent eventType, const glm:
     evData.mEventTimestamp = currentGameTime;
     evData.mEventDurationTime = durationTime;
     evData.mPosition = position;
+    mEventsGridDirty = true;
 
     // notify current gamestate controller
     if (gCarnageGame.mCurrentGamestate)
@@ -135,6 +145,7 @@ bool BroadcastEventsManager::PeekClosestEvent(eBroadcastEvent eventType, const g
     float closestDistance2 = 0.0f;
     size_t counter = 0;
     size_t bestIndex = 0;
+    mEventsExaminedCounter.fetch_add((int) mEventsList.size(), std::memory_order_relaxed);
     for (size_t i = 0, Count = mEventsList.size(); i < Count; ++i)
     {
         const BroadcastEvent& currEvent = mEventsList[i];
@@ -143,9 +154,10 @@ bool BroadcastEventsManager::PeekClosestEvent(eBroadcastEvent eventType, const g
             ++counter;
 
             float currDistance2 = glm::distance2(position, currEvent.mPosition);
-            if (i == 0) // very first element if closest by default
+            if (counter == 1) // very first element if closest by default
             {
                 closestDistance2 = currDistance2;
+                bestIndex = i;
                 continue;
             }
 
@@ -164,6 +176,56 @@ bool BroadcastEventsManager::PeekClosestEvent(eBroadcastEvent eventType, const g
     return false;
 }
 
+bool BroadcastEventsManager::PeekClosestEvent(eBroadcastEvent eventType, const glm::vec2& position, float maxDistance, BroadcastEvent& outputEventData) const
+{
+    debug_assert(eventType < eBroadcastEvent_COUNT);
+
+    UpdateEventsGrid();
+
+    const std::vector<EventsGridEntry>& eventsGrid = mEventsGrid[eventType];
+    if (eventsGrid.empty())
+        return false;
+
+    const Point minCell = GetEventsGridCell(position - glm::vec2(maxDistance));
+    const Point maxCell = GetEventsGridCell(position + glm::vec2(maxDistance));
+
+    int eventsExamined = 0;
+    float closestDistance2 = maxDistance * maxDistance;
+    const BroadcastEvent* closestEvent = nullptr;
+    for (int celly = minCell.y; celly <= maxCell.y; ++celly)
+    {
+        // cells within row are contiguous
+        const int minCellIndex = celly * EventsGridDims + minCell.x;
+        const int maxCellIndex = celly * EventsGridDims + maxCell.x;
+        auto curr_entry_iterator = std::lower_bound(eventsGrid.begin(), eventsGrid.end(), minCellIndex, 
+            [](const EventsGridEntry& entry, int cellIndex)
+            {
+                return entry.mCellIndex < cellIndex;
+            });
+
+        for (; (curr_entry_iterator != eventsGrid.end()) && (curr_entry_iterator->mCellIndex <= maxCellIndex); ++curr_entry_iterator)
+        {
+            ++eventsExamined;
+
+            const BroadcastEvent& currEvent = mEventsList[curr_entry_iterator->mEventIndex];
+            float currDistance2 = glm::distance2(position, currEvent.mPosition);
+            if (currDistance2 <= closestDistance2)
+            {
+                closestDistance2 = currDistance2;
+                closestEvent = &currEvent;
+            }
+        }
+    }
+    mEventsExaminedCounter.fetch_add(eventsExamined, std::memory_order_relaxed);
+
+    if (closestEvent)
+    {
+        outputEventData = *closestEvent;
+        return true;
+    }
+    return false;
+}
+
 bool BroadcastEventsManager::GetEvent(eBroadcastEvent eventType, BroadcastEvent& outputEventData)
 {
     for (auto curr_event_iterator = mEventsList.begin(); 
@@ -176,6 +238,7 @@ bool BroadcastEventsManager::GetEvent(eBroadcastEvent eventType, BroadcastEvent&
 
             // remove element
             mEventsList.erase(curr_event_iterator);
+            mEventsGridDirty = true;
             return true;
         }
     }
@@ -195,9 +258,10 @@ bool BroadcastEventsManager::GetClosestEvent(eBroadcastEvent eventType, const gl
             ++counter;
 
             float currDistance2 = glm::distance2(position, currEvent.mPosition);
-            if (i == 0) // very first element if closest by default
+            if (counter == 1) // very first element if closest by default
             {
                 closestDistance2 = currDistance2;
+                bestIndex = i;
                 continue;
             }
 
@@ -214,7 +278,60 @@ bool BroadcastEventsManager::GetClosestEvent(eBroadcastEvent eventType, const gl
 
         // remove element
         mEventsList.erase(mEventsList.begin() + bestIndex);
+        mEventsGridDirty = true;
         return true;
     }
     return false;
+}
+
+void BroadcastEventsManager::UpdateEventsGrid() const
+{
+    if (!mEventsGridDirty.load(std::memory_order_acquire))
+        return;
+
+    // first query of the frame does rebuild, simultaneous queries wait for it
+    std::lock_guard<std::mutex> lock(mEventsGridMutex);
+    if (mEventsGridDirty.load(std::memory_order_relaxed))
+    {
+        RebuildEventsGrid();
+        mEventsGridDirty.store(false, std::memory_order_release);
+    }
+}
+
+void BroadcastEventsManager::RebuildEventsGrid() const
+{
+    for (std::vector<EventsGridEntry>& currGrid: mEventsGrid)
+    {
+        currGrid.clear();
+    }
+
+    for (int ievent = 0, Count = (int) mEventsList.size(); ievent < Count; ++ievent)
+    {
+        const BroadcastEvent& currEvent = mEventsList[ievent];
+        debug_assert(currEvent.mEventType < eBroadcastEvent_COUNT);
+
+        Point cell = GetEventsGridCell(currEvent.mPosition);
+
+        EventsGridEntry gridEntry;
+        gridEntry.mCellIndex = cell.y * EventsGridDims + cell.x;
+        gridEntry.mEventIndex = ievent;
+        mEventsGrid[currEvent.mEventType].push_back(gridEntry);
+    }
+
+    for (std::vector<EventsGridEntry>& currGrid: mEventsGrid)
+    {
+        std::stable_sort(currGrid.begin(), currGrid.end(), [](const EventsGridEntry& lhs, const EventsGridEntry& rhs)
+            {
+                return lhs.mCellIndex < rhs.mCellIndex;
+            });
+    }
+}
+
+Point BroadcastEventsManager::GetEventsGridCell(const glm::vec2& position) const
+{
+    // positions beyond map bounds are clamped to edge cells
+    Point cell;
+    cell.x = glm::clamp((int) (Convert::MetersToMapUnits(position.x) / EventsGridCellSize), 0, EventsGridDims - 1);
+    cell.y = glm::clamp((int) (Convert::MetersToMapUnits(position.y) / EventsGridCellSize), 0, EventsGridDims - 1);
+    return cell;
 }
\ No newline at end of file
@@ -18,6 +18,7 @@ enum eBroadcastEvent
 
     eBroadcastEvent_StartDriveCar,
     eBroadcastEvent_StopDriveCar,
+    eBroadcastEvent_COUNT
 };
 
 decl_enum_strings(eBroadcastEvent);
@@ -60,6 +61,10 @@ public:
 // Broadcast events manager
 class BroadcastEventsManager final: public cxx::noncopyable
 {
+public:
+    // number of events visited by closest event queries during last frame
+    int mEventsExaminedCount = 0;
+
 public:
     BroadcastEventsManager();
 
@@ -71,12 +76,36 @@ public:
     // Finds event with specific type but don't removes it from list
     bool PeekEvent(eBroadcastEvent eventType, BroadcastEvent& outputEventData) const;
     bool PeekClosestEvent(eBroadcastEvent eventType, const glm::vec2& position, BroadcastEvent& outputEventData) const;
+    // Finds closest event with specific type within radius, uses spatial index
+    // @param maxDistance: Search radius, meters
+    bool PeekClosestEvent(eBroadcastEvent eventType, const glm::vec2& position, float maxDistance, BroadcastEvent& outputEventData) const;
     // Finds event with specific type and removes it from list
     bool GetEvent(eBroadcastEvent eventType, BroadcastEvent& outputEventData);
     bool GetClosestEvent(eBroadcastEvent eventType, const glm::vec2& position, BroadcastEvent& outputEventData);
 
+private:
+    // events spatial index
+    enum
+    {
+        EventsGridCellSize = 4, // map units
+        EventsGridDims = (MAP_DIMENSIONS + EventsGridCellSize - 1) / EventsGridCellSize,
+    };
+    struct EventsGridEntry
+    {
+        int mCellIndex;
+        int mEventIndex; // index in events list
+    };
+    // rebuilds spatial index if events list was modified since last query
+    void UpdateEventsGrid() const;
+    void RebuildEventsGrid() const;
+    Point GetEventsGridCell(const glm::vec2& position) const;
+
 private:
     std::vector<BroadcastEvent> mEventsList;
+    mutable std::vector<EventsGridEntry> mEventsGrid[eBroadcastEvent_COUNT]; // sorted by cell index
+    mutable std::atomic<bool> mEventsGridDirty {false};
+    mutable std::mutex mEventsGridMutex;
+    mutable std::atomic<int> mEventsExaminedCounter {0}; // peek queries might run simultaneously
 };
 
 extern BroadcastEventsManager gBroadcastEvents;
\ No newline at end of file
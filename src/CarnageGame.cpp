@@ -10,6 +10,7 @@
 #include "TimeManager.h"
 #include "TrafficManager.h"
 #include "AiManager.h"
+#include "MapNavigation.h"
 #include "GameTextsManager.h"
 #include "BroadcastEventsManager.h"
 #include "AudioManager.h"
@@ -32,12 +33,21 @@ CvarString gCvarCurrentBaseDir("g_basedir", "", "Current gta data location", Cva
 CvarEnum<eGtaGameVersion> gCvarGameVersion("g_gamever", eGtaGameVersion_Unknown, "Current gta game version", CvarFlags_Init);
 CvarString gCvarGameLanguage("g_gamelang", "en", "Current game language", CvarFlags_Init);
 CvarInt gCvarNumPlayers("g_numplayers", 1, "Number of players in split screen mode", CvarFlags_Init);
+CvarInt gCvarRandomSeed("g_randomSeed", 0, "Game randomizer seed, 0 to use current time", CvarFlags_Init);
 
 // debug
 CvarVoid gCvarDbgDumpSpriteDeltas("dbg_dumpSpriteDeltas", "Dump sprite deltas", CvarFlags_None);
 CvarVoid gCvarDbgDumpBlockTextures("dbg_dumpBlocks", "Dump block textures", CvarFlags_None);
 CvarVoid gCvarDbgDumpSprites("dbg_dumpSprites", "Dump all sprites", CvarFlags_None);
 CvarVoid gCvarDbgDumpCarSprites("dbg_dumpCarSprites", "Dump car sprites", CvarFlags_None);
+CvarVoid gCvarDbgBenchDestroyObjects("dbg_benchDestroyObjects", "Benchmark destruction of k of n objects, args: n k", CvarFlags_None);
+CvarVoid gCvarDbgBenchSpatialQueries("dbg_benchSpatialQueries", "Benchmark game objects spatial queries, args: num objects, num queries", CvarFlags_None);
+CvarVoid gCvarDbgBenchMapQueries("dbg_benchMapQueries", "Benchmark frequent map queries, args: num queries", CvarFlags_None);
+CvarVoid gCvarDbgBenchMapMesh("dbg_benchMapMesh", "Benchmark city mesh generation for all maps, args: max threads", CvarFlags_None);
+CvarVoid gCvarDbgBenchMapCollision("dbg_benchMapCollision", "Benchmark map collision shape build and queries, args: num queries", CvarFlags_None);
+CvarVoid gCvarDbgBenchNavigation("dbg_benchNavigation", "Benchmark navigation graph path queries for all maps, args: num queries", CvarFlags_None);
+CvarVoid gCvarDbgBenchPhysicsStep("dbg_benchPhysicsStep", "Benchmark physics simulation step with 2k, 5k and 10k bodies, args: num steps, max threads", CvarFlags_None);
+CvarVoid gCvarDbgBenchSpriteSort("dbg_benchSpriteSort", "Benchmark sprites sorting and batching, args: num sprites", CvarFlags_None);
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -49,10 +59,15 @@ bool CarnageGame::Initialize()
 {
     debug_assert(mCurrentGamestate == nullptr);
 
-    // init randomizer
-    std::chrono::milliseconds ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch());
-    mGameRand.set_seed((unsigned int) ms.count());
+    // init randomizer, actual seed is kept in cvar so game session can be recorded
+    if (gCvarRandomSeed.mValue == 0)
+    {
+        std::chrono::milliseconds ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch());
+        gCvarRandomSeed.mValue = (int) ms.count();
+    }
+    gConsole.LogMessage(eLogMessage_Info, "Game randomizer seed: %d", gCvarRandomSeed.mValue);
+    mGameRand.set_seed((unsigned int) gCvarRandomSeed.mValue);
 
     gGameParams.SetToDefaults();
 
@@ -285,6 +300,11 @@ void CarnageGame::SetupScreenLayout()
     debug_assert(playersCount > 0);
 
     Point screenResolution = gGraphicsDevice.mScreenResolution;
+    if (!gGraphicsDevice.IsDeviceInited())
+    {
+        // headless mode, use configured dimensions to setup cameras
+        screenResolution = gCvarGraphicsScreenDims.mValue;
+    }
 
     int numRows = (playersCount + MaxCols - 1) / MaxCols;
     debug_assert(numRows > 0);
@@ -338,12 +358,18 @@ bool CarnageGame::StartScenario(const std::string& mapName)
         gConsole.LogMessage(eLogMessage_Warning, "Cannot load map '%s'", mapName.c_str());
         return false;
     }
+    gMapNavigation.BuildNavGraph(gGameMap);
+    gConsole.LogMessage(eLogMessage_Info, "Navigation graph built in %.1f us", gMapNavigation.mNavStats.mBuildTime);
+
     if (!gAudioManager.PreloadLevelSounds())
     {
         // ignore
     }
     gSpriteManager.Cleanup();
-    gRenderManager.mMapRenderer.BuildMapMesh();
+    if (gGraphicsDevice.IsDeviceInited())
+    {
+        gRenderManager.mMapRenderer.BuildMapMesh();
+    }
     if (!gSpriteManager.InitLevelSprites())
     {
         debug_assert(false);
@@ -424,6 +450,7 @@ void CarnageGame::ShutdownCurrentScenario()
     gGameObjectsManager.ClearWorld();
     gPhysics.ClearWorld();
     gGameMap.Cleanup();
+    gMapNavigation.Cleanup();
     gBroadcastEvents.ClearEvents();
     gAudioManager.ReleaseLevelSounds();
     gParticleManager.ClearWorld();
@@ -568,6 +595,89 @@ void CarnageGame::ProcessDebugCvars()
         gSpriteManager.DumpCarsTextures(savePath);
         gConsole.LogMessage(eLogMessage_Info, "Car sprites path is '%s'", savePath.c_str());
     }
+
+    if (gCvarDbgBenchDestroyObjects.IsModified())
+    {
+        gCvarDbgBenchDestroyObjects.ClearModified();
+        int numObjects = 0;
+        int numDestroy = 0;
+        cxx::arguments_parser argsParser(gCvarDbgBenchDestroyObjects.mCallingArgs.c_str());
+        if (argsParser.parse_next(numObjects) && argsParser.parse_next(numDestroy))
+        {
+            gGameObjectsManager.DebugBenchmarkDestroyObjects(numObjects, numDestroy);
+        }
+        else
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Usage: dbg_benchDestroyObjects <num objects> <num destroy>");
+        }
+    }
+
+    if (gCvarDbgBenchMapCollision.IsModified())
+    {
+        gCvarDbgBenchMapCollision.ClearModified();
+        int numQueries = 100000;
+        cxx::arguments_parser argsParser(gCvarDbgBenchMapCollision.mCallingArgs.c_str());
+        argsParser.parse_next(numQueries);
+        gPhysics.DebugBenchmarkMapCollision(numQueries);
+    }
+
+    if (gCvarDbgBenchNavigation.IsModified())
+    {
+        gCvarDbgBenchNavigation.ClearModified();
+        int numQueries = 1000;
+        cxx::arguments_parser argsParser(gCvarDbgBenchNavigation.mCallingArgs.c_str());
+        argsParser.parse_next(numQueries);
+        MapNavigation::DebugBenchmarkPathQueries(numQueries);
+    }
+
+    if (gCvarDbgBenchPhysicsStep.IsModified())
+    {
+        gCvarDbgBenchPhysicsStep.ClearModified();
+        int numSteps = 20;
+        int maxThreads = 0;
+        cxx::arguments_parser argsParser(gCvarDbgBenchPhysicsStep.mCallingArgs.c_str());
+        argsParser.parse_next(numSteps);
+        argsParser.parse_next(maxThreads);
+        gPhysics.DebugBenchmarkSimulationStep(numSteps, maxThreads);
+    }
+
+    if (gCvarDbgBenchMapMesh.IsModified())
+    {
+        gCvarDbgBenchMapMesh.ClearModified();
+        int maxThreads = 0;
+        cxx::arguments_parser argsParser(gCvarDbgBenchMapMesh.mCallingArgs.c_str());
+        argsParser.parse_next(maxThreads);
+        gRenderManager.mMapRenderer.DebugBenchmarkMapMesh(maxThreads);
+    }
+
+    if (gCvarDbgBenchMapQueries.IsModified())
+    {
+        gCvarDbgBenchMapQueries.ClearModified();
+        int numQueries = 0;
+        cxx::arguments_parser argsParser(gCvarDbgBenchMapQueries.mCallingArgs.c_str());
+        argsParser.parse_next(numQueries);
+        gGameMap.DebugBenchmarkQueries(numQueries);
+    }
+
+    if (gCvarDbgBenchSpatialQueries.IsModified())
+    {
+        gCvarDbgBenchSpatialQueries.ClearModified();
+        int numObjects = 0;
+        int numQueries = 0;
+        cxx::arguments_parser argsParser(gCvarDbgBenchSpatialQueries.mCallingArgs.c_str());
+        argsParser.parse_next(numObjects);
+        argsParser.parse_next(numQueries);
+        gGameObjectsManager.DebugBenchmarkSpatialQueries(numObjects, numQueries);
+    }
+
+    if (gCvarDbgBenchSpriteSort.IsModified())
+    {
+        gCvarDbgBenchSpriteSort.ClearModified();
+        int numSprites = 10000;
+        cxx::arguments_parser argsParser(gCvarDbgBenchSpriteSort.mCallingArgs.c_str());
+        argsParser.parse_next(numSprites);
+        SpriteBatch::DebugBenchmarkSort(numSprites);
+    }
 }
 
 void CarnageGame::SetCurrentGamestate(GenericGamestate* gamestate)
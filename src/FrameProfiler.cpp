@@ -0,0 +1,253 @@
+#include "stdafx.h"
+#include "FrameProfiler.h"
+#include "cvars.h"
+
+//////////////////////////////////////////////////////////////////////////
+// cvars
+//////////////////////////////////////////////////////////////////////////
+
+CvarBoolean gCvarDbgProfiler("dbg_profiler", false, "Enable frame profiler", CvarFlags_None);
+CvarVoid gCvarDbgProfilerCapture("dbg_profilerCapture", "Capture frames to chrome trace file, args: num frames, file name", CvarFlags_None);
+
+//////////////////////////////////////////////////////////////////////////
+
+const char* const FrameProfiler::DefaultTraceFileName = "profiler_trace.json";
+
+FrameProfiler gFrameProfiler;
+
+//////////////////////////////////////////////////////////////////////////
+
+FrameProfiler::FrameProfiler()
+    : mEnabled(false)
+    , mStartupTime(std::chrono::steady_clock::now())
+{
+}
+
+FrameProfiler::~FrameProfiler()
+{
+    for (ThreadEventsBuffer* currBuffer: mThreadBuffers)
+    {
+        delete currBuffer;
+    }
+    mThreadBuffers.clear();
+}
+
+void FrameProfiler::Deinit()
+{
+    if (IsTraceCaptureActive())
+    {
+        WriteTraceFile();
+    }
+
+    mEnabled = false;
+    mEnabledNextFrame = false;
+    mLastFrameEvents.clear();
+    mTraceEvents.clear();
+    mTraceFramesLeft = 0;
+}
+
+void FrameProfiler::BeginFrame()
+{
+    ProcessCvars();
+
+    ++mFrameIndex;
+    // toggle between frames only, so that all scopes of frame are either collected or skipped
+    mEnabled.store(mEnabledNextFrame, std::memory_order_relaxed);
+    mFrameStartTime = GetTimestamp();
+}
+
+void FrameProfiler::EndFrame()
+{
+    if (!IsEnabled())
+        return;
+
+    CollectFrameEvents(mFrameIndex, mLastFrameEvents);
+
+    mLastFrameStartTime = mFrameStartTime;
+    mLastFrameEndTime = GetTimestamp();
+
+    if (mTraceFramesLeft > 0)
+    {
+        mTraceEvents.insert(mTraceEvents.end(), mLastFrameEvents.begin(), mLastFrameEvents.end());
+        if (--mTraceFramesLeft == 0)
+        {
+            WriteTraceFile();
+            mTraceEvents.clear();
+            // restore previous state
+            mEnabledNextFrame = gCvarDbgProfiler.mValue;
+        }
+    }
+}
+
+void FrameProfiler::SetEnabled(bool isEnabled)
+{
+    gCvarDbgProfiler.mValue = isEnabled;
+    mEnabledNextFrame = isEnabled || IsTraceCaptureActive();
+}
+
+void FrameProfiler::StartTraceCapture(int numFrames, const std::string& fileName)
+{
+    if (numFrames < 1)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Invalid number of frames to capture");
+        return;
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Capturing %d frames to '%s'", numFrames, fileName.c_str());
+
+    mTraceFileName = fileName;
+    mTraceFramesLeft = numFrames;
+    mTraceEvents.clear();
+    mEnabledNextFrame = true;
+}
+
+bool FrameProfiler::IsTraceCaptureActive() const
+{
+    return mTraceFramesLeft > 0;
+}
+
+long long FrameProfiler::GetTimestamp() const
+{
+    std::chrono::steady_clock::time_point currentTime = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(currentTime - mStartupTime).count();
+}
+
+void FrameProfiler::EnterScope()
+{
+    ThreadEventsBuffer* eventsBuffer = GetThreadEventsBuffer();
+    ++eventsBuffer->mDepth;
+}
+
+void FrameProfiler::LeaveScope(const char* scopeName, long long startTime)
+{
+    ThreadEventsBuffer* eventsBuffer = GetThreadEventsBuffer();
+    debug_assert(eventsBuffer->mDepth > 0);
+    --eventsBuffer->mDepth;
+
+    // only owning thread writes to buffer, so relaxed load is enough here
+    unsigned int eventsCounter = eventsBuffer->mEventsCounter.load(std::memory_order_relaxed);
+
+    FrameProfilerEvent& eventData = eventsBuffer->mEvents[eventsCounter % MaxThreadEvents];
+    eventData.mName = scopeName;
+    eventData.mStartTime = startTime;
+    eventData.mEndTime = GetTimestamp();
+    eventData.mFrameIndex = mFrameIndex;
+    eventData.mThreadIndex = eventsBuffer->mThreadIndex;
+    eventData.mDepth = eventsBuffer->mDepth;
+
+    // publish event
+    eventsBuffer->mEventsCounter.store(eventsCounter + 1, std::memory_order_release);
+}
+
+FrameProfiler::ThreadEventsBuffer* FrameProfiler::GetThreadEventsBuffer()
+{
+    static thread_local ThreadEventsBuffer* threadEventsBuffer = nullptr;
+    if (threadEventsBuffer == nullptr)
+    {
+        ThreadEventsBuffer* eventsBuffer = new ThreadEventsBuffer;
+        eventsBuffer->mEventsCounter = 0;
+
+        std::lock_guard<std::mutex> lock(mThreadBuffersMutex);
+        eventsBuffer->mThreadIndex = (int) mThreadBuffers.size();
+        mThreadBuffers.push_back(eventsBuffer);
+        threadEventsBuffer = eventsBuffer;
+    }
+    return threadEventsBuffer;
+}
+
+void FrameProfiler::CollectFrameEvents(unsigned int frameIndex, std::vector<FrameProfilerEvent>& outputEvents)
+{
+    outputEvents.clear();
+
+    std::lock_guard<std::mutex> lock(mThreadBuffersMutex);
+    mThreadsCount = (int) mThreadBuffers.size();
+
+    for (ThreadEventsBuffer* currBuffer: mThreadBuffers)
+    {
+        unsigned int eventsCounter = currBuffer->mEventsCounter.load(std::memory_order_acquire);
+        unsigned int numEvents = std::min(eventsCounter, (unsigned int) MaxThreadEvents);
+
+        // events are stored in order of completion, so frame events are at the buffer tail
+        size_t firstEvent = outputEvents.size();
+        for (unsigned int ievent = 0; ievent < numEvents; ++ievent)
+        {
+            const FrameProfilerEvent& currEvent = currBuffer->mEvents[(eventsCounter - ievent - 1) % MaxThreadEvents];
+            if (currEvent.mFrameIndex != frameIndex)
+                break;
+
+            outputEvents.push_back(currEvent);
+        }
+        std::reverse(outputEvents.begin() + firstEvent, outputEvents.end());
+    }
+
+    std::stable_sort(outputEvents.begin(), outputEvents.end(), [](const FrameProfilerEvent& lhs, const FrameProfilerEvent& rhs)
+        {
+            if (lhs.mThreadIndex != rhs.mThreadIndex)
+                return lhs.mThreadIndex < rhs.mThreadIndex;
+
+            if (lhs.mStartTime != rhs.mStartTime)
+                return lhs.mStartTime < rhs.mStartTime;
+
+            return lhs.mDepth < rhs.mDepth;
+        });
+}
+
+void FrameProfiler::ProcessCvars()
+{
+    if (gCvarDbgProfiler.IsModified())
+    {
+        gCvarDbgProfiler.ClearModified();
+        SetEnabled(gCvarDbgProfiler.mValue);
+    }
+
+    if (gCvarDbgProfilerCapture.IsModified())
+    {
+        gCvarDbgProfilerCapture.ClearModified();
+
+        int numFrames = DefaultTraceFramesCount;
+        std::string fileName = DefaultTraceFileName;
+
+        cxx::arguments_parser argsParser(gCvarDbgProfilerCapture.mCallingArgs.c_str());
+        argsParser.parse_next(numFrames);
+        if (argsParser.parse_next_string())
+        {
+            fileName = argsParser.mContent;
+        }
+        StartTraceCapture(numFrames, fileName);
+    }
+}
+
+bool FrameProfiler::WriteTraceFile()
+{
+    std::ofstream outputFile;
+    if (!gFiles.CreateTextFile(mTraceFileName, outputFile))
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot write profiler trace file '%s'", mTraceFileName.c_str());
+        return false;
+    }
+
+    outputFile << "{\"traceEvents\":[\n";
+
+    // complete events, timestamps in microseconds
+    for (const FrameProfilerEvent& currEvent: mTraceEvents)
+    {
+        outputFile << cxx::va("{\"name\":\"%s\",\"cat\":\"frame %u\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f},\n",
+            currEvent.mName,
+            currEvent.mFrameIndex,
+            currEvent.mThreadIndex,
+            currEvent.mStartTime / 1000.0,
+            (currEvent.mEndTime - currEvent.mStartTime) / 1000.0);
+    }
+
+    // thread names
+    for (int ithread = 0; ithread < mThreadsCount; ++ithread)
+    {
+        outputFile << cxx::va("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Thread %d\"}}%s\n",
+            ithread, ithread, (ithread + 1 < mThreadsCount) ? "," : "");
+    }
+
+    outputFile << "]}\n";
+
+    gConsole.LogMessage(eLogMessage_Info, "Profiler trace saved to '%s' (%d events)", mTraceFileName.c_str(), (int) mTraceEvents.size());
+    return true;
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+// Profiled cpu block, timestamps are in nanoseconds since profiler startup
+struct FrameProfilerEvent
+{
+    const char* mName = nullptr; // statically allocated
+    long long mStartTime = 0;
+    long long mEndTime = 0;
+    unsigned int mFrameIndex = 0;
+    int mThreadIndex = 0;
+    int mDepth = 0; // nesting level within thread
+};
+
+// Collects timings of scoped cpu blocks of all threads into per-thread ring buffers,
+// when disabled each scope costs a single flag check
+class FrameProfiler final: public cxx::noncopyable
+{
+public:
+    // trace capture defaults
+    static const int DefaultTraceFramesCount = 120;
+    static const char* const DefaultTraceFileName;
+
+public:
+    // readonly
+    // events of last completed frame sorted by thread and start time
+    std::vector<FrameProfilerEvent> mLastFrameEvents;
+    // last completed frame bounds
+    long long mLastFrameStartTime = 0;
+    long long mLastFrameEndTime = 0;
+    int mThreadsCount = 0;
+
+public:
+    FrameProfiler();
+    ~FrameProfiler();
+
+    void Deinit();
+
+    // Frame boundaries, must be called on main thread
+    void BeginFrame();
+    void EndFrame();
+
+    // Enable or disable events collection, takes effect at next frame
+    void SetEnabled(bool isEnabled);
+
+    inline bool IsEnabled() const
+    {
+        return mEnabled.load(std::memory_order_relaxed);
+    }
+
+    // Collect events of specified number of frames and write them to file in chrome://tracing format
+    // @param numFrames: Number of frames to capture
+    // @param fileName: Output json file
+    void StartTraceCapture(int numFrames, const std::string& fileName);
+    bool IsTraceCaptureActive() const;
+
+    // Get time elapsed since profiler startup, in nanoseconds
+    long long GetTimestamp() const;
+
+    // Scopes bookkeeping, used by FrameProfilerScope
+    void EnterScope();
+    void LeaveScope(const char* scopeName, long long startTime);
+
+private:
+    static const int MaxThreadEvents = 8192;
+
+    struct ThreadEventsBuffer
+    {
+        FrameProfilerEvent mEvents[MaxThreadEvents];
+        std::atomic<unsigned int> mEventsCounter;
+        int mThreadIndex = 0;
+        int mDepth = 0;
+    };
+
+    ThreadEventsBuffer* GetThreadEventsBuffer();
+
+    void CollectFrameEvents(unsigned int frameIndex, std::vector<FrameProfilerEvent>& outputEvents);
+    void ProcessCvars();
+    bool WriteTraceFile();
+
+private:
+    std::atomic<bool> mEnabled;
+    bool mEnabledNextFrame = false;
+    unsigned int mFrameIndex = 0; // modified only by main thread between frames
+    long long mFrameStartTime = 0;
+    std::chrono::steady_clock::time_point mStartupTime;
+
+    std::mutex mThreadBuffersMutex;
+    std::vector<ThreadEventsBuffer*> mThreadBuffers;
+
+    // trace capture
+    std::vector<FrameProfilerEvent> mTraceEvents;
+    std::string mTraceFileName;
+    int mTraceFramesLeft = 0;
+};
+
+extern FrameProfiler gFrameProfiler;
+
+//////////////////////////////////////////////////////////////////////////
+
+// Measures time spent within enclosing scope
+class FrameProfilerScope final: public cxx::noncopyable
+{
+public:
+    // @param scopeName: Scope name, must be statically allocated
+    inline FrameProfilerScope(const char* scopeName)
+    {
+        if (gFrameProfiler.IsEnabled())
+        {
+            mScopeName = scopeName;
+            mStartTime = gFrameProfiler.GetTimestamp();
+            gFrameProfiler.EnterScope();
+        }
+    }
+    inline ~FrameProfilerScope()
+    {
+        if (mScopeName)
+        {
+            gFrameProfiler.LeaveScope(mScopeName, mStartTime);
+        }
+    }
+private:
+    const char* mScopeName = nullptr;
+    long long mStartTime = 0;
+};
+
+#define PROFILER_SCOPE_NAME_IMPL(line) profilerScope_##line
+#define PROFILER_SCOPE_NAME(line) PROFILER_SCOPE_NAME_IMPL(line)
+#define PROFILER_SCOPE(scopeName) FrameProfilerScope PROFILER_SCOPE_NAME(__LINE__) (scopeName)
@@ -0,0 +1,158 @@
+#include "stdafx.h"
+#include "FrameProfilerWindow.h"
+#include "imgui.h"
+#include "ImGuiHelpers.h"
+
+FrameProfilerWindow gFrameProfilerWindow;
+
+FrameProfilerWindow::FrameProfilerWindow()
+    : DebugWindow("Frame Profiler")
+{
+}
+
+void FrameProfilerWindow::DoUI(ImGuiIO& imguiContext)
+{
+    ImGuiWindowFlags wndFlags = ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav;
+
+    ImGui::SetNextWindowSize(ImVec2(760.0f, 420.0f), ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin(mWindowName, &mWindowShown, wndFlags))
+    {
+        ImGui::End();
+        return;
+    }
+
+    bool isEnabled = gFrameProfiler.IsEnabled();
+    if (ImGui::Checkbox("Enabled", &isEnabled))
+    {
+        gFrameProfiler.SetEnabled(isEnabled);
+    }
+    ImGui::SameLine();
+    ImGui::Checkbox("Pause", &mPaused);
+    ImGui::SameLine();
+    if (gFrameProfiler.IsTraceCaptureActive())
+    {
+        ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Capturing trace...");
+    }
+    else if (ImGui::Button("Capture trace"))
+    {
+        gFrameProfiler.StartTraceCapture(FrameProfiler::DefaultTraceFramesCount, FrameProfiler::DefaultTraceFileName);
+    }
+
+    if (!mPaused)
+    {
+        mFrameEvents = gFrameProfiler.mLastFrameEvents;
+        mFrameStartTime = gFrameProfiler.mLastFrameStartTime;
+        mFrameEndTime = gFrameProfiler.mLastFrameEndTime;
+        mThreadsCount = gFrameProfiler.mThreadsCount;
+    }
+
+    if (mFrameEvents.empty() || mFrameEndTime <= mFrameStartTime)
+    {
+        ImGui::Text("No data");
+        ImGui::End();
+        return;
+    }
+
+    ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Frame Time: %.3f ms, Events: %d", 
+        (mFrameEndTime - mFrameStartTime) / 1000000.0, (int) mFrameEvents.size());
+
+    ImGui::HorzSpacing();
+    DrawFrameTimeline();
+    ImGui::HorzSpacing();
+    DrawScopesHierarchy();
+
+    ImGui::End();
+}
+
+void FrameProfilerWindow::DrawFrameTimeline()
+{
+    const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+    const float threadsSpacing = 6.0f;
+
+    // compute lanes heights
+    std::vector<int> threadsMaxDepth(mThreadsCount, 0);
+    for (const FrameProfilerEvent& currEvent: mFrameEvents)
+    {
+        if (currEvent.mThreadIndex < mThreadsCount)
+        {
+            threadsMaxDepth[currEvent.mThreadIndex] = std::max(threadsMaxDepth[currEvent.mThreadIndex], currEvent.mDepth + 1);
+        }
+    }
+
+    std::vector<float> threadsOffset(mThreadsCount, 0.0f);
+    float timelineHeight = 0.0f;
+    for (int ithread = 0; ithread < mThreadsCount; ++ithread)
+    {
+        if (threadsMaxDepth[ithread] == 0)
+            continue;
+
+        threadsOffset[ithread] = timelineHeight;
+        timelineHeight += threadsMaxDepth[ithread] * rowHeight + threadsSpacing;
+    }
+
+    ImVec2 canvasPos = ImGui::GetCursorScreenPos();
+    ImVec2 canvasSize(ImGui::GetContentRegionAvail().x, timelineHeight);
+    if (canvasSize.x < 1.0f || canvasSize.y < 1.0f)
+        return;
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(canvasPos, ImVec2(canvasPos.x + canvasSize.x, canvasPos.y + canvasSize.y), 
+        ImGui::GetColorU32(ImVec4(0.1f, 0.1f, 0.1f, 0.8f)));
+
+    const double pixelsPerTime = canvasSize.x / (double) (mFrameEndTime - mFrameStartTime);
+    for (const FrameProfilerEvent& currEvent: mFrameEvents)
+    {
+        if (currEvent.mThreadIndex >= mThreadsCount)
+            continue;
+
+        ImVec2 rectMin(
+            canvasPos.x + (float) ((currEvent.mStartTime - mFrameStartTime) * pixelsPerTime),
+            canvasPos.y + threadsOffset[currEvent.mThreadIndex] + currEvent.mDepth * rowHeight);
+        ImVec2 rectMax(
+            canvasPos.x + (float) ((currEvent.mEndTime - mFrameStartTime) * pixelsPerTime),
+            rectMin.y + rowHeight - 1.0f);
+        rectMax.x = std::max(rectMax.x, rectMin.x + 1.0f);
+
+        // stable color per scope name
+        unsigned int nameHash = 2166136261U;
+        for (const char* cursor = currEvent.mName; *cursor; ++cursor)
+        {
+            nameHash = (nameHash ^ (unsigned char) *cursor) * 16777619U;
+        }
+        ImVec4 rectColor(0.0f, 0.0f, 0.0f, 1.0f);
+        ImGui::ColorConvertHSVtoRGB((nameHash % 360) / 360.0f, 0.5f, 0.7f, rectColor.x, rectColor.y, rectColor.z);
+        drawList->AddRectFilled(rectMin, rectMax, ImGui::GetColorU32(rectColor));
+
+        ImVec2 textSize = ImGui::CalcTextSize(currEvent.mName);
+        if (textSize.x + 4.0f < rectMax.x - rectMin.x)
+        {
+            drawList->AddText(ImVec2(rectMin.x + 2.0f, rectMin.y + 2.0f), ImGui::GetColorU32(ImVec4(1.0f, 1.0f, 1.0f, 1.0f)), currEvent.mName);
+        }
+
+        if (ImGui::IsMouseHoveringRect(rectMin, rectMax))
+        {
+            ImGui::SetTooltip("%s\n%.3f ms\nthread %d", currEvent.mName, 
+                (currEvent.mEndTime - currEvent.mStartTime) / 1000000.0, currEvent.mThreadIndex);
+        }
+    }
+
+    ImGui::Dummy(canvasSize);
+}
+
+void FrameProfilerWindow::DrawScopesHierarchy()
+{
+    if (!ImGui::CollapsingHeader("Scopes"))
+        return;
+
+    int currentThread = -1;
+    for (const FrameProfilerEvent& currEvent: mFrameEvents)
+    {
+        if (currEvent.mThreadIndex != currentThread)
+        {
+            currentThread = currEvent.mThreadIndex;
+            ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.0f, 1.0f), "Thread %d", currentThread);
+        }
+        ImGui::Text("%*s%s: %.3f ms", (currEvent.mDepth + 1) * 2, "", currEvent.mName, 
+            (currEvent.mEndTime - currEvent.mStartTime) / 1000000.0);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "DebugWindow.h"
+#include "FrameProfiler.h"
+
+// Displays frame profiler events of last frame as per-thread flame bars
+class FrameProfilerWindow: public DebugWindow
+{
+public:
+    FrameProfilerWindow();
+
+private:
+    // process window state
+    // @param imguiContext: Internal imgui context
+    void DoUI(ImGuiIO& imguiContext) override;
+
+    void DrawFrameTimeline();
+    void DrawScopesHierarchy();
+
+private:
+    // copy of profiler frame data, not updated while paused
+    std::vector<FrameProfilerEvent> mFrameEvents;
+    long long mFrameStartTime = 0;
+    long long mFrameEndTime = 0;
+    int mThreadsCount = 0;
+    bool mPaused = false;
+};
+
+extern FrameProfilerWindow gFrameProfilerWindow;
@@ -9,6 +9,8 @@
 #include "AiManager.h"
 #include "TrafficManager.h"
 #include "AiCharacterController.h"
+#include "MapNavigation.h"
+#include "SpriteManager.h"
 #include "cvars.h"
 #include "ImGuiHelpers.h"
 
@@ -201,14 +203,42 @@ void GameCheatsWindow::DoUI(ImGuiIO& imguiContext)
 
     if (ImGui::CollapsingHeader("Physics"))
     {
+        ImGui::Text("Bodies: %d awake, %d sleeping", gPhysics.mPhysicsStats.mAwakeBodiesCount, 
+            gPhysics.mPhysicsStats.mSleepingBodiesCount);
+        ImGui::Text("Simulation step: %.1f us", gPhysics.mPhysicsStats.mSimulationStepTime);
+        ImGui::HorzSpacing();
         //ImGui::Checkbox("Enable map collisions", &mEnableMapCollisions);
         ImGui::Checkbox("Enable gravity", &mEnableGravity);
     }
 
+    if (ImGui::CollapsingHeader("Ai"))
+    {
+        for (int ilodTier = 0; ilodTier < eAiLodTier_COUNT; ++ilodTier)
+        {
+            ImGui::Text("Controllers %s: %d, updated %d", cxx::enum_to_string((eAiLodTier) ilodTier), 
+                gAiManager.mAiStats.mControllersCount[ilodTier],
+                gAiManager.mAiStats.mUpdatedControllersCount[ilodTier]);
+        }
+        ImGui::Text("Deferred: %d", gAiManager.mAiStats.mDeferredControllersCount);
+        ImGui::Text("Path queries: %d, cache hits: %d", gMapNavigation.mQueriesCount.load(), gMapNavigation.mCacheHitsCount.load());
+        ImGui::HorzSpacing();
+        ImGui::SliderInt("Max updates per frame", &gGameParams.mAiMaxUpdatesPerFrame, 1, 256);
+        ImGui::SliderInt("Mid update interval", &gGameParams.mAiLodMidUpdateInterval, 1, 16);
+        ImGui::SliderInt("Far update interval", &gGameParams.mAiLodFarUpdateInterval, 1, 60);
+    }
+
     if (ImGui::CollapsingHeader("Draw"))
     {
         ImGui::Text("Map chunks drawn: %d", gRenderManager.mMapRenderer.mRenderStats.mBlockChunksDrawnCount);
         ImGui::Text("Sprites drawn: %d", gRenderManager.mMapRenderer.mRenderStats.mSpritesDrawnCount);
+        ImGui::Text("City mesh triangles: %d", gRenderManager.mMapRenderer.mRenderStats.mCityMeshTrianglesCount);
+        ImGui::Text("Triangles saved: %d culled, %d merged", 
+            gRenderManager.mMapRenderer.mRenderStats.mCityMeshCulledTrianglesCount,
+            gRenderManager.mMapRenderer.mRenderStats.mCityMeshMergedTrianglesCount);
+        ImGui::Text("Buffers upload: %u KB, streamed %u KB, orphans %d", 
+            gGraphicsDevice.mLastFrameStats.mUploadedBytes / 1024,
+            gGraphicsDevice.mLastFrameStats.mStreamedBytes / 1024,
+            gGraphicsDevice.mLastFrameStats.mBufferOrphansCount);
         ImGui::HorzSpacing();
         ImGui::Checkbox("Debug draw", &mEnableDebugDraw);
         ImGui::Checkbox("Decorations", &mEnableDrawDecorations);
@@ -216,14 +246,28 @@ void GameCheatsWindow::DoUI(ImGuiIO& imguiContext)
         ImGui::Checkbox("Pedestrians", &mEnableDrawPedestrians);
         ImGui::SameLine(); ImGui::Checkbox("Vehicles", &mEnableDrawVehicles);
         ImGui::Checkbox("City mesh", &mEnableDrawCityMesh);
+        ImGui::Checkbox("Sprites instancing", &gCvarGraphicsSpritesInstancing.mValue);
     }
 
     if (ImGui::CollapsingHeader("Traffic"))
     {
+        ImGui::Text("Broadcast events examined: %d", gBroadcastEvents.mEventsExaminedCount);
+        ImGui::HorzSpacing();
+        ImGui::TextColored(ImVec4(1.0f,1.0f,0.0f,1.0f), "Density");
+        ImGui::HorzSpacing();
+        ImGui::Text("Density scale: %.2f (frame time %.2f ms)", gTrafficManager.mTrafficStats.mDensityScale, 
+            gTrafficManager.mTrafficStats.mAverageFrameTime / 1000.0f);
+        ImGui::Text("Max peds: %d, max cars: %d", gTrafficManager.mTrafficStats.mMaxPedsCount, 
+            gTrafficManager.mTrafficStats.mMaxCarsCount);
+        ImGui::SliderFloat("Target frame time", &gCvarTrafficTargetFrameTime.mValue, 
+            gCvarTrafficTargetFrameTime.mMinValue, gCvarTrafficTargetFrameTime.mMaxValue, "%.1f ms");
+        ImGui::Checkbox("Adaptive density", &gCvarTrafficAdaptiveDensity.mValue);
         ImGui::HorzSpacing();
         ImGui::TextColored(ImVec4(1.0f,1.0f,0.0f,1.0f), "Pedestrians");
         ImGui::HorzSpacing();
         ImGui::Text("Current count: %d", gTrafficManager.CountTrafficPedestrians());
+        ImGui::Text("Candidates: %d (%.1f us)", gTrafficManager.mTrafficStats.mPedsCandidatesCount, 
+            gTrafficManager.mTrafficStats.mPedsCandidatesGatherTime);
         ImGui::SliderInt("Max count##ped", &gGameParams.mTrafficGenMaxPeds, 0, 100);
         ImGui::SliderInt("Generation distance max##ped", &gGameParams.mTrafficGenPedsMaxDistance, 1, 10);
         ImGui::SliderInt("Generation chance##ped", &gGameParams.mTrafficGenPedsChance, 0, 100);
@@ -233,11 +277,32 @@ void GameCheatsWindow::DoUI(ImGuiIO& imguiContext)
         ImGui::TextColored(ImVec4(1.0f,1.0f,0.0f,1.0f), "Cars");
         ImGui::HorzSpacing();
         ImGui::Text("Current count: %d", gTrafficManager.CountTrafficCars());
+        ImGui::Text("Candidates: %d (%.1f us)", gTrafficManager.mTrafficStats.mCarsCandidatesCount, 
+            gTrafficManager.mTrafficStats.mCarsCandidatesGatherTime);
         ImGui::SliderInt("Max count##car", &gGameParams.mTrafficGenMaxCars, 0, 100);
         ImGui::SliderInt("Generation distance max##car", &gGameParams.mTrafficGenCarsMaxDistance, 1, 10);
         ImGui::SliderInt("Generation chance##car", &gGameParams.mTrafficGenCarsChance, 0, 100);
         ImGui::SliderFloat("Generation cooldown##car", &gGameParams.mTrafficGenCarsCooldownTime, 0.5f, 5.0f, "%.1f");
         ImGui::Checkbox("Generation enabled##car", &mEnableTrafficCarsGeneration);
+        ImGui::HorzSpacing();
+        ImGui::TextColored(ImVec4(1.0f,1.0f,0.0f,1.0f), "Offscreen");
+        ImGui::HorzSpacing();
+        const TrafficStats& trafficStats = gTrafficManager.mTrafficStats;
+        const float currentTime = gTimeManager.mGameTime;
+        ImGui::Text("Virtual peds: %d, cars: %d (%.1f us)", trafficStats.mVirtualPedsCount, trafficStats.mVirtualCarsCount,
+            trafficStats.mVirtualUpdateTime);
+        ImGui::Text("Peds spawned/destroyed per minute: %.1f/%.1f", 
+            trafficStats.GetRatePerMinute(trafficStats.mPedsSpawnedCount, currentTime),
+            trafficStats.GetRatePerMinute(trafficStats.mPedsDestroyedCount, currentTime));
+        ImGui::Text("Cars spawned/destroyed per minute: %.1f/%.1f", 
+            trafficStats.GetRatePerMinute(trafficStats.mCarsSpawnedCount, currentTime),
+            trafficStats.GetRatePerMinute(trafficStats.mCarsDestroyedCount, currentTime));
+        ImGui::Text("Peds promoted/demoted: %d/%d", trafficStats.mPedsPromotedCount, trafficStats.mPedsDemotedCount);
+        ImGui::Text("Cars promoted/demoted: %d/%d", trafficStats.mCarsPromotedCount, trafficStats.mCarsDemotedCount);
+        ImGui::Text("Peds/cars not demoted: %d/%d", trafficStats.mPedsDemoteSkippedCount, trafficStats.mCarsDemoteSkippedCount);
+        ImGui::SliderInt("Virtual distance##ped", &gGameParams.mTrafficVirtualPedsDistance, 1, 10);
+        ImGui::SliderInt("Virtual distance##car", &gGameParams.mTrafficVirtualCarsDistance, 1, 10);
+        ImGui::Checkbox("Virtual traffic enabled", &mEnableVirtualTraffic);
     }
 
     if (ImGui::CollapsingHeader("Graphics"))
@@ -246,6 +311,10 @@ void GameCheatsWindow::DoUI(ImGuiIO& imguiContext)
         {
             gCvarGraphicsVSync.SetModified();
         }
+        if (ImGui::Checkbox("Merge city mesh lids", &gCvarGraphicsMergeCityMeshFaces.mValue))
+        {
+            gCvarGraphicsMergeCityMeshFaces.SetModified();
+        }
         if (ImGui::Checkbox("Fullscreen", &gCvarGraphicsFullscreen.mValue))
         {
             gCvarGraphicsFullscreen.SetModified();
@@ -275,6 +344,17 @@ void GameCheatsWindow::DoUI(ImGuiIO& imguiContext)
                 ImGui::EndCombo();
             }
         }
+
+        ImGui::HorzSpacing();
+
+        const SpriteCacheStats& spriteCacheStats = gSpriteManager.mSpriteCacheStats;
+        ImGui::Text("Sprites cache: %d entries, %d atlas pages", spriteCacheStats.mEntriesCount, spriteCacheStats.mAtlasPagesCount);
+        ImGui::Text("Hits: %d, misses: %d, evictions: %d, failures: %d", spriteCacheStats.mHitsCount, 
+            spriteCacheStats.mMissesCount, spriteCacheStats.mEvictionsCount, spriteCacheStats.mFailuresCount);
+
+        const SpriteDeltasCacheStats& deltasCacheStats = gGameMap.mStyleData.mSpriteDeltasCacheStats;
+        ImGui::Text("Composited deltas: %d KB, hits: %d, misses: %d, flushes: %d", deltasCacheStats.mCachedBytes / 1024, 
+            deltasCacheStats.mHitsCount, deltasCacheStats.mMissesCount, deltasCacheStats.mFlushesCount);
     }
 
     ImGui::End();
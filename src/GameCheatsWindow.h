@@ -16,6 +16,7 @@ public:
     bool mEnableDrawCityMesh = true;
     bool mEnableTrafficPedsGeneration = true;
     bool mEnableTrafficCarsGeneration = false;
+    bool mEnableVirtualTraffic = true;
 
 public:
     GameCheatsWindow();
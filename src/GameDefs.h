@@ -201,6 +201,22 @@ enum eGameObjectClass
 
 decl_enum_strings(eGameObjectClass);
 
+// game object classes filter for spatial queries
+enum GameObjectClassMask: unsigned int
+{
+    GameObjectClassMask_None = 0,
+    GameObjectClassMask_Car = BIT(eGameObjectClass_Car),
+    GameObjectClassMask_Pedestrian = BIT(eGameObjectClass_Pedestrian),
+    GameObjectClassMask_Projectile = BIT(eGameObjectClass_Projectile),
+    GameObjectClassMask_Powerup = BIT(eGameObjectClass_Powerup),
+    GameObjectClassMask_Decoration = BIT(eGameObjectClass_Decoration),
+    GameObjectClassMask_Obstacle = BIT(eGameObjectClass_Obstacle),
+    GameObjectClassMask_Explosion = BIT(eGameObjectClass_Explosion),
+    GameObjectClassMask_All = BIT(eGameObjectClass_COUNT) - 1,
+};
+
+decl_enum_as_flags(GameObjectClassMask);
+
 enum GameObjectFlags: unsigned int
 {
     GameObjectFlags_None = 0,
@@ -860,6 +876,34 @@ enum eGameMusicMode
 
 decl_enum_strings(eGameMusicMode);
 
+// Game systems updated during gameplay frame
+enum eGameplaySubsystem
+{
+    eGameplaySubsystem_BlocksAnimations,
+    eGameplaySubsystem_Physics,
+    eGameplaySubsystem_GameObjects,
+    eGameplaySubsystem_Weather,
+    eGameplaySubsystem_Particles,
+    eGameplaySubsystem_Navigation,
+    eGameplaySubsystem_Traffic,
+    eGameplaySubsystem_Ai,
+    eGameplaySubsystem_BroadcastEvents,
+    eGameplaySubsystem_COUNT
+};
+
+decl_enum_strings(eGameplaySubsystem);
+
+// Ai controllers update rate depending on distance to human players views
+enum eAiLodTier
+{
+    eAiLodTier_Near, // updated every frame
+    eAiLodTier_Mid,
+    eAiLodTier_Far,
+    eAiLodTier_COUNT
+};
+
+decl_enum_strings(eAiLodTier);
+
 // Game map navigation data sector
 struct DistrictInfo
 {
@@ -2,14 +2,19 @@
 #include "GameMapHelpers.h"
 #include "SpriteManager.h"
 #include "GameMapManager.h"
+#include "cvars.h"
 
 bool GameMapHelpers::BuildMapMesh(GameMapManager& cityScape, const Rect& area, int layerIndex, CityMeshData& meshData)
 {
     debug_assert(layerIndex > -1 && layerIndex < MAP_LAYERS_COUNT);
 
-    // preallocate
-    meshData.mBlocksIndices.reserve(1 * 1024 * 1024);
-    meshData.mBlocksVertices.reserve(1 * 1024 * 1024);
+    // lids that can be merged are collected first and processed after all other faces
+    const bool mergeLidFaces = gCvarGraphicsMergeCityMeshFaces.mValue;
+    std::vector<const MapBlockInfo*> lidFaces;
+    if (mergeLidFaces)
+    {
+        lidFaces.resize(area.w * area.h, nullptr);
+    }
 
     // prepare
     for (int tiley = 0; tiley < area.h; ++tiley)
@@ -25,42 +30,149 @@ bool GameMapHelpers::BuildMapMesh(GameMapManager& cityScape, const Rect& area, i
                 continue;
 
             eBlockFace faceid = (eBlockFace) iface;
+            if (IsBlockFaceHidden(cityScape, tilex + area.x, tiley + area.y, layerIndex, faceid, mapBlock))
+            {
+                ++meshData.mCulledFacesCount;
+                continue;
+            }
+
+            if (mergeLidFaces && (faceid == eBlockFace_Lid) && (mapBlock->mSlopeType == 0))
+            {
+                lidFaces[tiley * area.w + tilex] = mapBlock;
+                continue;
+            }
+
             PutBlockFace(cityScape, meshData, tilex + area.x, tiley + area.y, layerIndex, faceid, mapBlock);
         }
     }
+
+    if (mergeLidFaces)
+    {
+        PutMergedLidFaces(cityScape, meshData, area, layerIndex, lidFaces);
+    }
     return true;
 }
 
 bool GameMapHelpers::BuildMapMesh(GameMapManager& cityScape, const Rect& area, CityMeshData& meshData)
 {
-    // preallocate
-    meshData.mBlocksIndices.reserve(4 * 1024 * 1024);
-    meshData.mBlocksVertices.reserve(4 * 1024 * 1024);
+    // preallocate, assume about two faces per block column
+    const int estimatedFacesCount = area.w * area.h * 2;
+    meshData.mBlocksIndices.reserve(meshData.mBlocksIndices.size() + estimatedFacesCount * 6);
+    meshData.mBlocksVertices.reserve(meshData.mBlocksVertices.size() + estimatedFacesCount * 4);
 
-    // prepare
     for (int tilez = 0; tilez < MAP_LAYERS_COUNT; ++tilez)
+    {
+        BuildMapMesh(cityScape, area, tilez, meshData);
+    }
+    return true;
+}
+
+void GameMapHelpers::PutMergedLidFaces(GameMapManager& cityScape, CityMeshData& meshData, const Rect& area, int layerIndex, 
+    std::vector<const MapBlockInfo*>& lidFaces)
+{
+    debug_assert((int) lidFaces.size() == (area.w * area.h));
+
+    // greedy merge, grow rectangle along x first and then along y
     for (int tiley = 0; tiley < area.h; ++tiley)
     for (int tilex = 0; tilex < area.w; ++tilex)
     {
-        const MapBlockInfo* mapBlock = cityScape.GetBlockInfo(tilex + area.x, tiley + area.y, tilez);
+        const MapBlockInfo* mapBlock = lidFaces[tiley * area.w + tilex];
         if (mapBlock == nullptr)
             continue;
 
-        for (int iface = 0; iface < eBlockFace_COUNT; ++iface)
+        int sizex = 1;
+        while ((tilex + sizex < area.w) && CanMergeLidFaces(mapBlock, lidFaces[tiley * area.w + tilex + sizex]))
         {
-            if (mapBlock->mFaces[iface] == 0)
-                continue;
+            ++sizex;
+        }
 
-            eBlockFace faceid = (eBlockFace) iface;
-            PutBlockFace(cityScape, meshData, tilex + area.x, tiley + area.y, tilez, faceid, mapBlock);
+        int sizey = 1;
+        for (; tiley + sizey < area.h; ++sizey)
+        {
+            bool canMergeRow = true;
+            for (int ix = 0; (ix < sizex) && canMergeRow; ++ix)
+            {
+                canMergeRow = CanMergeLidFaces(mapBlock, lidFaces[(tiley + sizey) * area.w + tilex + ix]);
+            }
+            if (!canMergeRow)
+                break;
         }
+
+        // mark as processed
+        for (int iy = 0; iy < sizey; ++iy)
+        for (int ix = 0; ix < sizex; ++ix)
+        {
+            lidFaces[(tiley + iy) * area.w + tilex + ix] = nullptr;
+        }
+
+        PutBlockFace(cityScape, meshData, tilex + area.x, tiley + area.y, layerIndex, eBlockFace_Lid, mapBlock, sizex, sizey);
+        meshData.mMergedFacesCount += (sizex * sizey) - 1;
     }
-    return true;
 }
 
-void GameMapHelpers::PutBlockFace(GameMapManager& cityScape, CityMeshData& meshData, int x, int y, int z, eBlockFace face, const MapBlockInfo* blockInfo)
+bool GameMapHelpers::IsBlockFaceHidden(GameMapManager& cityScape, int x, int y, int z, eBlockFace face, const MapBlockInfo* blockInfo)
+{
+    if (face == eBlockFace_Lid)
+    {
+        if (z + 1 >= MAP_LAYERS_COUNT)
+            return false;
+
+        // covered by block above, lid is visible through any open side of it
+        const MapBlockInfo* aboveBlockInfo = cityScape.GetBlockInfo(x, y, z + 1);
+        return IsSolidBlock(aboveBlockInfo) && 
+            (aboveBlockInfo->mFaces[eBlockFace_W] > 0) && (aboveBlockInfo->mFaces[eBlockFace_E] > 0) &&
+            (aboveBlockInfo->mFaces[eBlockFace_N] > 0) && (aboveBlockInfo->mFaces[eBlockFace_S] > 0);
+    }
+
+    // flat faces are drawn on opposite side of block and might be transparent
+    if (blockInfo->mIsFlat)
+        return false;
+
+    eBlockFace oppositeFace = eBlockFace_COUNT;
+    switch (face)
+    {
+        case eBlockFace_W: --x; oppositeFace = eBlockFace_E; break;
+        case eBlockFace_E: ++x; oppositeFace = eBlockFace_W; break;
+        case eBlockFace_N: --y; oppositeFace = eBlockFace_S; break;
+        case eBlockFace_S: ++y; oppositeFace = eBlockFace_N; break;
+        default:
+            debug_assert(false);
+        return false;
+    }
+
+    // blocks beyond map bounds are clamped copies, keep faces on map edges
+    if (x < 0 || x >= MAP_DIMENSIONS || y < 0 || y >= MAP_DIMENSIONS)
+        return false;
+
+    // neighbour must have wall facing back, otherwise face is visible through its open side
+    const MapBlockInfo* neighbourBlockInfo = cityScape.GetBlockInfo(x, y, z);
+    return IsSolidBlock(neighbourBlockInfo) && (neighbourBlockInfo->mFaces[oppositeFace] > 0);
+}
+
+bool GameMapHelpers::IsSolidBlock(const MapBlockInfo* blockInfo)
+{
+    // opaque cube that is closed from above
+    return blockInfo && (blockInfo->mGroundType == eGroundType_Building) && (blockInfo->mSlopeType == 0) && 
+        !blockInfo->mIsFlat && (blockInfo->mFaces[eBlockFace_Lid] > 0);
+}
+
+bool GameMapHelpers::CanMergeLidFaces(const MapBlockInfo* blockInfo, const MapBlockInfo* otherBlockInfo)
+{
+    if (otherBlockInfo == nullptr)
+        return false;
+
+    return (blockInfo->mFaces[eBlockFace_Lid] == otherBlockInfo->mFaces[eBlockFace_Lid]) &&
+        (blockInfo->mRemap == otherBlockInfo->mRemap) &&
+        (blockInfo->mLidRotation == otherBlockInfo->mLidRotation) &&
+        (blockInfo->mIsFlat == otherBlockInfo->mIsFlat);
+}
+
+void GameMapHelpers::PutBlockFace(GameMapManager& cityScape, CityMeshData& meshData, int x, int y, int z, eBlockFace face, const MapBlockInfo* blockInfo, 
+    int sizex, int sizey)
 {
     assert(blockInfo && blockInfo->mFaces[face]);
+    // only flat lids can span multiple blocks
+    debug_assert((sizex == 1 && sizey == 1) || (face == eBlockFace_Lid && blockInfo->mSlopeType == 0));
     eBlockType blockType = (face == eBlockFace_Lid) ? eBlockType_Lid : eBlockType_Side;
 
     const int blockTexIndex = cityScape.mStyleData.GetBlockTextureLinearIndex(blockType, blockInfo->mFaces[face]);
@@ -83,15 +195,23 @@ void GameMapHelpers::PutBlockFace(GameMapManager& cityScape, CityMeshData& meshD
     // scale to meters
     for (glm::vec3& currPoint: cubePoints)
     {
+        currPoint.x *= sizex;
+        currPoint.z *= sizey;
         currPoint *= METERS_PER_MAP_UNIT;
     }
 
+    const int rotateLid = (face == eBlockFace_Lid) ? blockInfo->mLidRotation : 0;
+
+    // texture repeats once per block, rotated lid swaps texture axes
+    const float texScaleU = (rotateLid % 2) ? sizey * 1.0f : sizex * 1.0f;
+    const float texScaleV = (rotateLid % 2) ? sizex * 1.0f : sizey * 1.0f;
+
     glm::vec3 texCoords[4] =
     {
         {0.0f, 0.0f, blockTexIndex * 1.0f},
-        {1.0f, 0.0f, blockTexIndex * 1.0f},
-        {1.0f, 1.0f, blockTexIndex * 1.0f},
-        {0.0f, 1.0f, blockTexIndex * 1.0f}
+        {texScaleU, 0.0f, blockTexIndex * 1.0f},
+        {texScaleU, texScaleV, blockTexIndex * 1.0f},
+        {0.0f, texScaleV, blockTexIndex * 1.0f}
     };
 
     // process slope
@@ -149,7 +269,6 @@ void GameMapHelpers::PutBlockFace(GameMapManager& cityScape, CityMeshData& meshD
         case 44: cubePoints[0].y = cubePoints[4].y = 0.0f; break;
     }
 
-    const int rotateLid = (face == eBlockFace_Lid) ? blockInfo->mLidRotation : 0;
     const int baseVertexIndex = meshData.mBlocksVertices.size();
     meshData.mBlocksVertices.resize(baseVertexIndex + 4);
     meshData.mBlocksVertices[baseVertexIndex + ((rotateLid + 0) % 4)].mTexcoord = texCoords[0];
@@ -13,10 +13,16 @@ public:
     {
         mBlocksVertices.clear();
         mBlocksIndices.clear();
+        mCulledFacesCount = 0;
+        mMergedFacesCount = 0;
     }
 public:
     std::vector<TVertexType> mBlocksVertices;
     std::vector<DrawIndex> mBlocksIndices;
+
+    // build statistics
+    int mCulledFacesCount = 0; // faces skipped because they are hidden by solid neighbours
+    int mMergedFacesCount = 0; // faces saved by merging adjacent lids
 };
 
 using CityMeshData = MeshData<CityVertex3D>;
@@ -41,5 +47,11 @@ public:
 
 private:
     // internals
-    static void PutBlockFace(GameMapManager& city, CityMeshData& meshData, int x, int y, int z, eBlockFace face, const MapBlockInfo* blockInfo);
+    static void PutBlockFace(GameMapManager& city, CityMeshData& meshData, int x, int y, int z, eBlockFace face, const MapBlockInfo* blockInfo, 
+        int sizex = 1, int sizey = 1);
+    static void PutMergedLidFaces(GameMapManager& city, CityMeshData& meshData, const Rect& area, int layerIndex, 
+        std::vector<const MapBlockInfo*>& lidFaces);
+    static bool IsBlockFaceHidden(GameMapManager& city, int x, int y, int z, eBlockFace face, const MapBlockInfo* blockInfo);
+    static bool IsSolidBlock(const MapBlockInfo* blockInfo);
+    static bool CanMergeLidFaces(const MapBlockInfo* blockInfo, const MapBlockInfo* otherBlockInfo);
 };
\ No newline at end of file
@@ -103,8 +103,12 @@ void GameMapManager::Cleanup()
         {
             memset(&mMapTiles[tilez][tiley][tilex], 0, Sizeof_BlockInfo);
         }
+        UpdateMapColumn(tilex, tiley);
     }
     mStartupObjects.clear();
+    mChangedColumns.clear();
+    mCollectedChangedColumns.clear();
+    memset(mCollectedColumnsFlags, 0, sizeof(mCollectedColumnsFlags));
     for (int ibase = 0; ibase < eAccidentServise_COUNT; ++ibase)
     {
         mAccidentServicesBases[ibase].clear();
@@ -201,6 +205,7 @@ bool GameMapManager::ReadCompressedMapData(std::istream& file, int columnLength,
             int srcBlock = columnData[columnElement + columnHeight - tilez];
             mMapTiles[tilez][tiley][tilex] = blocksData[srcBlock];
         }
+        UpdateMapColumn(tilex, tiley);
     }
     //FixShiftedBits();
     return true;
@@ -215,6 +220,74 @@ const MapBlockInfo* GameMapManager::GetBlockInfo(int coordx, int coordz, int lay
     return &mMapTiles[layer][coordz][coordx];
 }
 
+void GameMapManager::SetBlockInfo(int coordx, int coordz, int layer, const MapBlockInfo& blockInfo)
+{
+    bool isValidLocation = (layer > -1 && layer < MAP_LAYERS_COUNT) && 
+        (coordx > -1 && coordx < MAP_DIMENSIONS) && 
+        (coordz > -1 && coordz < MAP_DIMENSIONS);
+
+    debug_assert(isValidLocation);
+    if (!isValidLocation)
+        return;
+
+    mMapTiles[layer][coordz][coordx] = blockInfo;
+    UpdateMapColumn(coordx, coordz);
+
+    if (!mCollectedColumnsFlags[coordz][coordx])
+    {
+        mCollectedColumnsFlags[coordz][coordx] = true;
+        mCollectedChangedColumns.emplace_back(coordx, coordz);
+    }
+}
+
+eGroundType GameMapManager::GetGroundType(int coordx, int coordz, int layer) const
+{
+    layer = glm::clamp(layer, 0, MAP_LAYERS_COUNT - 1);
+    coordx = glm::clamp(coordx, 0, MAP_DIMENSIONS - 1);
+    coordz = glm::clamp(coordz, 0, MAP_DIMENSIONS - 1);
+
+    return mMapColumns[coordz][coordx].mGroundTypes[layer];
+}
+
+int GameMapManager::GetTopmostLayer(int coordx, int coordz) const
+{
+    coordx = glm::clamp(coordx, 0, MAP_DIMENSIONS - 1);
+    coordz = glm::clamp(coordz, 0, MAP_DIMENSIONS - 1);
+
+    return mMapColumns[coordz][coordx].mTopmostLayer;
+}
+
+void GameMapManager::UpdateMapColumn(int coordx, int coordz)
+{
+    MapColumnInfo& columnInfo = mMapColumns[coordz][coordx];
+    columnInfo.mTopmostLayer = -1;
+    for (int tilez = 0; tilez < MAP_LAYERS_COUNT; ++tilez)
+    {
+        const MapBlockInfo& blockInfo = mMapTiles[tilez][coordz][coordx];
+        columnInfo.mGroundTypes[tilez] = blockInfo.mGroundType;
+        columnInfo.mSlopeTypes[tilez] = blockInfo.mSlopeType;
+        if (blockInfo.mGroundType != eGroundType_Air)
+        {
+            columnInfo.mTopmostLayer = tilez;
+        }
+    }
+}
+
+const std::vector<Point>& GameMapManager::GetChangedColumns() const
+{
+    return mChangedColumns;
+}
+
+void GameMapManager::FlushChangedColumns()
+{
+    for (const Point& currColumn: mCollectedChangedColumns)
+    {
+        mCollectedColumnsFlags[currColumn.y][currColumn.x] = false;
+    }
+    mChangedColumns.swap(mCollectedChangedColumns);
+    mCollectedChangedColumns.clear();
+}
+
 void GameMapManager::FixShiftedBits()
 {
     // as CityScape Data Structure document says:
@@ -258,11 +331,13 @@ void GameMapManager::FixShiftedBits()
 float GameMapManager::GetWaterLevelAtPosition2(const glm::vec2& position) const
 {
     glm::ivec2 blockPosition = Convert::MetersToMapUnits(position);
+    blockPosition.x = glm::clamp(blockPosition.x, 0, MAP_DIMENSIONS - 1);
+    blockPosition.y = glm::clamp(blockPosition.y, 0, MAP_DIMENSIONS - 1);
 
-    for (int i = MAP_LAYERS_COUNT; i > 0; --i)
+    const MapColumnInfo& columnInfo = mMapColumns[blockPosition.y][blockPosition.x];
+    for (int i = columnInfo.mTopmostLayer + 1; i > 0; --i)
     {
-        const MapBlockInfo* blockData = GetBlockInfo(blockPosition.x, blockPosition.y, i - 1);
-        if (blockData->mGroundType == eGroundType_Water)
+        if (columnInfo.mGroundTypes[i - 1] == eGroundType_Water)
         {
             float waterHeight = Convert::MapUnitsToMeters(i - 1.0f);
             return waterHeight;
@@ -306,24 +381,27 @@ float GameMapManager::GetHeightAtPosition(const glm::vec3& position, bool exclud
     // get map block position in which we are located
     glm::ivec3 mapBlock = Convert::MetersToMapUnits(position);
 
+    const MapColumnInfo& columnInfo = mMapColumns[glm::clamp(mapBlock.z, 0, MAP_DIMENSIONS - 1)][glm::clamp(mapBlock.x, 0, MAP_DIMENSIONS - 1)];
+
     float currentHeight = (float) mapBlock.y; // set current height to ground, map units
     for (; currentHeight > 0.0f;)
     {
-        const MapBlockInfo* blockData = GetBlockInfo(mapBlock.x, mapBlock.z, mapBlock.y); // y is map layer
+        const int layer = glm::clamp(mapBlock.y, 0, MAP_LAYERS_COUNT - 1); // y is map layer
 
         // compute slope height
-        if (blockData->mSlopeType) 
+        if (columnInfo.mSlopeTypes[layer]) 
         {
             // subposition within block
             float cx = Convert::MetersToMapUnits(position.x) - mapBlock.x;
             float cy = Convert::MetersToMapUnits(position.z) - mapBlock.z;
 
-            currentHeight += GameMapHelpers::GetSlopeHeight(blockData->mSlopeType, cx, cy);
+            currentHeight += GameMapHelpers::GetSlopeHeight(columnInfo.mSlopeTypes[layer], cx, cy);
 
             break;
         }
 
-        if (blockData->mGroundType == eGroundType_Air || (blockData->mGroundType == eGroundType_Water && excludeWater)) // fall through non solid block
+        const eGroundType groundType = columnInfo.mGroundTypes[layer];
+        if (groundType == eGroundType_Air || (groundType == eGroundType_Water && excludeWater)) // fall through non solid block
         {
             currentHeight -= 1.0f;
             mapBlock.y -= 1;
@@ -409,8 +487,7 @@ bool GameMapManager::TraceSegment2D(const glm::vec2& origin, const glm::vec2& de
         }
 
         // detect hit
-        const MapBlockInfo* blockData = GetBlockInfo(mapcoord_curr.x, mapcoord_curr.y, mapcoord_z);
-        if (blockData->mGroundType == eGroundType_Building)
+        if (GetGroundType(mapcoord_curr.x, mapcoord_curr.y, mapcoord_z) == eGroundType_Building)
         {
             float perpWallDist;
             if (side == 0) perpWallDist = (mapcoord_curr.x - posX + (1 - stepX) / 2) / direction.x;
@@ -427,6 +504,76 @@ bool GameMapManager::TraceSegment2D(const glm::vec2& origin, const glm::vec2& de
     return false;
 }
 
+void GameMapManager::DebugBenchmarkQueries(int numQueries)
+{
+    if (numQueries < 1)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Invalid benchmark arguments, expected number of queries");
+        return;
+    }
+
+    // generate query positions upfront, all tests are using same set
+    cxx::randomizer queriesRand;
+    std::vector<glm::vec3> queryPositions (numQueries);
+    for (glm::vec3& currPosition: queryPositions)
+    {
+        currPosition.x = Convert::MapUnitsToMeters(queriesRand.generate_float() * MAP_DIMENSIONS);
+        currPosition.y = Convert::MapUnitsToMeters(queriesRand.generate_float() * MAP_LAYERS_COUNT);
+        currPosition.z = Convert::MapUnitsToMeters(queriesRand.generate_float() * MAP_DIMENSIONS);
+    }
+
+    auto RunQueries = [&queryPositions](const char* testName, const std::function<float(const glm::vec3&)>& queryProc)
+    {
+        float checksum = 0.0f; // prevent queries from being optimized out
+        std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+        for (const glm::vec3& currPosition: queryPositions)
+        {
+            checksum += queryProc(currPosition);
+        }
+        std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
+        long long elapsedNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(timeEnd - timeStart).count();
+        gConsole.LogMessage(eLogMessage_Info, "%s: %.2f ns per query (checksum %.2f)", testName, 
+            (double) elapsedNanoseconds / queryPositions.size(), checksum);
+    };
+
+    RunQueries("Height at position", [this](const glm::vec3& position)
+        {
+            return GetHeightAtPosition(position);
+        });
+    RunQueries("Water level at position", [this](const glm::vec3& position)
+        {
+            return GetWaterLevelAtPosition2(glm::vec2(position.x, position.z));
+        });
+
+    // compact data against full blocks data
+    RunQueries("Ground type (blocks)", [this](const glm::vec3& position)
+        {
+            glm::ivec3 mapBlock = Convert::MetersToMapUnits(position);
+            return (float) GetBlockInfo(mapBlock.x, mapBlock.z, mapBlock.y)->mGroundType;
+        });
+    RunQueries("Ground type (compact)", [this](const glm::vec3& position)
+        {
+            glm::ivec3 mapBlock = Convert::MetersToMapUnits(position);
+            return (float) GetGroundType(mapBlock.x, mapBlock.z, mapBlock.y);
+        });
+    RunQueries("Topmost layer (blocks)", [this](const glm::vec3& position)
+        {
+            glm::ivec3 mapBlock = Convert::MetersToMapUnits(position);
+            int topmostLayer = MAP_LAYERS_COUNT - 1;
+            for (; topmostLayer > -1; --topmostLayer)
+            {
+                if (GetBlockInfo(mapBlock.x, mapBlock.z, topmostLayer)->mGroundType != eGroundType_Air)
+                    break;
+            }
+            return (float) topmostLayer;
+        });
+    RunQueries("Topmost layer (compact)", [this](const glm::vec3& position)
+        {
+            glm::ivec3 mapBlock = Convert::MetersToMapUnits(position);
+            return (float) GetTopmostLayer(mapBlock.x, mapBlock.z);
+        });
+}
+
 bool GameMapManager::ReadStartupObjects(std::istream& file, int dataSize)
 {
     const unsigned int RecordSize = 14;
@@ -32,6 +32,29 @@ public:
     // @param coordx, coordy, layer: Block location
     const MapBlockInfo* GetBlockInfo(int coordx, int coordy, int layer) const;
 
+    // overwrite map block at specific location, modified block columns are reported after next FlushChangedColumns
+    // note that location coords should never exceed MAP_DIMENSIONS for x,y and MAP_LAYERS_COUNT for layer
+    // @param coordx, coordy, layer: Block location
+    // @param blockInfo: New block data
+    void SetBlockInfo(int coordx, int coordy, int layer, const MapBlockInfo& blockInfo);
+
+    // get ground type of map block at specific location, uses compact map data
+    // note that location coords should never exceed MAP_DIMENSIONS for x,y and MAP_LAYERS_COUNT for layer
+    // @param coordx, coordy, layer: Block location
+    eGroundType GetGroundType(int coordx, int coordy, int layer) const;
+
+    // get topmost non-air layer of map column, uses compact map data
+    // @param coordx, coordy: Column location
+    // @returns -1 if column is empty
+    int GetTopmostLayer(int coordx, int coordy) const;
+
+    // get map block columns modified before last flush, list stays same during whole frame
+    const std::vector<Point>& GetChangedColumns() const;
+
+    // publish columns modified since previous flush and start collecting new ones,
+    // must be called once at start of simulation frame so all consumers see each change exactly once
+    void FlushChangedColumns();
+
     // Get navigation data sector at specific map point
     // @param position: Current position on map, meters
     // @returns null on error
@@ -55,6 +78,10 @@ public:
     // @returns true if intersection detected or false otherwise
     bool TraceSegment2D(const glm::vec2& origin, const glm::vec2& destination, float height, glm::vec2& outPoint);
 
+    // Debug: measure latency of frequent map queries and print results to console
+    // @param numQueries: Number of random queries per test
+    void DebugBenchmarkQueries(int numQueries);
+
 private:
     // Reading map data internals
     // @param file: Source stream
@@ -65,12 +92,29 @@ private:
     bool ReadNavData(std::ifstream& file, int dataSize);
     void FixShiftedBits();
 
+    // refresh compact data of map column from full blocks data
+    void UpdateMapColumn(int coordx, int coordy);
+
     std::string GetStyleFileName(int styleNumber) const;
 
+private:
+    // compact map column data required by frequent queries, layers are stored contiguously
+    struct MapColumnInfo
+    {
+        eGroundType mGroundTypes[MAP_LAYERS_COUNT];
+        unsigned char mSlopeTypes[MAP_LAYERS_COUNT];
+        signed char mTopmostLayer; // topmost non-air layer or -1
+    };
+
 private:
     MapBlockInfo mMapTiles[MAP_LAYERS_COUNT][MAP_DIMENSIONS][MAP_DIMENSIONS]; // z, y, x
+    MapColumnInfo mMapColumns[MAP_DIMENSIONS][MAP_DIMENSIONS]; // y, x
     int mBaseTilesData[MAP_DIMENSIONS][MAP_DIMENSIONS]; // y x
 
+    std::vector<Point> mChangedColumns; // x y, published on flush
+    std::vector<Point> mCollectedChangedColumns; // x y, modified since last flush
+    bool mCollectedColumnsFlags[MAP_DIMENSIONS][MAP_DIMENSIONS]; // y, x
+
     // accident service base locations
     std::vector<glm::ivec3> mAccidentServicesBases[eAccidentServise_COUNT];
 
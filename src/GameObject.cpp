@@ -232,6 +232,7 @@ void GameObject::OnTransformChanged()
         mPhysicsBody->SetTransform(mTransform.mPosition, mTransform.mOrientation);
     }
 
+    gGameObjectsManager.RefreshObjectGridCell(this);
     RefreshDrawSprite();
 
     // update attached objects
@@ -245,24 +246,10 @@ void GameObject::SyncPhysicsTransform()
 {
     if (mParentObject == nullptr) // hierarchy root
     {
-        if ((mPhysicsBody == nullptr) || (mPhysicsBody->IsAwake() == false) ||
-            (mPhysicsBody->CheckFlags(PhysicsBodyFlags_Static)))
+        if (FetchPhysicsTransform())
         {
-            // no need to synchronize
-            return;
+            CommitPhysicsTransform();
         }
-
-        if (mPreviousTransform != mTransform)
-        {
-            mPreviousTransform = mTransform;
-            mTransformSmooth = mTransform;
-        }
-
-        Transform newTransform( mPhysicsBody->GetPosition(), mPhysicsBody->GetOrientation() );
-        if (newTransform == mTransform)
-            return; // transform not changed
-
-        mTransform = newTransform;
     }
     else // child
     {
@@ -285,9 +272,41 @@ void GameObject::SyncPhysicsTransform()
         {
             mPhysicsBody->SetTransform(mTransform.mPosition, mTransform.mOrientation);
         }
+
+        RefreshDrawSprite();
+        CommitPhysicsTransform();
+    }
+}
+
+bool GameObject::FetchPhysicsTransform()
+{
+    debug_assert(mParentObject == nullptr);
+
+    if ((mPhysicsBody == nullptr) || (mPhysicsBody->IsAwake() == false) ||
+        (mPhysicsBody->CheckFlags(PhysicsBodyFlags_Static)))
+    {
+        // no need to synchronize
+        return false;
+    }
+
+    if (mPreviousTransform != mTransform)
+    {
+        mPreviousTransform = mTransform;
+        mTransformSmooth = mTransform;
     }
 
+    Transform newTransform( mPhysicsBody->GetPosition(), mPhysicsBody->GetOrientation() );
+    if (newTransform == mTransform)
+        return false; // transform not changed
+
+    mTransform = newTransform;
     RefreshDrawSprite();
+    return true;
+}
+
+void GameObject::CommitPhysicsTransform()
+{
+    gGameObjectsManager.RefreshObjectGridCell(this);
 
     // propagate sync to attached objects
     for (GameObject* currObject: mAttachedObjects)
@@ -309,6 +328,14 @@ void GameObject::RegisterContact(const Contact& contactInfo)
     mObjectsContacts.push_back(contactInfo);
 }
 
+void GameObject::UnregisterContact(Collider* thisCollider, Collider* thatCollider)
+{
+    cxx::erase_elements_if(mObjectsContacts, [thisCollider, thatCollider](const Contact& currContact)
+    {
+        return (currContact.mThisCollider == thisCollider) && (currContact.mThatCollider == thatCollider);
+    });
+}
+
 void GameObject::UnregisterContactsWithObject(GameObject* otherObject)
 {
     debug_assert(otherObject);
@@ -131,8 +131,17 @@ protected:
     void OnTransformChanged();
 
     void SyncPhysicsTransform();
+
+    // Two-phase transform sync for hierarchy roots:
+    // fetch reads physics body and touches only object own data, so different objects might be fetched simultaneously,
+    // commit updates spatial index and attached objects and must be called serially
+    // @returns true if transform was changed and must be committed
+    bool FetchPhysicsTransform();
+    void CommitPhysicsTransform();
+
     void ClearContacts();
     void RegisterContact(const Contact& contactInfo);
+    void UnregisterContact(Collider* thisCollider, Collider* thatCollider);
     void UnregisterContactsWithObject(GameObject* otherObject);
 
     void InterpolateTransform(float factor);
@@ -142,7 +151,7 @@ protected:
     GameObject* mParentObject = nullptr;
 
     std::vector<GameObject*> mAttachedObjects;
-    std::vector<Contact> mObjectsContacts; // lsit of contacting colliders (non triggers) on last simulation frame
+    std::vector<Contact> mObjectsContacts; // lsit of contacting colliders (non triggers), sleeping bodies keep contacts of their last awake frame
 
     // drawing spricific data
     Sprite2D mDrawSprite;
@@ -151,6 +160,11 @@ protected:
     cxx::aabbox2d_t mDrawBounds; // sprite bounds cache
 
 private:
+    // spatial grid cell linkage, managed by objects manager
+    int mGridCellIndex = -1;
+    GameObject* mGridCellPrev = nullptr;
+    GameObject* mGridCellNext = nullptr;
+
     // marked object will be destroyed next game frame
     bool mMarkedForDeletion = false;
     unsigned int mLastRenderFrame = 0; // render frames counter
@@ -6,6 +6,7 @@
 #include "GameMapManager.h"
 #include "Projectile.h"
 #include "RenderingManager.h"
+#include "PhysicsManager.h"
 
 GameObjectsManager gGameObjectsManager;
 
@@ -25,7 +26,7 @@ GameObjectsManager::~GameObjectsManager()
 
 void GameObjectsManager::EnterWorld()
 {
-    mIDsCounter = 0;
+    ClearObjectSlots();
 
     if (!CreateStartupObjects())
     {
@@ -36,6 +37,8 @@ void GameObjectsManager::EnterWorld()
 void GameObjectsManager::ClearWorld()
 {
     DestroyAllObjects();
+    ClearObjectSlots();
+    mObjectsGridCells.clear();
 }
 
 void GameObjectsManager::UpdateFrame()
@@ -75,6 +78,7 @@ Pedestrian* GameObjectsManager::CreatePedestrian(const glm::vec3& position, cxx:
     {
         instance->mRemapIndex = remap;
     }
+    RegisterObjectSlot(instance);
     mAllObjects.push_back(instance);
     mPedestriansList.push_back(instance);
 
@@ -93,6 +97,7 @@ Vehicle* GameObjectsManager::CreateVehicle(const glm::vec3& position, cxx::angle
     Vehicle* instance = mCarsPool.create(carID);
     debug_assert(instance);
 
+    RegisterObjectSlot(instance);
     mAllObjects.push_back(instance);
     mVehiclesList.push_back(instance);
 
@@ -147,6 +152,7 @@ Obstacle* GameObjectsManager::CreateObstacle(const glm::vec3& position, cxx::ang
 
         instance = mObstaclesPool.create(objectID, desc);
         debug_assert(instance);
+        RegisterObjectSlot(instance);
         mAllObjects.push_back(instance);
         // init
         instance->SetTransform(position, heading);
@@ -178,6 +184,7 @@ Decoration* GameObjectsManager::CreateDecoration(const glm::vec3& position, cxx:
 
     instance = mDecorationsPool.create(objectID, desc);
     debug_assert(instance);
+    RegisterObjectSlot(instance);
     mAllObjects.push_back(instance);
     // init
     instance->SetTransform(position, heading);
@@ -224,77 +231,223 @@ Decoration* GameObjectsManager::CreateBigSmoke(const glm::vec3& position)
 
 Obstacle* GameObjectsManager::GetObstacleByID(GameObjectID objectID) const
 {
-    for (GameObject* currentObject: mAllObjects)
-    {
-        if (currentObject->mObjectID != objectID)
-            continue;
+    GameObject* gameObject = GetObjectFromSlot(objectID);
+    if (gameObject && gameObject->IsObstacleClass())
+        return static_cast<Obstacle*>(gameObject);
 
-        if (currentObject->IsMarkedForDeletion() || !currentObject->IsObstacleClass())
-            return nullptr;
-
-        return static_cast<Obstacle*>(currentObject);
-    }
     return nullptr;
 }
 
 Vehicle* GameObjectsManager::GetVehicleByID(GameObjectID objectID) const
 {
-    for (GameObject* currentObject: mAllObjects)
-    {
-        if (currentObject->mObjectID != objectID)
-            continue;
-
-        if (currentObject->IsMarkedForDeletion() || !currentObject->IsVehicleClass())
-            return nullptr;
+    GameObject* gameObject = GetObjectFromSlot(objectID);
+    if (gameObject && gameObject->IsVehicleClass())
+        return static_cast<Vehicle*>(gameObject);
 
-        return static_cast<Vehicle*>(currentObject);
-    }
     return nullptr;
 }
 
 Decoration* GameObjectsManager::GetDecorationByID(GameObjectID objectID) const
 {
-    for (GameObject* currentObject: mAllObjects)
+    GameObject* gameObject = GetObjectFromSlot(objectID);
+    if (gameObject && gameObject->IsDecorationClass())
+        return static_cast<Decoration*>(gameObject);
+
+    return nullptr;
+}
+
+Pedestrian* GameObjectsManager::GetPedestrianByID(GameObjectID objectID) const
+{
+    GameObject* gameObject = GetObjectFromSlot(objectID);
+    if (gameObject && gameObject->IsPedestrianClass())
+        return static_cast<Pedestrian*>(gameObject);
+
+    return nullptr;
+}
+
+GameObject* GameObjectsManager::GetGameObjectByID(GameObjectID objectID) const
+{
+    return GetObjectFromSlot(objectID);
+}
+
+void GameObjectsManager::QueryObjectsWithinBox(const glm::vec2& center, const glm::vec2& extents, GameObjectClassMask classMask, 
+    std::vector<GameObject*>& outputObjects) const
+{
+    if (mObjectsGridCells.empty() || classMask == GameObjectClassMask_None)
+        return;
+
+    const glm::vec2 minPosition = center - extents;
+    const glm::vec2 maxPosition = center + extents;
+    const Point minCell = GetObjectsGridCell(minPosition);
+    const Point maxCell = GetObjectsGridCell(maxPosition);
+
+    for (int celly = minCell.y; celly <= maxCell.y; ++celly)
+    for (int cellx = minCell.x; cellx <= maxCell.x; ++cellx)
     {
-        if (currentObject->mObjectID != objectID)
-            continue;
+        for (GameObject* currObject = mObjectsGridCells[celly * MAP_DIMENSIONS + cellx]; currObject; 
+            currObject = currObject->mGridCellNext)
+        {
+            if (!IsObjectMatchesQuery(currObject, classMask))
+                continue;
+
+            glm::vec2 position = currObject->mTransform.GetPosition2();
+            if (position.x < minPosition.x || position.x > maxPosition.x ||
+                position.y < minPosition.y || position.y > maxPosition.y)
+            {
+                continue;
+            }
+            outputObjects.push_back(currObject);
+        }
+    }
+}
+
+void GameObjectsManager::QueryObjectsWithinRadius(const glm::vec2& center, float radius, GameObjectClassMask classMask, 
+    std::vector<GameObject*>& outputObjects) const
+{
+    if (mObjectsGridCells.empty() || classMask == GameObjectClassMask_None)
+        return;
+
+    const float radius2 = radius * radius;
+    const Point minCell = GetObjectsGridCell(center - glm::vec2(radius));
+    const Point maxCell = GetObjectsGridCell(center + glm::vec2(radius));
 
-        if (currentObject->IsMarkedForDeletion() || !currentObject->IsDecorationClass())
-            return nullptr;
+    for (int celly = minCell.y; celly <= maxCell.y; ++celly)
+    for (int cellx = minCell.x; cellx <= maxCell.x; ++cellx)
+    {
+        for (GameObject* currObject = mObjectsGridCells[celly * MAP_DIMENSIONS + cellx]; currObject; 
+            currObject = currObject->mGridCellNext)
+        {
+            if (!IsObjectMatchesQuery(currObject, classMask))
+                continue;
 
-        return static_cast<Decoration*>(currentObject);
+            if (glm::distance2(center, currObject->mTransform.GetPosition2()) > radius2)
+                continue;
+
+            outputObjects.push_back(currObject);
+        }
     }
-    return nullptr;
 }
 
-Pedestrian* GameObjectsManager::GetPedestrianByID(GameObjectID objectID) const
+GameObject* GameObjectsManager::QueryClosestObject(const glm::vec2& center, float maxDistance, GameObjectClassMask classMask, 
+    const GameObject* ignoreObject) const
 {
-    for (GameObject* currentObject: mAllObjects)
+    if (mObjectsGridCells.empty() || classMask == GameObjectClassMask_None)
+        return nullptr;
+
+    const Point centerCell = GetObjectsGridCell(center);
+    const int maxRing = (int) std::ceil(Convert::MetersToMapUnits(maxDistance));
+
+    float closestDistance2 = maxDistance * maxDistance;
+    GameObject* closestObject = nullptr;
+
+    // visit cells ring by ring starting from center
+    for (int iring = 0; iring <= maxRing; ++iring)
     {
-        if (currentObject->mObjectID != objectID)
-            continue;
+        const int minx = centerCell.x - iring;
+        const int maxx = centerCell.x + iring;
+        const int miny = centerCell.y - iring;
+        const int maxy = centerCell.y + iring;
+        for (int celly = std::max(miny, 0); celly <= std::min(maxy, MAP_DIMENSIONS - 1); ++celly)
+        {
+            // inner rows are processing only two edge cells
+            const int stepx = (celly == miny || celly == maxy) ? 1 : (maxx - minx);
+            for (int cellx = minx; cellx <= maxx; cellx += std::max(stepx, 1))
+            {
+                if (cellx < 0 || cellx >= MAP_DIMENSIONS)
+                    continue;
 
-        if (currentObject->IsMarkedForDeletion() || !currentObject->IsPedestrianClass())
-            return nullptr;
+                for (GameObject* currObject = mObjectsGridCells[celly * MAP_DIMENSIONS + cellx]; currObject; 
+                    currObject = currObject->mGridCellNext)
+                {
+                    if ((currObject == ignoreObject) || !IsObjectMatchesQuery(currObject, classMask))
+                        continue;
+
+                    float currDistance2 = glm::distance2(center, currObject->mTransform.GetPosition2());
+                    if (currDistance2 <= closestDistance2)
+                    {
+                        closestDistance2 = currDistance2;
+                        closestObject = currObject;
+                    }
+                }
+            }
+        }
 
-        return static_cast<Pedestrian*>(currentObject);
+        // objects within next rings are farther away than found one
+        if (closestObject)
+        {
+            const float ringDistance = Convert::MapUnitsToMeters(iring * 1.0f);
+            if (closestDistance2 <= ringDistance * ringDistance)
+                break;
+        }
     }
-    return nullptr;
+    return closestObject;
 }
 
-GameObject* GameObjectsManager::GetGameObjectByID(GameObjectID objectID) const
+void GameObjectsManager::RefreshObjectGridCell(GameObject* object)
 {
-    for (GameObject* currentObject: mAllObjects)
+    debug_assert(object);
+
+    if (mObjectsGridCells.empty())
     {
-        if (currentObject->mObjectID != objectID)
-            continue;
+        mObjectsGridCells.resize(MAP_DIMENSIONS * MAP_DIMENSIONS, nullptr);
+    }
 
-        if (currentObject->IsMarkedForDeletion())
-            return nullptr;
+    const Point cell = GetObjectsGridCell(object->mTransform.GetPosition2());
+    const int cellIndex = cell.y * MAP_DIMENSIONS + cell.x;
+    if (object->mGridCellIndex == cellIndex)
+        return;
+
+    RemoveObjectFromGrid(object);
 
-        return currentObject;
+    // link to head of cell list
+    GameObject*& cellHead = mObjectsGridCells[cellIndex];
+    object->mGridCellIndex = cellIndex;
+    object->mGridCellPrev = nullptr;
+    object->mGridCellNext = cellHead;
+    if (cellHead)
+    {
+        cellHead->mGridCellPrev = object;
     }
-    return nullptr;
+    cellHead = object;
+}
+
+void GameObjectsManager::RemoveObjectFromGrid(GameObject* object)
+{
+    if (object->mGridCellIndex == -1)
+        return;
+
+    if (object->mGridCellPrev)
+    {
+        object->mGridCellPrev->mGridCellNext = object->mGridCellNext;
+    }
+    else
+    {
+        debug_assert(mObjectsGridCells[object->mGridCellIndex] == object);
+        mObjectsGridCells[object->mGridCellIndex] = object->mGridCellNext;
+    }
+
+    if (object->mGridCellNext)
+    {
+        object->mGridCellNext->mGridCellPrev = object->mGridCellPrev;
+    }
+
+    object->mGridCellIndex = -1;
+    object->mGridCellPrev = nullptr;
+    object->mGridCellNext = nullptr;
+}
+
+Point GameObjectsManager::GetObjectsGridCell(const glm::vec2& position) const
+{
+    // positions beyond map bounds are clamped to edge cells
+    Point cell;
+    cell.x = glm::clamp((int) std::floor(Convert::MetersToMapUnits(position.x)), 0, MAP_DIMENSIONS - 1);
+    cell.y = glm::clamp((int) std::floor(Convert::MetersToMapUnits(position.y)), 0, MAP_DIMENSIONS - 1);
+    return cell;
+}
+
+bool GameObjectsManager::IsObjectMatchesQuery(const GameObject* object, GameObjectClassMask classMask) const
+{
+    return ((BIT(object->mClassID) & classMask) > 0) && !object->IsMarkedForDeletion();
 }
 
 void GameObjectsManager::DestroyGameObject(GameObject* object)
@@ -309,14 +462,29 @@ void GameObjectsManager::DestroyGameObject(GameObject* object)
 
     cxx::erase_elements(mAllObjects, object);
 
+    if (object->IsPedestrianClass())
+    {
+        cxx::erase_elements(mPedestriansList, object);
+    }
+    else if (object->IsVehicleClass())
+    {
+        cxx::erase_elements(mVehiclesList, object);
+    }
+
+    DeleteGameObjectInstance(object);
+}
+
+void GameObjectsManager::DeleteGameObjectInstance(GameObject* object)
+{
+    RemoveObjectFromGrid(object);
+    FreeObjectSlot(object);
+
     switch (object->mClassID)
     {
         case eGameObjectClass_Pedestrian:
         {
             Pedestrian* pedestrian = static_cast<Pedestrian*>(object);
             mPedestriansPool.destroy(pedestrian);
-
-            cxx::erase_elements(mPedestriansList, object);
         }
         break;
 
@@ -324,8 +492,6 @@ void GameObjectsManager::DestroyGameObject(GameObject* object)
         {
             Vehicle* vehicle = static_cast<Vehicle*>(object);
             mCarsPool.destroy(vehicle);
-
-            cxx::erase_elements(mVehiclesList, object);
         }
         break;
 
@@ -392,31 +558,287 @@ void GameObjectsManager::DestroyAllObjects()
 
 void GameObjectsManager::DestroyMarkedForDeletionObjects()
 {
-    std::vector<GameObject*> toDeleteObjectsList;
-    for (GameObject* currGameObject: mAllObjects)
+    debug_assert(mDestroyObjectsList.empty());
+
+    // compact objects list in single pass, dead objects are moved to scratch buffer
+    size_t numAliveObjects = 0;
+    for (size_t i = 0, NumElements = mAllObjects.size(); i < NumElements; ++i)
     {
+        GameObject* currGameObject = mAllObjects[i];
         if (currGameObject->IsMarkedForDeletion())
         {
-            toDeleteObjectsList.push_back(currGameObject);
+            mDestroyObjectsList.push_back(currGameObject);
+            continue;
         }
+        mAllObjects[numAliveObjects++] = currGameObject;
     }
 
-    for (GameObject* currGameObject: toDeleteObjectsList)
+    if (mDestroyObjectsList.empty())
+        return;
+
+    mAllObjects.resize(numAliveObjects);
+
+    cxx::erase_elements_if(mPedestriansList, [](const Pedestrian* currPedestrian)
+        {
+            return currPedestrian->IsMarkedForDeletion();
+        });
+
+    cxx::erase_elements_if(mVehiclesList, [](const Vehicle* currVehicle)
+        {
+            return currVehicle->IsMarkedForDeletion();
+        });
+
+    // despawn all dead objects before freeing any memory, they still may refer each other
+    for (GameObject* currGameObject: mDestroyObjectsList)
+    {
+        currGameObject->HandleDespawn();
+    }
+
+    for (GameObject* currGameObject: mDestroyObjectsList)
+    {
+        DeleteGameObjectInstance(currGameObject);
+    }
+
+    mDestroyObjectsList.clear();
+}
+
+void GameObjectsManager::DebugBenchmarkDestroyObjects(int numObjects, int numDestroy)
+{
+    if (numObjects < 1 || numDestroy < 0 || numDestroy > numObjects)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Invalid benchmark arguments, expected number of objects and number to destroy");
+        return;
+    }
+
+    // flush pending objects first so they don't affect measurements
+    DestroyMarkedForDeletionObjects();
+
+    glm::vec3 spawnPosition;
+    if (!mPedestriansList.empty())
+    {
+        spawnPosition = mPedestriansList[0]->mTransform.mPosition;
+    }
+
+    std::vector<Pedestrian*> benchObjects;
+    benchObjects.reserve(numObjects);
+    for (int icurr = 0; icurr < numObjects; ++icurr)
+    {
+        cxx::angle_t heading;
+        Pedestrian* pedestrian = CreatePedestrian(spawnPosition, heading, ePedestrianType_Civilian);
+        debug_assert(pedestrian);
+        benchObjects.push_back(pedestrian);
+    }
+
+    // choose random victims, game randomizer is not touched to keep session deterministic
+    cxx::randomizer benchRand;
+    benchRand.shuffle(benchObjects);
+    for (int icurr = 0; icurr < numDestroy; ++icurr)
+    {
+        benchObjects[icurr]->MarkForDeletion();
+    }
+
+    std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+    DestroyMarkedForDeletionObjects();
+    std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
+
+    long long elapsedMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(timeEnd - timeStart).count();
+    gConsole.LogMessage(eLogMessage_Info, "Destroy %d of %d objects (total %d alive before): %lld us", 
+        numDestroy, numObjects, (int) (mAllObjects.size() + numDestroy), elapsedMicroseconds);
+
+    // cleanup rest of bench objects
+    for (int icurr = numDestroy; icurr < numObjects; ++icurr)
+    {
+        benchObjects[icurr]->MarkForDeletion();
+    }
+    DestroyMarkedForDeletionObjects();
+}
+
+void GameObjectsManager::DebugBenchmarkSpatialQueries(int numObjects, int numQueries)
+{
+    if (numObjects < 1 || numQueries < 1)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Invalid benchmark arguments, expected number of objects and number of queries");
+        return;
+    }
+
+    // flush pending objects first so they don't affect measurements
+    DestroyMarkedForDeletionObjects();
+
+    cxx::randomizer benchRand;
+    auto GetRandomMapPosition = [&benchRand]()
+    {
+        return Convert::MapUnitsToMeters(glm::vec2(
+            benchRand.generate_float() * MAP_DIMENSIONS, 
+            benchRand.generate_float() * MAP_DIMENSIONS));
+    };
+
+    std::vector<Pedestrian*> benchObjects;
+    benchObjects.reserve(numObjects);
+    for (int icurr = 0; icurr < numObjects; ++icurr)
+    {
+        glm::vec2 position2 = GetRandomMapPosition();
+        glm::vec3 spawnPosition (position2.x, Convert::MapUnitsToMeters(MAP_LAYERS_COUNT * 1.0f), position2.y);
+        spawnPosition.y = gGameMap.GetHeightAtPosition(spawnPosition);
+
+        cxx::angle_t heading;
+        Pedestrian* pedestrian = CreatePedestrian(spawnPosition, heading, ePedestrianType_Civilian);
+        debug_assert(pedestrian);
+        benchObjects.push_back(pedestrian);
+    }
+
+    std::vector<glm::vec2> queryPositions (numQueries);
+    for (glm::vec2& currPosition: queryPositions)
+    {
+        currPosition = GetRandomMapPosition();
+    }
+
+    const float queryRadius = Convert::MapUnitsToMeters(4.0f);
+
+    auto RunQueries = [&queryPositions](const char* testName, const std::function<int(const glm::vec2&)>& queryProc)
+    {
+        long long objectsFound = 0;
+        std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+        for (const glm::vec2& currPosition: queryPositions)
+        {
+            objectsFound += queryProc(currPosition);
+        }
+        std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
+        long long elapsedMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(timeEnd - timeStart).count();
+        gConsole.LogMessage(eLogMessage_Info, "%s: %d queries %lld us, objects found %lld", testName, 
+            (int) queryPositions.size(), elapsedMicroseconds, objectsFound);
+    };
+
+    std::vector<GameObject*> queryObjects;
+    RunQueries("Grid radius query", [this, queryRadius, &queryObjects](const glm::vec2& position)
+        {
+            queryObjects.clear();
+            QueryObjectsWithinRadius(position, queryRadius, GameObjectClassMask_Pedestrian, queryObjects);
+            return (int) queryObjects.size();
+        });
+
+    RunQueries("Pedestrians list scan", [this, queryRadius](const glm::vec2& position)
+        {
+            int objectsFound = 0;
+            for (Pedestrian* currPedestrian: mPedestriansList)
+            {
+                if (glm::distance2(position, currPedestrian->mTransform.GetPosition2()) <= queryRadius * queryRadius)
+                {
+                    ++objectsFound;
+                }
+            }
+            return objectsFound;
+        });
+
+    RunQueries("Physics box query", [queryRadius](const glm::vec2& position)
+        {
+            PhysicsQueryResult queryResult;
+            gPhysics.QueryObjectsWithinBox(position, glm::vec2(queryRadius), queryResult, CollisionGroup_Pedestrian);
+            return queryResult.mElementsCount;
+        });
+
+    RunQueries("Grid closest query", [this, queryRadius](const glm::vec2& position)
+        {
+            return QueryClosestObject(position, queryRadius, GameObjectClassMask_Pedestrian) ? 1 : 0;
+        });
+
+    // cleanup bench objects
+    for (Pedestrian* currPedestrian: benchObjects)
     {
-        DestroyGameObject(currGameObject);
+        currPedestrian->MarkForDeletion();
     }
+    DestroyMarkedForDeletionObjects();
 }
 
 GameObjectID GameObjectsManager::GenerateUniqueID()
 {
-    GameObjectID newID = ++mIDsCounter;
-    if (newID == GAMEOBJECT_ID_NULL) // overflow
+    unsigned int slotIndex = 0;
+    if (mFreeObjectSlots.empty())
     {
-        debug_assert(false);
+        slotIndex = mObjectSlots.size();
+        if (slotIndex > ObjectSlotIndexMask) // overflow
+        {
+            debug_assert(false);
+            return GAMEOBJECT_ID_NULL;
+        }
+        mObjectSlots.emplace_back();
+    }
+    else
+    {
+        slotIndex = mFreeObjectSlots.back();
+        mFreeObjectSlots.pop_back();
     }
+
+    const ObjectSlot& objectSlot = mObjectSlots[slotIndex];
+    debug_assert(objectSlot.mObject == nullptr);
+
+    GameObjectID newID = (objectSlot.mGeneration << ObjectSlotIndexBits) | slotIndex;
+    debug_assert(newID != GAMEOBJECT_ID_NULL);
     return newID;
 }
 
+void GameObjectsManager::RegisterObjectSlot(GameObject* object)
+{
+    debug_assert(object);
+    if (object->mObjectID == GAMEOBJECT_ID_NULL)
+        return;
+
+    unsigned int slotIndex = (object->mObjectID & ObjectSlotIndexMask);
+    debug_assert(slotIndex < mObjectSlots.size());
+
+    ObjectSlot& objectSlot = mObjectSlots[slotIndex];
+    debug_assert(objectSlot.mObject == nullptr);
+    objectSlot.mObject = object;
+}
+
+void GameObjectsManager::FreeObjectSlot(GameObject* object)
+{
+    debug_assert(object);
+    if (object->mObjectID == GAMEOBJECT_ID_NULL)
+        return;
+
+    unsigned int slotIndex = (object->mObjectID & ObjectSlotIndexMask);
+    debug_assert(slotIndex < mObjectSlots.size());
+
+    ObjectSlot& objectSlot = mObjectSlots[slotIndex];
+    debug_assert(objectSlot.mObject == object);
+    objectSlot.mObject = nullptr;
+
+    // invalidate all outstanding identifiers that refer this slot
+    objectSlot.mGeneration = (objectSlot.mGeneration + 1) & ObjectSlotGenerationMask;
+    if (objectSlot.mGeneration == 0)
+    {
+        objectSlot.mGeneration = 1;
+    }
+    mFreeObjectSlots.push_back(slotIndex);
+}
+
+void GameObjectsManager::ClearObjectSlots()
+{
+    debug_assert(mAllObjects.empty());
+
+    mObjectSlots.clear();
+    mFreeObjectSlots.clear();
+}
+
+GameObject* GameObjectsManager::GetObjectFromSlot(GameObjectID objectID) const
+{
+    if (objectID == GAMEOBJECT_ID_NULL)
+        return nullptr;
+
+    unsigned int slotIndex = (objectID & ObjectSlotIndexMask);
+    if (slotIndex >= mObjectSlots.size())
+        return nullptr;
+
+    const ObjectSlot& objectSlot = mObjectSlots[slotIndex];
+    if (objectSlot.mObject == nullptr || objectSlot.mObject->mObjectID != objectID)
+        return nullptr;
+
+    if (objectSlot.mObject->IsMarkedForDeletion())
+        return nullptr;
+
+    return objectSlot.mObject;
+}
+
 bool GameObjectsManager::CreateStartupObjects()
 {
     debug_assert(gGameMap.IsLoaded());
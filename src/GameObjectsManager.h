@@ -63,18 +63,78 @@ public:
     Pedestrian* GetPedestrianByID(GameObjectID objectID) const;
     GameObject* GetGameObjectByID(GameObjectID objectID) const;
 
+    // Find game objects within map area using spatial grid, only object positions are tested
+    // Objects marked for deletion are ignored
+    // @param center, extents, radius: Search area, meters
+    // @param classMask: Game object classes to search
+    // @param outputObjects: Found objects, list is not cleared
+    void QueryObjectsWithinBox(const glm::vec2& center, const glm::vec2& extents, GameObjectClassMask classMask, std::vector<GameObject*>& outputObjects) const;
+    void QueryObjectsWithinRadius(const glm::vec2& center, float radius, GameObjectClassMask classMask, std::vector<GameObject*>& outputObjects) const;
+
+    // Find closest game object using spatial grid
+    // @param center, maxDistance: Search area, meters
+    // @param classMask: Game object classes to search
+    // @param ignoreObject: Optional object to exclude from search
+    GameObject* QueryClosestObject(const glm::vec2& center, float maxDistance, GameObjectClassMask classMask, const GameObject* ignoreObject = nullptr) const;
+
+    // Update game object location within spatial grid, gets called automatically when object moves
+    void RefreshObjectGridCell(GameObject* object);
+
     // Will immediately destroy gameobject, don't call this mehod during UpdateFrame
     // @param object: Object to destroy
     void DestroyGameObject(GameObject* object);
 
+    // Debug: spawn specified number of pedestrians, destroy some of them and print elapsed time to console
+    // @param numObjects: Total number of objects to spawn
+    // @param numDestroy: Number of random objects to destroy at once
+    void DebugBenchmarkDestroyObjects(int numObjects, int numDestroy);
+
+    // Debug: spawn specified number of pedestrians over map and compare spatial grid queries against other approaches
+    // @param numObjects: Number of objects to spawn
+    // @param numQueries: Number of random queries
+    void DebugBenchmarkSpatialQueries(int numObjects, int numQueries);
+
 private:
     bool CreateStartupObjects();
     void DestroyAllObjects();
     void DestroyMarkedForDeletionObjects();
+    void DeleteGameObjectInstance(GameObject* object);
+
+    // Reserve free slot in objects table and generate identifier for it
     GameObjectID GenerateUniqueID();
 
+    // Bind game object instance to its identifier slot
+    void RegisterObjectSlot(GameObject* object);
+    void FreeObjectSlot(GameObject* object);
+    void ClearObjectSlots();
+
+    // Find live object by its identifier within slots table, stale identifiers are rejected
+    GameObject* GetObjectFromSlot(GameObjectID objectID) const;
+
+    // Spatial grid internals
+    void RemoveObjectFromGrid(GameObject* object);
+    Point GetObjectsGridCell(const glm::vec2& position) const;
+    bool IsObjectMatchesQuery(const GameObject* object, GameObjectClassMask classMask) const;
+
 private:
-    GameObjectID mIDsCounter = 0;
+    // game object identifier packs slot index in lower bits and slot generation in upper bits,
+    // generation never gets zero so identifier is never equal to GAMEOBJECT_ID_NULL
+    static const unsigned int ObjectSlotIndexBits = 20;
+    static const unsigned int ObjectSlotIndexMask = (1U << ObjectSlotIndexBits) - 1;
+    static const unsigned int ObjectSlotGenerationMask = (~0U) >> ObjectSlotIndexBits;
+
+    struct ObjectSlot
+    {
+        GameObject* mObject = nullptr;
+        unsigned int mGeneration = 1;
+    };
+    std::vector<ObjectSlot> mObjectSlots;
+    std::vector<unsigned int> mFreeObjectSlots;
+
+    std::vector<GameObject*> mDestroyObjectsList; // scratch buffer, reused between frames
+
+    // spatial grid, one cell per map block, each cell holds list of objects located within it
+    std::vector<GameObject*> mObjectsGridCells; // y, x
 
     // objects pools
     cxx::object_pool<Pedestrian> mPedestriansPool;
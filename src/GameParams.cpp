@@ -41,6 +41,10 @@ void GameParams::SetToDefaults()
     mTrafficGenCarsChance = 65;
     mTrafficGenCarsMaxDistance = 4;
     mTrafficGenCarsCooldownTime = 3.0f;
+
+    mTrafficVirtualPedsDistance = 3;
+    mTrafficVirtualCarsDistance = 4;
+    mTrafficVirtualCarsSpeed = Convert::MapUnitsToMeters(1.5f);
     // explosion
     mExplosionRadius = Convert::MapUnitsToMeters(1.0f);
     // vehicles
@@ -53,6 +57,11 @@ void GameParams::SetToDefaults()
     // ai
     mAiReactOnGunshotsDistance = Convert::MapUnitsToMeters(4.0f);
     mAiReactOnExplosionsDistance = Convert::MapUnitsToMeters(5.0f);
+    mAiLodNearDistance = Convert::MapUnitsToMeters(2.0f);
+    mAiLodMidDistance = Convert::MapUnitsToMeters(8.0f);
+    mAiLodMidUpdateInterval = 4;
+    mAiLodFarUpdateInterval = 16;
+    mAiMaxUpdatesPerFrame = 64;
     // hud
     mHudBigFontMessageShowDuration = 3.0f;
     mHudCarNameShowDuration = 3.0f;
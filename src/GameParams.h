@@ -45,6 +45,11 @@ public:
     int mTrafficGenCarsMaxDistance; // maximum distance from player camera, blocks
     float mTrafficGenCarsCooldownTime; // seconds between traffic generation
 
+    // offscreen traffic
+    int mTrafficVirtualPedsDistance; // distance beyond generation area where pedestrians are simulated without physics, blocks
+    int mTrafficVirtualCarsDistance; // distance beyond generation area where cars are simulated without physics, blocks
+    float mTrafficVirtualCarsSpeed; // meters per second
+
     // explosion
     float mExplosionRadius; // how far explosion can do damage, meters
 
@@ -60,6 +65,11 @@ public:
     // ai
     float mAiReactOnGunshotsDistance; // how far pedestrians can hear gunshots
     float mAiReactOnExplosionsDistance; // how far pedestrians can hear explosions
+    float mAiLodNearDistance; // max distance from player view to update ai every frame, meters
+    float mAiLodMidDistance; // max distance from player view to update ai at mid rate, meters
+    int mAiLodMidUpdateInterval; // frames between updates of mid tier ai
+    int mAiLodFarUpdateInterval; // frames between updates of far tier ai
+    int mAiMaxUpdatesPerFrame; // max number of mid and far tier ai updates per frame
 
     // hud
     float mHudBigFontMessageShowDuration; // how long show 'wasted' on screen, seconds
@@ -10,6 +10,8 @@
 #include "ParticleEffectsManager.h"
 #include "TrafficManager.h"
 #include "AiManager.h"
+#include "MapNavigation.h"
+#include "FrameProfiler.h"
 
 void GameplayGamestate::OnGamestateEnter()
 {
@@ -25,15 +27,30 @@ void GameplayGamestate::OnGamestateFrame()
 {
     float deltaTime = gTimeManager.mGameFrameDelta;
     gCarnageGame.ProcessDebugCvars();
+    // map modifications of previous frame become visible to navigation, traffic and renderer
+    gGameMap.FlushChangedColumns();
+    // graph must reflect modified columns before ai queries paths
+    UpdateSubsystem(eGameplaySubsystem_Navigation, []() { gMapNavigation.UpdateFrame(); });
     // advance game state
-    gSpriteManager.UpdateBlocksAnimations(deltaTime);
-    gPhysics.UpdateFrame();
-    gGameObjectsManager.UpdateFrame();
-    gWeatherManager.UpdateFrame();
-    gParticleManager.UpdateFrame();
-    gTrafficManager.UpdateFrame();
-    gAiManager.UpdateFrame();
-    gBroadcastEvents.UpdateFrame();
+    UpdateSubsystem(eGameplaySubsystem_BlocksAnimations, [deltaTime]() { gSpriteManager.UpdateBlocksAnimations(deltaTime); });
+    UpdateSubsystem(eGameplaySubsystem_Physics, []() { gPhysics.UpdateFrame(); });
+    // ai decisions are applied before characters update so they take effect within same frame
+    UpdateSubsystem(eGameplaySubsystem_Ai, []() { gAiManager.UpdateFrame(); });
+    UpdateSubsystem(eGameplaySubsystem_GameObjects, []() { gGameObjectsManager.UpdateFrame(); });
+    UpdateSubsystem(eGameplaySubsystem_Weather, []() { gWeatherManager.UpdateFrame(); });
+    UpdateSubsystem(eGameplaySubsystem_Particles, []() { gParticleManager.UpdateFrame(); });
+    UpdateSubsystem(eGameplaySubsystem_Traffic, []() { gTrafficManager.UpdateFrame(); });
+    UpdateSubsystem(eGameplaySubsystem_BroadcastEvents, []() { gBroadcastEvents.UpdateFrame(); });
+}
+
+void GameplayGamestate::UpdateSubsystem(eGameplaySubsystem subsystem, const std::function<void()>& updateProc)
+{
+    PROFILER_SCOPE(cxx::enum_to_string(subsystem));
+
+    std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+    updateProc();
+    std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
+    mSubsystemsFrameTime[subsystem] = std::chrono::duration_cast<std::chrono::microseconds>(timeEnd - timeStart).count();
 }
 
 void GameplayGamestate::OnGamestateInputEvent(KeyInputEvent& inputEvent)
@@ -5,6 +5,11 @@
 // Main game
 class GameplayGamestate: public GenericGamestate
 {
+public:
+    // readonly
+    // last frame update time of each game system, in microseconds
+    long long mSubsystemsFrameTime[eGameplaySubsystem_COUNT] = {};
+
 public:
     GameplayGamestate() = default;
 
@@ -22,6 +27,9 @@ public:
     void OnGamestateBroadcastEvent(const BroadcastEvent& broadcastEvent) override;
 
 private:
+    // Run update procedure of specified game system and measure its frame time
+    void UpdateSubsystem(eGameplaySubsystem subsystem, const std::function<void()>& updateProc);
+
     void OnHumanPlayerDie(int playerIndex);
     void OnHumanPlayerStartDriveCar(int playerIndex);
 };
\ No newline at end of file
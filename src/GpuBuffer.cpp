@@ -47,6 +47,7 @@ GpuBuffer::GpuBuffer(GraphicsContext& graphicsContext, eBufferContent bufferCont
     , mUsageHint()
     , mBufferLength()
     , mBufferCapacity()
+    , mStreamCursor()
 {
     ::glGenBuffers(1, &mResourceHandle);
     glCheckError();
@@ -74,6 +75,7 @@ bool GpuBuffer::Setup(eBufferUsage bufferUsage, unsigned int bufferLength, const
 
     mBufferLength = bufferLength;
     mBufferCapacity = paddedContentLength;
+    mStreamCursor = 0;
     mUsageHint = bufferUsage;
     debug_assert(mUsageHint < eBufferUsage_COUNT);
 
@@ -100,6 +102,7 @@ bool GpuBuffer::Setup(eBufferUsage bufferUsage, unsigned int bufferLength, const
         else
         {
             ::memcpy(pMappedData, dataBuffer, bufferLength);
+            mGraphicsContext.mFrameStats.mUploadedBytes += bufferLength;
         }
 
         GLboolean unmapResult = ::glUnmapBuffer(bufferTargetGL);
@@ -184,17 +187,26 @@ bool GpuBuffer::SubData(unsigned int dataOffset, unsigned int dataLength, const
     GLenum bufferTargetGL = EnumToGL(mContent);
     ::glBufferSubData(bufferTargetGL, dataOffset, dataLength, dataSource);
     glCheckError();
+    mGraphicsContext.mFrameStats.mUploadedBytes += dataLength;
 
     return true;
 }
 
 void* GpuBuffer::Lock(BufferAccessBits accessBits)
+{
+    return LockRange(0, mBufferLength, accessBits);
+}
+
+void* GpuBuffer::LockRange(unsigned int dataOffset, unsigned int dataLength, BufferAccessBits accessBits)
 {
     if (!IsBufferInited())
     {
         debug_assert(false);
         return nullptr;
     }
+
+    debug_assert(dataLength > 0);
+    debug_assert(dataOffset + dataLength <= mBufferCapacity);
 
     ScopedBufferBinder scopedBind (mGraphicsContext, this);
     GLenum bufferTargetGL = EnumToGL(mContent);
@@ -206,7 +218,8 @@ void* GpuBuffer::Lock(BufferAccessBits accessBits)
         debug_assert(false); // reading is not supported
         return nullptr;
     }
-    pMappedData = ::glMapBufferRange(bufferTargetGL, 0, mBufferLength, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    pMappedData = ::glMapBufferRange(bufferTargetGL, dataOffset, dataLength, GL_MAP_WRITE_BIT | 
+        ((accessBits & BufferAccess_InvalidateBuffer) > 0 ? GL_MAP_INVALIDATE_BUFFER_BIT : GL_MAP_INVALIDATE_RANGE_BIT));
 
 #else
     GLbitfield accessBitsGL = ((accessBits & BufferAccess_Read) > 0 ? GL_MAP_READ_BIT : 0) |
@@ -216,10 +229,58 @@ void* GpuBuffer::Lock(BufferAccessBits accessBits)
         ((accessBits & BufferAccess_InvalidateBuffer) > 0 ? GL_MAP_INVALIDATE_BUFFER_BIT : 0);
 
     debug_assert(accessBitsGL > 0);
-    pMappedData = ::glMapBufferRange(bufferTargetGL, 0, mBufferLength, accessBitsGL);
+    pMappedData = ::glMapBufferRange(bufferTargetGL, dataOffset, dataLength, accessBitsGL);
 
 #endif
     glCheckError();
+    if (pMappedData && (accessBits & BufferAccess_Write) > 0)
+    {
+        mGraphicsContext.mFrameStats.mUploadedBytes += dataLength;
+    }
+    return pMappedData;
+}
+
+void* GpuBuffer::LockStream(unsigned int dataLength, unsigned int dataAlignment, unsigned int& outputOffset)
+{
+    if (!IsBufferInited())
+    {
+        debug_assert(false);
+        return nullptr;
+    }
+
+    debug_assert(dataLength > 0);
+
+    unsigned int dataOffset = mStreamCursor;
+    if (dataAlignment > 1)
+    {
+        dataOffset = ((dataOffset + dataAlignment - 1) / dataAlignment) * dataAlignment;
+    }
+
+    BufferAccessBits accessBits = BufferAccess_UnsynchronizedWrite | BufferAccess_InvalidateRange;
+    if (dataLength > mBufferCapacity)
+    {
+        // grow twice to avoid reallocations on next frames
+        if (!Setup(mUsageHint, std::max(dataLength, mBufferCapacity * 2), nullptr))
+            return nullptr;
+
+        dataOffset = 0;
+        ++mGraphicsContext.mFrameStats.mBufferOrphansCount;
+    }
+    else if (dataOffset + dataLength > mBufferCapacity)
+    {
+        // gpu may still read previous data, allocate new storage instead of waiting
+        dataOffset = 0;
+        accessBits = BufferAccess_Write | BufferAccess_InvalidateBuffer;
+        ++mGraphicsContext.mFrameStats.mBufferOrphansCount;
+    }
+
+    void* pMappedData = LockRange(dataOffset, dataLength, accessBits);
+    if (pMappedData == nullptr)
+        return nullptr;
+
+    mGraphicsContext.mFrameStats.mStreamedBytes += dataLength;
+    mStreamCursor = dataOffset + dataLength;
+    outputOffset = dataOffset;
     return pMappedData;
 }
 
@@ -12,6 +12,7 @@ public:
     eBufferUsage mUsageHint;
     unsigned int mBufferLength; // user requested length, bytes
     unsigned int mBufferCapacity; // actually allocated length, bytes
+    unsigned int mStreamCursor; // end of last streamed data, bytes
 
 public:
     // @param bufferContent: Content type stored in buffer, cannot be changed 
@@ -46,6 +47,22 @@ public:
         return static_cast<TElement*>(Lock(accessBits));
     }
 
+    // Map part of hardware buffer content to process memory
+    // @param dataOffset: Offset within buffer in bytes
+    // @param dataLength: Size of mapped range in bytes
+    // @param accessBits: Desired data access policy
+    // @return Pointer to range data or null on fail
+    void* LockRange(unsigned int dataOffset, unsigned int dataLength, BufferAccessBits accessBits);
+
+    // Map range for writing right after previously streamed data, range gets mapped unsynchronized
+    // since gpu never reads data that was not written yet; when end of buffer is reached
+    // buffer gets orphaned and writing starts from beginning
+    // @param dataLength: Size of data to write in bytes
+    // @param dataAlignment: Alignment of range offset in bytes
+    // @param outputOffset: Offset of mapped range within buffer in bytes
+    // @return Pointer to range data or null on fail
+    void* LockStream(unsigned int dataLength, unsigned int dataAlignment, unsigned int& outputOffset);
+
     // Unmap buffer object data source
     // @return false on fail, indicates that buffer should be reload
     bool Unlock();
@@ -30,4 +30,5 @@ public:
     GpuProgram* mCurrentProgram;
     eTextureUnit mCurrentTextureUnit;
     TextureUnitState mCurrentTextures[eTextureUnit_COUNT];
+    GraphicsFrameStats mFrameStats; // current frame
 };
\ No newline at end of file
@@ -333,6 +333,7 @@ enum eVertexAttributeFormat
     eVertexAttributeFormat_1US,     // 1 unsigned short
     eVertexAttributeFormat_2US,     // 2 unsigned shorts
     eVertexAttributeFormat_4US,     // 4 unsigned shorts
+    eVertexAttributeFormat_4H,      // 4 half floats
     eVertexAttributeFormat_Unknown
 };
 
@@ -368,6 +369,7 @@ inline unsigned int GetAttributeComponentCount(eVertexAttributeFormat attributeF
         case eVertexAttributeFormat_1US: return 1;
         case eVertexAttributeFormat_2US: return 2;
         case eVertexAttributeFormat_4US: return 4;
+        case eVertexAttributeFormat_4H: return 4;
         default: break;
     }
     debug_assert(false);
@@ -387,6 +389,7 @@ inline unsigned int GetAttributeSizeBytes(eVertexAttributeFormat attributeFormat
         case eVertexAttributeFormat_1US: return 1 * sizeof(unsigned short);
         case eVertexAttributeFormat_2US: return 2 * sizeof(unsigned short);
         case eVertexAttributeFormat_4US: return 4 * sizeof(unsigned short);
+        case eVertexAttributeFormat_4H: return 4 * sizeof(unsigned short);
         default: break;
     }
     debug_assert(false);
@@ -410,11 +413,18 @@ public:
         mAttributes[attribute].mDataOffset = dataOffset;
         mAttributes[attribute].mFormat = attributeFormat;
         mAttributes[attribute].mNormalized = false;
+        mAttributes[attribute].mPerInstance = false;
     }
     inline void SetAttributeNormalized(eVertexAttribute attribute, bool isNormalized = true)
     {
         debug_assert(attribute < eVertexAttribute_COUNT);
         mAttributes[attribute].mNormalized = isNormalized;
+    }
+    // Attribute advances once per instance instead of once per vertex, requires instanced arrays feature
+    inline void SetAttributePerInstance(eVertexAttribute attribute, bool isPerInstance = true)
+    {
+        debug_assert(attribute < eVertexAttribute_COUNT);
+        mAttributes[attribute].mPerInstance = isPerInstance;
     }
 public:
     struct SingleAttribute
@@ -429,6 +439,7 @@ public:
         // if set to true, it indicates that values stored in an integer format are 
         // to be mapped to the range [-1,1] (for signed values) or [0,1] (for unsigned values) when they are accessed and converted to floating point
         bool mNormalized = false;
+        bool mPerInstance = false;
     };
     SingleAttribute mAttributes[eVertexAttribute_COUNT];
     unsigned int mDataStride = 0; // common to all attributes
@@ -711,6 +722,7 @@ enum eGraphicsFeature
 {
     eGraphicsFeature_NPOT_Textures,
     eGraphicsFeature_ABGR,
+    eGraphicsFeature_InstancedArrays, // per instance vertex attributes
     eGraphicsFeature_COUNT
 };
 
@@ -723,4 +735,16 @@ public:
     int mMaxArrayTextureLayers;
     int mMaxTextureBufferSize;
     bool mFeatures[eGraphicsFeature_COUNT];
+};
+
+// buffers data transfer statistics, per frame
+struct GraphicsFrameStats
+{
+public:
+    GraphicsFrameStats() = default;
+
+public:
+    unsigned int mUploadedBytes = 0; // all data written to buffers, including streamed
+    unsigned int mStreamedBytes = 0; // data appended to streaming buffers
+    int mBufferOrphansCount = 0; // streaming buffers reallocations
 };
\ No newline at end of file
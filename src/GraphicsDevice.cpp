@@ -733,6 +733,24 @@ void GraphicsDevice::RenderIndexedPrimitives(ePrimitiveType primitive, eIndicesT
     glCheckError();
 }
 
+void GraphicsDevice::RenderIndexedPrimitivesInstanced(ePrimitiveType primitive, eIndicesType indices, unsigned int offset, unsigned int numIndices, unsigned int numInstances)
+{
+    if (!IsDeviceInited())
+    {
+        debug_assert(false);
+        return;
+    }
+
+    GpuBuffer* indexBuffer = mGraphicsContext.mCurrentBuffers[eBufferContent_Indices];
+    GpuBuffer* vertexBuffer = mGraphicsContext.mCurrentBuffers[eBufferContent_Vertices];
+    debug_assert(indexBuffer && vertexBuffer && mGraphicsContext.mCurrentProgram);
+
+    GLenum primitives = EnumToGL(primitive);
+    GLenum indicesTypeGL = EnumToGL(indices);
+    ::glDrawElementsInstanced(primitives, numIndices, indicesTypeGL, BUFFER_OFFSET(offset), numInstances);
+    glCheckError();
+}
+
 void GraphicsDevice::RenderPrimitives(ePrimitiveType primitiveType, unsigned int firstIndex, unsigned int numElements)
 {
     if (!IsDeviceInited())
@@ -758,6 +776,10 @@ void GraphicsDevice::Present()
     }
 
     ::glfwSwapBuffers(mGraphicsWindow);
+
+    mLastFrameStats = mGraphicsContext.mFrameStats;
+    mGraphicsContext.mFrameStats = GraphicsFrameStats();
+
     // process window messages
     ::glfwPollEvents();
     if (::glfwWindowShouldClose(mGraphicsWindow) == GL_TRUE)
@@ -945,7 +967,7 @@ void GraphicsDevice::SetupVertexAttributes(const VertexFormat& streamDefinition)
 
         GLenum dataType = GetAttributeDataTypeGL(attribute.mFormat);
 
-        if (dataType == GL_FLOAT || attribute.mNormalized)
+        if (dataType == GL_FLOAT || dataType == GL_HALF_FLOAT || attribute.mNormalized)
         {
             // set attribute location
             ::glVertexAttribPointer(currentProgram->mAttributes[iattribute], numComponents, dataType, 
@@ -958,6 +980,29 @@ void GraphicsDevice::SetupVertexAttributes(const VertexFormat& streamDefinition)
                 streamDefinition.mDataStride, BUFFER_OFFSET(attribute.mDataOffset + streamDefinition.mBaseOffset));
         }
         glCheckError();
+
+        // divisor is part of vertex array state, so it must be reset for regular attributes too
+        if (mCaps.mFeatures[eGraphicsFeature_InstancedArrays])
+        {
+#ifdef __EMSCRIPTEN__
+            ::glVertexAttribDivisor(currentProgram->mAttributes[iattribute], attribute.mPerInstance ? 1 : 0);
+#else
+            // core entry point is available since 3.3, older contexts provide extension one
+            if (GLEW_VERSION_3_3)
+            {
+                ::glVertexAttribDivisor(currentProgram->mAttributes[iattribute], attribute.mPerInstance ? 1 : 0);
+            }
+            else
+            {
+                ::glVertexAttribDivisorARB(currentProgram->mAttributes[iattribute], attribute.mPerInstance ? 1 : 0);
+            }
+#endif
+            glCheckError();
+        }
+        else
+        {
+            debug_assert(!attribute.mPerInstance);
+        }
     }
 }
 
@@ -1119,6 +1164,13 @@ void GraphicsDevice::QueryGraphicsDeviceCaps()
 {
     mCaps.mFeatures[eGraphicsFeature_NPOT_Textures] = (GLEW_ARB_texture_non_power_of_two == GL_TRUE);
     mCaps.mFeatures[eGraphicsFeature_ABGR] = (GLEW_EXT_abgr == GL_TRUE);
+#ifdef __EMSCRIPTEN__
+    // webgl 2 has instanced arrays in core
+    mCaps.mFeatures[eGraphicsFeature_InstancedArrays] = true;
+#else
+    // core since 3.3, extension string is not necessarily listed in that case
+    mCaps.mFeatures[eGraphicsFeature_InstancedArrays] = (GLEW_VERSION_3_3 == GL_TRUE) || (GLEW_ARB_instanced_arrays == GL_TRUE);
+#endif
 
     ::glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &mCaps.mMaxTextureBufferSize);
     glCheckError();
@@ -1129,6 +1181,7 @@ void GraphicsDevice::QueryGraphicsDeviceCaps()
     gConsole.LogMessage(eLogMessage_Info, "Graphics Device caps:");
     gConsole.LogMessage(eLogMessage_Info, " - max array texture layers: %d", mCaps.mMaxArrayTextureLayers);
     gConsole.LogMessage(eLogMessage_Info, " - max texture buffer size: %d bytes", mCaps.mMaxTextureBufferSize);
+    gConsole.LogMessage(eLogMessage_Info, " - instanced arrays: %s", mCaps.mFeatures[eGraphicsFeature_InstancedArrays] ? "yes" : "no");
 }
 
 void GraphicsDevice::ActivateTextureUnit(eTextureUnit textureUnit)
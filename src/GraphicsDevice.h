@@ -13,6 +13,7 @@ public:
     Rect mViewportRect;
     Rect mScissorBox;
     GraphicsDeviceCaps mCaps;
+    GraphicsFrameStats mLastFrameStats;
 
     // these params will automatically set during texture creation
     eTextureFilterMode mDefaultTextureFilter = eTextureFilterMode_Nearest;
@@ -116,6 +117,10 @@ public:
     void RenderIndexedPrimitives(ePrimitiveType primitive, eIndicesType indicesType, unsigned int offset, unsigned int numIndices);
     void RenderIndexedPrimitives(ePrimitiveType primitive, eIndicesType indicesType, unsigned int offset, unsigned int numIndices, unsigned int baseVertex);
 
+    // Render multiple instances of indexed geometry, per instance attributes advance once per instance
+    // @param numInstances: Number of instances
+    void RenderIndexedPrimitivesInstanced(ePrimitiveType primitive, eIndicesType indicesType, unsigned int offset, unsigned int numIndices, unsigned int numInstances);
+
     // Render geometry
     // @param primitiveType: Type of primitives to render
     // @param firstIndex: Start position in attribute buffers, index
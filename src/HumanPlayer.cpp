@@ -41,7 +41,11 @@ void HumanPlayer::EnterGameScenario()
     {
         mSpawnPosition = mCharacter->mTransform.mPosition;
         mFollowCameraController.SetFollowTarget(mCharacter);
-        mHUD.InitHUD(this);
+        // hud is not required when running without graphics
+        if (gGraphicsDevice.IsDeviceInited())
+        {
+            mHUD.InitHUD(this);
+        }
     }
     gRenderManager.AttachRenderView(&mViewCamera);
 }
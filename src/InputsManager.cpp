@@ -3,6 +3,8 @@
 #include "ImGuiManager.h"
 #include "CarnageGame.h"
 #include "ConsoleWindow.h"
+#include "ReplayManager.h"
+#include "FrameProfilerWindow.h"
 
 InputsManager gInputs;
 
@@ -13,6 +15,9 @@ InputsManager::InputsManager()
 
 void InputsManager::InputEvent(MouseButtonInputEvent& inputEvent)
 {
+    if (!gReplayManager.ProcessInputEvent(inputEvent))
+        return;
+
     mMouseButtons[inputEvent.mButton] = inputEvent.mPressed;
 
     for (InputEventsHandler* currentHandler: mInputHandlers)
@@ -28,6 +33,9 @@ void InputsManager::InputEvent(MouseButtonInputEvent& inputEvent)
 
 void InputsManager::InputEvent(MouseMovedInputEvent& inputEvent)
 {
+    if (!gReplayManager.ProcessInputEvent(inputEvent))
+        return;
+
     mCursorPositionX = inputEvent.mCursorPositionX;
     mCursorPositionY = inputEvent.mCursorPositionY;
 
@@ -44,6 +52,9 @@ void InputsManager::InputEvent(MouseMovedInputEvent& inputEvent)
 
 void InputsManager::InputEvent(MouseScrollInputEvent& inputEvent)
 {
+    if (!gReplayManager.ProcessInputEvent(inputEvent))
+        return;
+
     for (InputEventsHandler* currentHandler: mInputHandlers)
     {
         currentHandler->InputEvent(inputEvent);
@@ -57,6 +68,9 @@ void InputsManager::InputEvent(MouseScrollInputEvent& inputEvent)
 
 void InputsManager::InputEvent(GamepadInputEvent& inputEvent)
 {
+    if (!gReplayManager.ProcessInputEvent(inputEvent))
+        return;
+
     debug_assert(inputEvent.mGamepad < eGamepadID_COUNT);
     debug_assert(inputEvent.mButton < eGamepadButton_COUNT);
     mGamepadsState[inputEvent.mGamepad].mButtons[inputEvent.mButton] = inputEvent.mPressed;
@@ -74,6 +88,9 @@ void InputsManager::InputEvent(GamepadInputEvent& inputEvent)
 
 void InputsManager::InputEvent(KeyInputEvent& inputEvent)
 {
+    if (!gReplayManager.ProcessInputEvent(inputEvent))
+        return;
+
     if (HandleDebugKeys(inputEvent))
     {
         InputEventConsumed(nullptr);
@@ -95,6 +112,9 @@ void InputsManager::InputEvent(KeyInputEvent& inputEvent)
 
 void InputsManager::InputEvent(KeyCharEvent& inputEvent)
 {
+    if (!gReplayManager.ProcessInputEvent(inputEvent))
+        return;
+
     for (InputEventsHandler* currentHandler: mInputHandlers)
     {
         currentHandler->InputEvent(inputEvent);
@@ -163,5 +183,16 @@ bool InputsManager::HandleDebugKeys(KeyInputEvent& inputEvent)
         return true;
     }
 
+    // show/hide frame profiler window
+    if (inputEvent.HasPressed(eKeycode_F2) || inputEvent.HasReleased(eKeycode_F2))
+    {
+        if (inputEvent.HasPressed(eKeycode_F2))
+        {
+            gFrameProfilerWindow.ToggleWindowShown();
+        }
+        inputEvent.SetConsumed();
+        return true;
+    }
+
     return false;
 }
@@ -0,0 +1,152 @@
+#include "stdafx.h"
+#include "JobsManager.h"
+#include "cvars.h"
+#include "FrameProfiler.h"
+
+JobsManager gJobsManager;
+
+JobsManager::~JobsManager()
+{
+    debug_assert(mWorkerThreads.empty());
+}
+
+bool JobsManager::Initialize()
+{
+    gConsole.LogMessage(eLogMessage_Info, "Init JobsManager");
+
+    int numThreads = gCvarSysWorkerThreads.mValue;
+    if (numThreads < 0) // auto detect
+    {
+        numThreads = std::max((int) std::thread::hardware_concurrency() - 1, 0);
+    }
+
+#ifdef __EMSCRIPTEN__
+    numThreads = 0; // threads are not available
+#endif
+
+    SetWorkerThreadsCount(numThreads);
+    gConsole.LogMessage(eLogMessage_Info, "Worker threads count: %d", GetWorkerThreadsCount());
+    return true;
+}
+
+void JobsManager::Deinit()
+{
+    StopWorkerThreads();
+}
+
+void JobsManager::SetWorkerThreadsCount(int numThreads)
+{
+    debug_assert(numThreads >= 0);
+    if (numThreads == GetWorkerThreadsCount())
+        return;
+
+    StopWorkerThreads();
+
+    mShutdownRequested = false;
+    mWorkerThreads.reserve(numThreads);
+    for (int ithread = 0; ithread < numThreads; ++ithread)
+    {
+        mWorkerThreads.emplace_back(&JobsManager::WorkerThreadProc, this, mJobsGeneration);
+    }
+}
+
+int JobsManager::GetWorkerThreadsCount() const
+{
+    return (int) mWorkerThreads.size();
+}
+
+void JobsManager::ParallelFor(int jobsCount, const std::function<void(int jobIndex)>& jobProc)
+{
+    debug_assert(mJobProc == nullptr);
+    if (jobsCount < 1)
+        return;
+
+    if (mWorkerThreads.empty() || jobsCount == 1)
+    {
+        for (int ijob = 0; ijob < jobsCount; ++ijob)
+        {
+            jobProc(ijob);
+        }
+        return;
+    }
+
+    // wake up workers
+    {
+        std::lock_guard<std::mutex> lock(mJobsMutex);
+        mJobProc = &jobProc;
+        mJobsCount = jobsCount;
+        mNextJobIndex = 0;
+        mActiveWorkersCount = (int) mWorkerThreads.size();
+        ++mJobsGeneration;
+    }
+    mJobsStartCondition.notify_all();
+
+    ProcessJobs();
+
+    // wait until all workers have finished current batch
+    std::unique_lock<std::mutex> lock(mJobsMutex);
+    mJobsDoneCondition.wait(lock, [this]()
+        {
+            return mActiveWorkersCount == 0;
+        });
+    mJobProc = nullptr;
+    mJobsCount = 0;
+}
+
+void JobsManager::WorkerThreadProc(unsigned int processedGeneration)
+{
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mJobsMutex);
+            mJobsStartCondition.wait(lock, [this, processedGeneration]()
+                {
+                    return mShutdownRequested || mJobsGeneration != processedGeneration;
+                });
+
+            if (mShutdownRequested)
+                break;
+
+            processedGeneration = mJobsGeneration;
+        }
+
+        ProcessJobs();
+
+        std::lock_guard<std::mutex> lock(mJobsMutex);
+        if (--mActiveWorkersCount == 0)
+        {
+            mJobsDoneCondition.notify_one();
+        }
+    }
+}
+
+void JobsManager::ProcessJobs()
+{
+    for (;;)
+    {
+        int jobIndex = mNextJobIndex.fetch_add(1);
+        if (jobIndex >= mJobsCount)
+            break;
+
+        PROFILER_SCOPE("Job");
+        (*mJobProc)(jobIndex);
+    }
+}
+
+void JobsManager::StopWorkerThreads()
+{
+    if (mWorkerThreads.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mJobsMutex);
+        mShutdownRequested = true;
+    }
+    mJobsStartCondition.notify_all();
+
+    for (std::thread& currThread: mWorkerThreads)
+    {
+        currThread.join();
+    }
+    mWorkerThreads.clear();
+}
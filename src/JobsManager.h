@@ -0,0 +1,47 @@
+#pragma once
+
+// defines system worker threads manager class, it runs data parallel jobs
+class JobsManager final: public cxx::noncopyable
+{
+public:
+    ~JobsManager();
+
+    // setup manager internal resources, starts worker threads
+    // @returns false on error
+    bool Initialize();
+
+    void Deinit();
+
+    // Restart worker threads
+    // @param numThreads: Number of worker threads, zero means that all jobs will run on calling thread
+    void SetWorkerThreadsCount(int numThreads);
+    int GetWorkerThreadsCount() const;
+
+    // Run job for each index in range [0, jobsCount) and wait until all of them complete, 
+    // calling thread takes part in processing too, nested calls are not allowed
+    // @param jobsCount: Number of jobs
+    // @param jobProc: Job procedure, receives job index
+    void ParallelFor(int jobsCount, const std::function<void(int jobIndex)>& jobProc);
+
+private:
+    void WorkerThreadProc(unsigned int processedGeneration);
+    void ProcessJobs();
+    void StopWorkerThreads();
+
+private:
+    std::vector<std::thread> mWorkerThreads;
+
+    std::mutex mJobsMutex;
+    std::condition_variable mJobsStartCondition;
+    std::condition_variable mJobsDoneCondition;
+
+    // current jobs batch
+    const std::function<void(int jobIndex)>* mJobProc = nullptr;
+    int mJobsCount = 0;
+    std::atomic<int> mNextJobIndex;
+    int mActiveWorkersCount = 0;
+    unsigned int mJobsGeneration = 0;
+    bool mShutdownRequested = false;
+};
+
+extern JobsManager gJobsManager;
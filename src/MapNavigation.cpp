@@ -0,0 +1,742 @@
+#include "stdafx.h"
+#include "MapNavigation.h"
+#include "GameMapManager.h"
+
+MapNavigation gMapNavigation;
+
+//////////////////////////////////////////////////////////////////////////
+
+static const int NavDirectionsCount = 4;
+
+// neighbour column offsets for each direction bit: n, e, s, w
+static const Point NavDirectionOffsets[NavDirectionsCount] =
+{
+    { 0, -1},
+    { 1,  0},
+    { 0,  1},
+    {-1,  0},
+};
+
+// goal field cell values other than directions
+static const unsigned char GoalFieldCell_Unreached = 0xFF;
+static const unsigned char GoalFieldCell_Goal = NavDirectionsCount;
+
+inline int GetNavNodeIndex(int coordx, int coordz)
+{
+    return coordz * MAP_DIMENSIONS + coordx;
+}
+
+//////////////////////////////////////////////////////////////////////////
+
+MapNavigation::MapNavigation()
+    : mQueriesCount(0)
+    , mCacheHitsCount(0)
+{
+}
+
+void MapNavigation::BuildNavGraph(const GameMapManager& cityScape)
+{
+    std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+
+    Cleanup();
+
+    for (int coordz = 0; coordz < MAP_DIMENSIONS; ++coordz)
+    for (int coordx = 0; coordx < MAP_DIMENSIONS; ++coordx)
+    {
+        UpdateNavNode(cityScape, coordx, coordz);
+    }
+
+    // exits depend on neighbour nodes so they are resolved in second pass
+    for (int coordz = 0; coordz < MAP_DIMENSIONS; ++coordz)
+    for (int coordx = 0; coordx < MAP_DIMENSIONS; ++coordx)
+    {
+        UpdateNavNodeExits(coordx, coordz);
+    }
+
+    for (const NavNode& currNode: mNavNodes)
+    {
+        if (currNode.mFlags & NavNodeFlags_Walkable)
+        {
+            ++mNavStats.mWalkableNodesCount;
+        }
+        if (currNode.mFlags & NavNodeFlags_Drivable)
+        {
+            ++mNavStats.mDrivableNodesCount;
+        }
+    }
+
+    std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
+    mNavStats.mBuildTime = std::chrono::duration<float, std::micro>(timeEnd - timeStart).count();
+}
+
+void MapNavigation::Cleanup()
+{
+    for (NavNode& currNode: mNavNodes)
+    {
+        currNode = NavNode();
+    }
+    mNavStats = NavStats();
+    ClearGoalFields();
+}
+
+void MapNavigation::ClearGoalFields()
+{
+    std::lock_guard<std::mutex> lock(mGoalFieldsMutex);
+    for (GoalFieldSlot& currSlot: mGoalFields)
+    {
+        currSlot = GoalFieldSlot();
+    }
+    mGoalFieldsUseCounter = 0;
+}
+
+void MapNavigation::UpdateFrame()
+{
+    const std::vector<Point>& changedColumns = gGameMap.GetChangedColumns();
+    if (changedColumns.empty())
+        return;
+
+    // fields might route through modified columns, there are no queries running at this point
+    ClearGoalFields();
+
+    for (const Point& currColumn: changedColumns)
+    {
+        UpdateNavNode(gGameMap, currColumn.x, currColumn.y);
+    }
+
+    for (const Point& currColumn: changedColumns)
+    {
+        UpdateNavNodeExits(currColumn.x, currColumn.y);
+        // neighbours might lose or gain exits to modified column
+        for (const Point& currOffset: NavDirectionOffsets)
+        {
+            int neighbourx = currColumn.x + currOffset.x;
+            int neighbourz = currColumn.y + currOffset.y;
+            if (neighbourx > -1 && neighbourx < MAP_DIMENSIONS && neighbourz > -1 && neighbourz < MAP_DIMENSIONS)
+            {
+                UpdateNavNodeExits(neighbourx, neighbourz);
+            }
+        }
+    }
+}
+
+bool MapNavigation::IsNavigable(eNavAgent agent, int coordx, int coordz) const
+{
+    if (coordx < 0 || coordx >= MAP_DIMENSIONS || coordz < 0 || coordz >= MAP_DIMENSIONS)
+        return false;
+
+    const NavNode& navNode = mNavNodes[GetNavNodeIndex(coordx, coordz)];
+    if (agent == eNavAgent_Car)
+        return (navNode.mFlags & NavNodeFlags_Drivable) > 0;
+
+    return (navNode.mFlags & (NavNodeFlags_Walkable | NavNodeFlags_Crossing)) > 0;
+}
+
+bool MapNavigation::StepWander(eNavAgent agent, glm::ivec3& block, int& direction, cxx::randomizer& random) const
+{
+    if (!IsNavigable(agent, block.x, block.z))
+        return false;
+
+    const NavNode& navNode = mNavNodes[GetNavNodeIndex(block.x, block.z)];
+    const unsigned char nodeExits = (agent == eNavAgent_Car) ? navNode.mCarExits : navNode.mWalkExits;
+    if (nodeExits == 0)
+        return false;
+
+    // turning back is allowed only in dead ends
+    const int reverseDirection = (direction + 2) % NavDirectionsCount;
+    unsigned char candidateExits = nodeExits & ~BIT(reverseDirection);
+    if (candidateExits == 0)
+    {
+        candidateExits = nodeExits;
+    }
+
+    if (agent == eNavAgent_Pedestrian)
+    {
+        unsigned char pavementExits = 0;
+        for (int idirection = 0; idirection < NavDirectionsCount; ++idirection)
+        {
+            if ((candidateExits & BIT(idirection)) == 0)
+                continue;
+
+            const int neighbourIndex = GetNavNodeIndex(block.x + NavDirectionOffsets[idirection].x, block.z + NavDirectionOffsets[idirection].y);
+            if ((mNavNodes[neighbourIndex].mFlags & NavNodeFlags_Crossing) == 0)
+            {
+                pavementExits |= BIT(idirection);
+            }
+        }
+        if (pavementExits)
+        {
+            candidateExits = pavementExits;
+        }
+    }
+
+    // cars keep going straight until junction, pedestrians turn occasionally
+    bool keepDirection = (candidateExits & BIT(direction)) > 0;
+    if (keepDirection)
+    {
+        if (agent == eNavAgent_Car)
+        {
+            keepDirection = ((navNode.mFlags & NavNodeFlags_Junction) == 0) || random.random_chance(50);
+        }
+        else
+        {
+            keepDirection = random.random_chance(75);
+        }
+    }
+    if (!keepDirection)
+    {
+        int candidatesCount = 0;
+        for (int idirection = 0; idirection < NavDirectionsCount; ++idirection)
+        {
+            if (candidateExits & BIT(idirection))
+            {
+                ++candidatesCount;
+            }
+        }
+        int candidateIndex = random.generate_int(0, candidatesCount - 1);
+        for (int idirection = 0; idirection < NavDirectionsCount; ++idirection)
+        {
+            if ((candidateExits & BIT(idirection)) && (candidateIndex-- == 0))
+            {
+                direction = idirection;
+                break;
+            }
+        }
+    }
+
+    block.x += NavDirectionOffsets[direction].x;
+    block.z += NavDirectionOffsets[direction].y;
+    block.y = mNavNodes[GetNavNodeIndex(block.x, block.z)].mLayer;
+    return true;
+}
+
+bool MapNavigation::FindPath(eNavAgent agent, const glm::ivec3& start, const glm::ivec3& goal, NavPath& outputPath)
+{
+    outputPath.Clear();
+
+    if (!IsNavigable(agent, start.x, start.z) || !IsNavigable(agent, goal.x, goal.z))
+        return false;
+
+    ++mQueriesCount;
+
+    const int startNode = GetNavNodeIndex(start.x, start.z);
+    const int goalNode = GetNavNodeIndex(goal.x, goal.z);
+
+    // graph is not modified while queries are running
+    const bool isGoalFieldReachable = abs(start.x - goal.x) <= GoalFieldRadius && abs(start.z - goal.z) <= GoalFieldRadius;
+
+    glm::ivec3 regionGoal;
+    if (isGoalFieldReachable && GetRegionGoal(agent, goal.x, goal.z, regionGoal) && regionGoal.x == goal.x && regionGoal.z == goal.z)
+    {
+        bool isCached = false;
+        std::shared_ptr<const GoalField> goalField = GetGoalField(agent, goalNode, isCached);
+        if (TraceGoalField(*goalField, startNode, outputPath.mWaypoints))
+        {
+            if (isCached)
+            {
+                ++mCacheHitsCount;
+            }
+            return true;
+        }
+        // start is not connected to goal within field
+    }
+    return SearchPath(agent, startNode, goalNode, outputPath.mWaypoints);
+}
+
+bool MapNavigation::GetRegionGoal(eNavAgent agent, int coordx, int coordz, glm::ivec3& outputGoal) const
+{
+    if (coordx < 0 || coordx >= MAP_DIMENSIONS || coordz < 0 || coordz >= MAP_DIMENSIONS)
+        return false;
+
+    const int regionx = (coordx / NavRegionSize) * NavRegionSize;
+    const int regionz = (coordz / NavRegionSize) * NavRegionSize;
+    const int centerx = regionx + NavRegionSize / 2;
+    const int centerz = regionz + NavRegionSize / 2;
+
+    int bestDistance = -1;
+    for (int currz = regionz; currz < regionz + NavRegionSize; ++currz)
+    for (int currx = regionx; currx < regionx + NavRegionSize; ++currx)
+    {
+        if (!IsNavigable(agent, currx, currz))
+            continue;
+
+        const NavNode& navNode = mNavNodes[GetNavNodeIndex(currx, currz)];
+        const unsigned char nodeExits = (agent == eNavAgent_Car) ? navNode.mCarExits : navNode.mWalkExits;
+        if (nodeExits == 0)
+            continue;
+
+        const int currDistance = abs(currx - centerx) + abs(currz - centerz);
+        if (bestDistance == -1 || currDistance < bestDistance)
+        {
+            bestDistance = currDistance;
+            outputGoal = glm::ivec3(currx, navNode.mLayer, currz);
+        }
+    }
+    return bestDistance > -1;
+}
+
+std::shared_ptr<const MapNavigation::GoalField> MapNavigation::GetGoalField(eNavAgent agent, int goalNode, bool& isCached)
+{
+    {
+        std::lock_guard<std::mutex> lock(mGoalFieldsMutex);
+        for (GoalFieldSlot& currSlot: mGoalFields)
+        {
+            if (currSlot.mGoalField && currSlot.mGoalField->mAgent == agent && currSlot.mGoalField->mGoalNode == goalNode)
+            {
+                currSlot.mLastUse = ++mGoalFieldsUseCounter;
+                isCached = true;
+                return currSlot.mGoalField;
+            }
+        }
+    }
+
+    // build outside of lock so other queries are not stalled,
+    // if another thread builds same field meanwhile one of copies just gets replaced later
+    isCached = false;
+    std::shared_ptr<const GoalField> goalField = BuildGoalField(agent, goalNode);
+
+    std::lock_guard<std::mutex> lock(mGoalFieldsMutex);
+    GoalFieldSlot* replaceSlot = &mGoalFields[0];
+    for (GoalFieldSlot& currSlot: mGoalFields)
+    {
+        if (currSlot.mLastUse < replaceSlot->mLastUse) // empty slots have zero stamp
+        {
+            replaceSlot = &currSlot;
+        }
+    }
+    replaceSlot->mGoalField = goalField;
+    replaceSlot->mLastUse = ++mGoalFieldsUseCounter;
+    return goalField;
+}
+
+std::shared_ptr<const MapNavigation::GoalField> MapNavigation::BuildGoalField(eNavAgent agent, int goalNode) const
+{
+    struct OpenEntry
+    {
+        int mCost;
+        int mCell;
+    };
+    static thread_local std::vector<int> cellCosts;
+    static thread_local std::vector<OpenEntry> openList;
+
+    auto CompareEntries = [](const OpenEntry& lhs, const OpenEntry& rhs)
+    {
+        return lhs.mCost > rhs.mCost; // min heap
+    };
+
+    std::shared_ptr<GoalField> goalField = std::make_shared<GoalField>();
+    goalField->mAgent = agent;
+    goalField->mGoalNode = goalNode;
+    goalField->mNextDirections.assign(GoalFieldDimensions * GoalFieldDimensions, GoalFieldCell_Unreached);
+
+    cellCosts.assign(GoalFieldDimensions * GoalFieldDimensions, std::numeric_limits<int>::max());
+    openList.clear();
+
+    // field window is centered on goal
+    const int originx = goalNode % MAP_DIMENSIONS - GoalFieldRadius;
+    const int originz = goalNode / MAP_DIMENSIONS - GoalFieldRadius;
+    const int goalCell = GoalFieldRadius * GoalFieldDimensions + GoalFieldRadius;
+    cellCosts[goalCell] = 0;
+    goalField->mNextDirections[goalCell] = GoalFieldCell_Goal;
+    openList.push_back({0, goalCell});
+
+    // dijkstra over reversed edges, so every reached cell knows its step towards goal
+    while (!openList.empty())
+    {
+        std::pop_heap(openList.begin(), openList.end(), CompareEntries);
+        const OpenEntry currEntry = openList.back();
+        openList.pop_back();
+
+        if (currEntry.mCost > cellCosts[currEntry.mCell]) // stale entry
+            continue;
+
+        const int currx = originx + currEntry.mCell % GoalFieldDimensions;
+        const int currz = originz + currEntry.mCell / GoalFieldDimensions;
+        const int enterCost = currEntry.mCost + GetNodeCost(agent, mNavNodes[GetNavNodeIndex(currx, currz)]);
+        for (int idirection = 0; idirection < NavDirectionsCount; ++idirection)
+        {
+            const int neighbourx = currx + NavDirectionOffsets[idirection].x;
+            const int neighbourz = currz + NavDirectionOffsets[idirection].y;
+            const int neighbourCellx = neighbourx - originx;
+            const int neighbourCellz = neighbourz - originz;
+            if (neighbourCellx < 0 || neighbourCellx >= GoalFieldDimensions || neighbourCellz < 0 || neighbourCellz >= GoalFieldDimensions)
+                continue;
+
+            if (neighbourx < 0 || neighbourx >= MAP_DIMENSIONS || neighbourz < 0 || neighbourz >= MAP_DIMENSIONS)
+                continue;
+
+            // neighbour must have exit leading back to current cell
+            const int reverseDirection = (idirection + 2) % NavDirectionsCount;
+            const NavNode& neighbourNode = mNavNodes[GetNavNodeIndex(neighbourx, neighbourz)];
+            const unsigned char nodeExits = (agent == eNavAgent_Car) ? neighbourNode.mCarExits : neighbourNode.mWalkExits;
+            if ((nodeExits & BIT(reverseDirection)) == 0)
+                continue;
+
+            const int neighbourCell = neighbourCellz * GoalFieldDimensions + neighbourCellx;
+            if (cellCosts[neighbourCell] <= enterCost)
+                continue;
+
+            cellCosts[neighbourCell] = enterCost;
+            goalField->mNextDirections[neighbourCell] = (unsigned char) reverseDirection;
+            openList.push_back({enterCost, neighbourCell});
+            std::push_heap(openList.begin(), openList.end(), CompareEntries);
+        }
+    }
+    return goalField;
+}
+
+bool MapNavigation::TraceGoalField(const GoalField& goalField, int startNode, std::vector<glm::ivec3>& outputWaypoints) const
+{
+    outputWaypoints.clear();
+
+    const int originx = goalField.mGoalNode % MAP_DIMENSIONS - GoalFieldRadius;
+    const int originz = goalField.mGoalNode / MAP_DIMENSIONS - GoalFieldRadius;
+
+    int currx = startNode % MAP_DIMENSIONS;
+    int currz = startNode / MAP_DIMENSIONS;
+    if (currx < originx || currx >= originx + GoalFieldDimensions || currz < originz || currz >= originz + GoalFieldDimensions)
+        return false;
+
+    // each step leads to cell with lower cost so trace always ends at goal
+    for (;;)
+    {
+        const unsigned char nextDirection = goalField.mNextDirections[(currz - originz) * GoalFieldDimensions + (currx - originx)];
+        if (nextDirection == GoalFieldCell_Unreached)
+        {
+            outputWaypoints.clear();
+            return false;
+        }
+        outputWaypoints.emplace_back(currx, mNavNodes[GetNavNodeIndex(currx, currz)].mLayer, currz);
+        if (nextDirection == GoalFieldCell_Goal)
+            break;
+
+        currx += NavDirectionOffsets[nextDirection].x;
+        currz += NavDirectionOffsets[nextDirection].y;
+    }
+    return true;
+}
+
+void MapNavigation::UpdateNavNode(const GameMapManager& cityScape, int coordx, int coordz)
+{
+    NavNode& navNode = mNavNodes[GetNavNodeIndex(coordx, coordz)];
+    navNode = NavNode();
+
+    // surface is topmost non-air block of column
+    int surfaceLayer = cityScape.GetTopmostLayer(coordx, coordz);
+    if (surfaceLayer < 0)
+        return;
+
+    const MapBlockInfo* mapBlock = cityScape.GetBlockInfo(coordx, coordz, surfaceLayer);
+    if (mapBlock->mIsRailway)
+        return;
+
+    navNode.mLayer = (signed char) surfaceLayer;
+
+    if (mapBlock->mGroundType == eGroundType_Pawement || mapBlock->mGroundType == eGroundType_Field)
+    {
+        navNode.mFlags = NavNodeFlags_Walkable;
+    }
+    else if (mapBlock->mGroundType == eGroundType_Road)
+    {
+        navNode.mFlags = NavNodeFlags_Drivable | NavNodeFlags_Crossing;
+        if (mapBlock->mUpDirection) navNode.mRoadDirections |= NavDirection_N;
+        if (mapBlock->mRightDirection) navNode.mRoadDirections |= NavDirection_E;
+        if (mapBlock->mDownDirection) navNode.mRoadDirections |= NavDirection_S;
+        if (mapBlock->mLeftDirection) navNode.mRoadDirections |= NavDirection_W;
+
+        bool isJunction = (navNode.mRoadDirections & (navNode.mRoadDirections - 1)) > 0; // more than one bit
+        if (isJunction)
+        {
+            navNode.mFlags |= NavNodeFlags_Junction;
+        }
+        if (mapBlock->mTrafficHint == eTrafficHint_TrafficLights)
+        {
+            navNode.mFlags |= NavNodeFlags_TrafficLights;
+        }
+    }
+}
+
+void MapNavigation::UpdateNavNodeExits(int coordx, int coordz)
+{
+    NavNode& navNode = mNavNodes[GetNavNodeIndex(coordx, coordz)];
+    navNode.mCarExits = 0;
+    navNode.mWalkExits = 0;
+
+    if (navNode.mLayer < 0)
+        return;
+
+    const bool isWalkable = (navNode.mFlags & (NavNodeFlags_Walkable | NavNodeFlags_Crossing)) > 0;
+    const bool isDrivable = (navNode.mFlags & NavNodeFlags_Drivable) > 0;
+    // roads without direction bits are allowed to leave in any direction
+    const unsigned char roadDirections = navNode.mRoadDirections ? navNode.mRoadDirections :
+        (NavDirection_N | NavDirection_E | NavDirection_S | NavDirection_W);
+
+    for (int idirection = 0; idirection < NavDirectionsCount; ++idirection)
+    {
+        int neighbourx = coordx + NavDirectionOffsets[idirection].x;
+        int neighbourz = coordz + NavDirectionOffsets[idirection].y;
+        if (neighbourx < 0 || neighbourx >= MAP_DIMENSIONS || neighbourz < 0 || neighbourz >= MAP_DIMENSIONS)
+            continue;
+
+        const NavNode& neighbourNode = mNavNodes[GetNavNodeIndex(neighbourx, neighbourz)];
+        if (neighbourNode.mLayer < 0 || abs(neighbourNode.mLayer - navNode.mLayer) > 1) // too steep
+            continue;
+
+        const unsigned char directionBit = (unsigned char) BIT(idirection);
+        if (isWalkable && (neighbourNode.mFlags & (NavNodeFlags_Walkable | NavNodeFlags_Crossing)))
+        {
+            navNode.mWalkExits |= directionBit;
+        }
+        if (isDrivable && (roadDirections & directionBit) && (neighbourNode.mFlags & NavNodeFlags_Drivable))
+        {
+            navNode.mCarExits |= directionBit;
+        }
+    }
+}
+
+int MapNavigation::GetNodeCost(eNavAgent agent, const NavNode& navNode) const
+{
+    const int BaseCost = 10;
+    if (agent == eNavAgent_Car)
+    {
+        if (navNode.mFlags & NavNodeFlags_TrafficLights)
+            return BaseCost * 2;
+
+        if (navNode.mFlags & NavNodeFlags_Junction)
+            return BaseCost + BaseCost / 2;
+
+        return BaseCost;
+    }
+
+    // pedestrians prefer pavements but may cross roads
+    if (navNode.mFlags & NavNodeFlags_Crossing)
+        return BaseCost * 4;
+
+    return BaseCost;
+}
+
+bool MapNavigation::SearchPath(eNavAgent agent, int startNode, int goalNode, std::vector<glm::ivec3>& outputWaypoints) const
+{
+    // nodes state is stored per thread and reused between queries,
+    // visit stamp tells whether node was touched by current search
+    struct SearchNode
+    {
+        unsigned int mVisitStamp = 0;
+        int mCost = 0;
+        int mParent = -1;
+        bool mClosed = false;
+    };
+    struct OpenEntry
+    {
+        int mEstimatedCost;
+        int mNode;
+    };
+    struct SearchState
+    {
+        std::vector<SearchNode> mNodes;
+        std::vector<OpenEntry> mOpenList;
+        unsigned int mVisitStamp = 0;
+    };
+    static thread_local SearchState searchState;
+
+    if (searchState.mNodes.empty())
+    {
+        searchState.mNodes.resize(MAP_DIMENSIONS * MAP_DIMENSIONS);
+    }
+    if (++searchState.mVisitStamp == 0) // wrapped
+    {
+        for (SearchNode& currNode: searchState.mNodes)
+        {
+            currNode.mVisitStamp = 0;
+        }
+        searchState.mVisitStamp = 1;
+    }
+    const unsigned int visitStamp = searchState.mVisitStamp;
+
+    const int goalx = goalNode % MAP_DIMENSIONS;
+    const int goalz = goalNode / MAP_DIMENSIONS;
+    // manhattan distance multiplied by cheapest node cost keeps heuristic admissible
+    auto EstimateCost = [goalx, goalz](int nodeIndex)
+    {
+        return (abs(nodeIndex % MAP_DIMENSIONS - goalx) + abs(nodeIndex / MAP_DIMENSIONS - goalz)) * 10;
+    };
+    auto CompareEntries = [](const OpenEntry& lhs, const OpenEntry& rhs)
+    {
+        return lhs.mEstimatedCost > rhs.mEstimatedCost; // min heap
+    };
+
+    std::vector<OpenEntry>& openList = searchState.mOpenList;
+    openList.clear();
+
+    SearchNode& startSearchNode = searchState.mNodes[startNode];
+    startSearchNode.mVisitStamp = visitStamp;
+    startSearchNode.mCost = 0;
+    startSearchNode.mParent = -1;
+    startSearchNode.mClosed = false;
+    openList.push_back({EstimateCost(startNode), startNode});
+
+    int numExpandedNodes = 0;
+    bool pathFound = false;
+    while (!openList.empty())
+    {
+        std::pop_heap(openList.begin(), openList.end(), CompareEntries);
+        const int currNodeIndex = openList.back().mNode;
+        openList.pop_back();
+
+        SearchNode& currSearchNode = searchState.mNodes[currNodeIndex];
+        if (currSearchNode.mClosed) // stale entry
+            continue;
+
+        currSearchNode.mClosed = true;
+        if (currNodeIndex == goalNode)
+        {
+            pathFound = true;
+            break;
+        }
+
+        if (++numExpandedNodes > MaxSearchNodes)
+            break;
+
+        const NavNode& currNavNode = mNavNodes[currNodeIndex];
+        const unsigned char nodeExits = (agent == eNavAgent_Car) ? currNavNode.mCarExits : currNavNode.mWalkExits;
+        for (int idirection = 0; idirection < NavDirectionsCount; ++idirection)
+        {
+            if ((nodeExits & BIT(idirection)) == 0)
+                continue;
+
+            const int neighbourIndex = currNodeIndex + NavDirectionOffsets[idirection].y * MAP_DIMENSIONS + NavDirectionOffsets[idirection].x;
+            const int neighbourCost = currSearchNode.mCost + GetNodeCost(agent, mNavNodes[neighbourIndex]);
+
+            SearchNode& neighbourSearchNode = searchState.mNodes[neighbourIndex];
+            if (neighbourSearchNode.mVisitStamp == visitStamp)
+            {
+                if (neighbourSearchNode.mClosed || neighbourSearchNode.mCost <= neighbourCost)
+                    continue;
+            }
+            neighbourSearchNode.mVisitStamp = visitStamp;
+            neighbourSearchNode.mCost = neighbourCost;
+            neighbourSearchNode.mParent = currNodeIndex;
+            neighbourSearchNode.mClosed = false;
+
+            openList.push_back({neighbourCost + EstimateCost(neighbourIndex), neighbourIndex});
+            std::push_heap(openList.begin(), openList.end(), CompareEntries);
+        }
+    }
+
+    outputWaypoints.clear();
+    if (!pathFound)
+        return false;
+
+    for (int currNodeIndex = goalNode; currNodeIndex != -1; currNodeIndex = searchState.mNodes[currNodeIndex].mParent)
+    {
+        glm::ivec3 waypoint (currNodeIndex % MAP_DIMENSIONS, mNavNodes[currNodeIndex].mLayer, currNodeIndex / MAP_DIMENSIONS);
+        outputWaypoints.push_back(waypoint);
+    }
+    std::reverse(outputWaypoints.begin(), outputWaypoints.end());
+    return true;
+}
+
+void MapNavigation::DebugBenchmarkPathQueries(int numQueries)
+{
+    if (numQueries < 1)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Invalid benchmark arguments, expected number of queries");
+        return;
+    }
+
+    // map data is too large for stack
+    std::unique_ptr<GameMapManager> city = std::make_unique<GameMapManager>();
+    std::unique_ptr<MapNavigation> navigation = std::make_unique<MapNavigation>();
+
+    std::vector<glm::ivec3> navigableNodes;
+    std::vector<std::pair<glm::ivec3, glm::ivec3>> queries;
+    NavPath navPath;
+
+    for (const std::string& currMapname: gFiles.mGameMapsList)
+    {
+        if (!city->LoadFromFile(currMapname))
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Cannot load map '%s'", currMapname.c_str());
+            continue;
+        }
+
+        navigation->BuildNavGraph(*city);
+        gConsole.LogMessage(eLogMessage_Info, "Navigation graph '%s': %.1f us, walkable nodes %d, drivable nodes %d",
+            currMapname.c_str(),
+            navigation->mNavStats.mBuildTime,
+            navigation->mNavStats.mWalkableNodesCount,
+            navigation->mNavStats.mDrivableNodesCount);
+
+        for (eNavAgent currAgent: {eNavAgent_Pedestrian, eNavAgent_Car})
+        {
+            navigableNodes.clear();
+            for (int coordz = 0; coordz < MAP_DIMENSIONS; ++coordz)
+            for (int coordx = 0; coordx < MAP_DIMENSIONS; ++coordx)
+            {
+                if (navigation->IsNavigable(currAgent, coordx, coordz))
+                {
+                    navigableNodes.emplace_back(coordx, 0, coordz);
+                }
+            }
+            if (navigableNodes.empty())
+                continue;
+
+            // short trips to region goals around single spot, similar to what ai near player requests
+            const int MaxTripDistance = 16;
+            const int FocusAreaSize = 48;
+
+            cxx::randomizer queriesRand;
+            const glm::ivec3& focusPoint = navigableNodes[queriesRand.generate_int(0, (int) navigableNodes.size() - 1)];
+            queries.clear();
+            for (int iattempt = 0; iattempt < numQueries * 16 && (int) queries.size() < numQueries; ++iattempt)
+            {
+                glm::ivec3 start = focusPoint + glm::ivec3(
+                    queriesRand.generate_int(-FocusAreaSize / 2, FocusAreaSize / 2), 0,
+                    queriesRand.generate_int(-FocusAreaSize / 2, FocusAreaSize / 2));
+                if (!navigation->IsNavigable(currAgent, start.x, start.z))
+                    continue;
+
+                glm::ivec3 goal;
+                if (!navigation->GetRegionGoal(currAgent,
+                    start.x + queriesRand.generate_int(-MaxTripDistance, MaxTripDistance),
+                    start.z + queriesRand.generate_int(-MaxTripDistance, MaxTripDistance), goal))
+                {
+                    continue;
+                }
+                queries.emplace_back(start, goal);
+            }
+            if (queries.empty())
+                continue;
+
+            // first pass builds goal fields, second pass reuses them
+            navigation->ClearGoalFields();
+            for (const char* currPassName: {"cold", "cached"})
+            {
+                navigation->mCacheHitsCount = 0;
+
+                int pathsFound = 0;
+                long long waypointsCount = 0;
+                std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+                for (const auto& currQuery: queries)
+                {
+                    if (navigation->FindPath(currAgent, currQuery.first, currQuery.second, navPath))
+                    {
+                        ++pathsFound;
+                        waypointsCount += (long long) navPath.mWaypoints.size();
+                    }
+                }
+                std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
+                long long elapsedMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(timeEnd - timeStart).count();
+                gConsole.LogMessage(eLogMessage_Info, " - %s paths %s: %d queries %lld us, %.0f queries per second, cache hits %d, found %d, average length %.1f",
+                    (currAgent == eNavAgent_Car) ? "car" : "pedestrian",
+                    currPassName,
+                    (int) queries.size(),
+                    elapsedMicroseconds,
+                    queries.size() * 1000000.0 / std::max(elapsedMicroseconds, 1LL),
+                    navigation->mCacheHitsCount.load(),
+                    pathsFound,
+                    pathsFound ? (double) waypointsCount / pathsFound : 0.0);
+            }
+        }
+        city->Cleanup();
+    }
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include "GameDefs.h"
+
+class GameMapManager;
+
+// Navigation agent kinds, each one has its own set of graph edges
+enum eNavAgent
+{
+    eNavAgent_Pedestrian,
+    eNavAgent_Car,
+    eNavAgent_COUNT
+};
+
+// Path query result, waypoints are centers of map blocks
+struct NavPath
+{
+public:
+    inline void Clear()
+    {
+        mWaypoints.clear();
+    }
+public:
+    std::vector<glm::ivec3> mWaypoints; // x, layer, z in map units, including start and goal blocks
+};
+
+// Navigation queries statistics
+struct NavStats
+{
+public:
+    int mWalkableNodesCount = 0;
+    int mDrivableNodesCount = 0;
+    float mBuildTime = 0.0f; // microseconds
+};
+
+// Compact navigation graph built from map blocks data, there is single node per map column on its surface layer,
+// pedestrians walk on pavements and fields and may cross roads, cars follow road direction bits;
+// paths to region goals are taken from shared per goal cache, path queries are thread safe
+class MapNavigation final: public cxx::noncopyable
+{
+public:
+    // readonly
+    NavStats mNavStats;
+
+    // queries counters
+    std::atomic<int> mQueriesCount;
+    std::atomic<int> mCacheHitsCount;
+
+public:
+    MapNavigation();
+
+    // Build navigation graph for whole map
+    // @param cityScape: Source map data
+    void BuildNavGraph(const GameMapManager& cityScape);
+    void Cleanup();
+
+    // Refresh graph nodes of modified map columns, must be called serially
+    void UpdateFrame();
+
+    // Find shortest path between map blocks, when goal is region goal the path is traced through cached
+    // costs field of that goal which is shared by all queries, otherwise plain search is performed
+    // @param agent: Navigation agent kind
+    // @param start, goal: Map blocks, layer component is ignored
+    // @param outputPath: Waypoints from start to goal
+    // @returns false if there is no path or path is too long
+    bool FindPath(eNavAgent agent, const glm::ivec3& start, const glm::ivec3& goal, NavPath& outputPath);
+
+    // Get goal block of map region containing column, agents heading to same region share it along with cached paths
+    // @param coordx, coordz: Column location
+    // @param outputGoal: Navigable block nearest to region center
+    // @returns false if region has no navigable blocks
+    bool GetRegionGoal(eNavAgent agent, int coordx, int coordz, glm::ivec3& outputGoal) const;
+
+    // Drop all cached goal fields
+    void ClearGoalFields();
+
+    // Test whether map column is accessible for navigation agent
+    // @param coordx, coordz: Column location
+    bool IsNavigable(eNavAgent agent, int coordx, int coordz) const;
+
+    // Move agent that wanders without target to neighbour column, current direction is preferred,
+    // pedestrians avoid road crossings when possible
+    // @param block: Current map block, gets replaced with next block
+    // @param direction: Current direction index n, e, s, w, gets replaced with direction of last step
+    // @returns false if there are no exits from current column
+    bool StepWander(eNavAgent agent, glm::ivec3& block, int& direction, cxx::randomizer& random) const;
+
+    // Debug: build graph and run random path queries for all maps, print timings to console
+    // @param numQueries: Number of random queries per agent kind
+    static void DebugBenchmarkPathQueries(int numQueries);
+
+private:
+    enum NavNodeFlags: unsigned char
+    {
+        NavNodeFlags_None = 0,
+        NavNodeFlags_Walkable = BIT(0),
+        NavNodeFlags_Drivable = BIT(1),
+        NavNodeFlags_Junction = BIT(2), // road with multiple directions
+        NavNodeFlags_TrafficLights = BIT(3),
+        NavNodeFlags_Crossing = BIT(4), // pedestrians may walk but should avoid
+    };
+
+    // direction bits
+    enum
+    {
+        NavDirection_N = BIT(0),
+        NavDirection_E = BIT(1),
+        NavDirection_S = BIT(2),
+        NavDirection_W = BIT(3),
+    };
+
+    struct NavNode
+    {
+        signed char mLayer = -1; // surface layer or -1
+        unsigned char mFlags = NavNodeFlags_None;
+        unsigned char mRoadDirections = 0; // direction bits of road block
+        unsigned char mCarExits = 0; // directions car may leave node
+        unsigned char mWalkExits = 0; // directions pedestrian may leave node
+    };
+
+    // Directions towards goal for every column around it, built by reverse search from goal
+    struct GoalField
+    {
+        eNavAgent mAgent = eNavAgent_Pedestrian;
+        int mGoalNode = -1;
+        std::vector<unsigned char> mNextDirections; // per window cell
+    };
+
+    struct GoalFieldSlot
+    {
+        std::shared_ptr<const GoalField> mGoalField;
+        unsigned int mLastUse = 0;
+    };
+
+    static const int MaxSearchNodes = 16384; // search gives up after expanding that many nodes
+    static const int NavRegionSize = 8; // map columns
+    static const int GoalFieldRadius = 32; // map columns around goal covered by field
+    static const int GoalFieldDimensions = GoalFieldRadius * 2 + 1;
+    static const int GoalFieldsCacheSize = 64;
+
+    void UpdateNavNode(const GameMapManager& cityScape, int coordx, int coordz);
+    void UpdateNavNodeExits(int coordx, int coordz);
+    int GetNodeCost(eNavAgent agent, const NavNode& navNode) const;
+
+    bool SearchPath(eNavAgent agent, int startNode, int goalNode, std::vector<glm::ivec3>& outputWaypoints) const;
+
+    std::shared_ptr<const GoalField> GetGoalField(eNavAgent agent, int goalNode, bool& isCached);
+    std::shared_ptr<const GoalField> BuildGoalField(eNavAgent agent, int goalNode) const;
+    bool TraceGoalField(const GoalField& goalField, int startNode, std::vector<glm::ivec3>& outputWaypoints) const;
+
+private:
+    NavNode mNavNodes[MAP_DIMENSIONS * MAP_DIMENSIONS]; // y, x
+
+    // cached goal fields, least recently used one gets replaced
+    GoalFieldSlot mGoalFields[GoalFieldsCacheSize];
+    unsigned int mGoalFieldsUseCounter = 0;
+    std::mutex mGoalFieldsMutex;
+};
+
+extern MapNavigation gMapNavigation;
@@ -11,6 +11,8 @@
 #include "Pedestrian.h"
 #include "Vehicle.h"
 #include "TrafficManager.h"
+#include "JobsManager.h"
+#include "cvars.h"
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -62,12 +64,17 @@ void MapRenderer::Deinit()
         gGraphicsDevice.DestroyBuffer(mCityMeshBufferI);
         mCityMeshBufferI = nullptr;
     }
+    mChunkMeshData.Clear();
+    mChunkMeshData.mBlocksVertices.shrink_to_fit();
+    mChunkMeshData.mBlocksIndices.shrink_to_fit();
 }
 
 void MapRenderer::RenderFrameBegin()
 {
     mRenderStats.FrameBegin();
 
+    UpdateMapMesh();
+
     // pre draw game objects
     for (GameObject* gameObject: gGameObjectsManager.mAllObjects)
     {
@@ -107,7 +114,7 @@ void MapRenderer::RenderFrame(GameCamera* renderview)
         DrawCityMesh(renderview);
     }
 
-    mSpriteBatch.BeginBatch(SpriteBatch::DepthAxis_Y, eSpritesSortMode_HeightAndDrawOrder);
+    mSpriteBatch.BeginBatch(SpriteBatch::DepthAxis_Y, eSpritesSortMode_HeightAndDrawOrder, true);
 
     // collect and render game objects sprites
     for (GameObject* gameObject: gGameObjectsManager.mAllObjects)
@@ -119,8 +126,12 @@ void MapRenderer::RenderFrame(GameCamera* renderview)
         DrawGameObject(renderview, gameObject);
     }
 
-    gRenderManager.mSpritesProgram.Activate();
-    gRenderManager.mSpritesProgram.UploadCameraTransformMatrices(*renderview);
+    RenderProgram& spritesProgram = mSpriteBatch.IsInstancingEnabled() ? 
+        gRenderManager.mSpritesInstancedProgram : 
+        gRenderManager.mSpritesProgram;
+
+    spritesProgram.Activate();
+    spritesProgram.UploadCameraTransformMatrices(*renderview);
 
     RenderStates renderStates = RenderStates()
         .Disable(RenderStateFlags_FaceCulling)
@@ -129,7 +140,7 @@ void MapRenderer::RenderFrame(GameCamera* renderview)
 
     mSpriteBatch.Flush();
 
-    gRenderManager.mSpritesProgram.Deactivate();
+    spritesProgram.Deactivate();
 }
 
 void MapRenderer::DrawGameObject(GameCamera* renderview, GameObject* gameObject)
@@ -203,35 +214,22 @@ void MapRenderer::DrawCityMesh(GameCamera* renderview)
 
 void MapRenderer::BuildMapMesh()
 {
+    std::vector<CityMeshData> chunksMeshData;
+    BuildMapChunksMeshes(gGameMap, chunksMeshData);
+
     CityMeshData blocksMesh;
-    for (int batchy = 0; batchy < BlocksBatchesPerSide; ++batchy)
+    SpliceMapChunksMeshes(chunksMeshData, mMapBlocksChunks, blocksMesh);
+
+    for (int ichunk = 0; ichunk < BlocksBatchCount; ++ichunk)
     {
-        for (int batchx = 0; batchx < BlocksBatchesPerSide; ++batchx)
-        {
-            Rect mapArea { 
-                batchx * BlocksBatchDims - ExtraBlocksPerSide, 
-                batchy * BlocksBatchDims - ExtraBlocksPerSide,
-                BlocksBatchDims,
-                BlocksBatchDims };
-
-            unsigned int prevVerticesCount = blocksMesh.mBlocksVertices.size();
-            unsigned int prevIndicesCount = blocksMesh.mBlocksIndices.size();
-
-            MapBlocksChunk& currChunk = mMapBlocksChunks[batchy * BlocksBatchesPerSide + batchx];
-            currChunk.mBounds.mMin = glm::vec3 { mapArea.x * METERS_PER_MAP_UNIT, 0.0f, mapArea.y * METERS_PER_MAP_UNIT };
-            currChunk.mBounds.mMax = glm::vec3 { 
-                (mapArea.x + mapArea.w) * METERS_PER_MAP_UNIT, MAP_LAYERS_COUNT * METERS_PER_MAP_UNIT, 
-                (mapArea.y + mapArea.h) * METERS_PER_MAP_UNIT};
-
-            currChunk.mVerticesStart = prevVerticesCount;
-            currChunk.mIndicesStart = prevIndicesCount;
-            
-            // append new geometry
-            GameMapHelpers::BuildMapMesh(gGameMap, mapArea, blocksMesh);
-            
-            currChunk.mVerticesCount = blocksMesh.mBlocksVertices.size() - prevVerticesCount;
-            currChunk.mIndicesCount = blocksMesh.mBlocksIndices.size() - prevIndicesCount;
-        }
+        Rect mapArea = GetMapChunkArea(ichunk);
+
+        MapBlocksChunk& currChunk = mMapBlocksChunks[ichunk];
+        currChunk.mGeometryDirty = false;
+        currChunk.mBounds.mMin = glm::vec3 { mapArea.x * METERS_PER_MAP_UNIT, 0.0f, mapArea.y * METERS_PER_MAP_UNIT };
+        currChunk.mBounds.mMax = glm::vec3 { 
+            (mapArea.x + mapArea.w) * METERS_PER_MAP_UNIT, MAP_LAYERS_COUNT * METERS_PER_MAP_UNIT, 
+            (mapArea.y + mapArea.h) * METERS_PER_MAP_UNIT};
     }
 
     // upload map geometry to video memory
@@ -253,4 +251,242 @@ void MapRenderer::BuildMapMesh()
         memcpy(pdata, blocksMesh.mBlocksIndices.data(), totalIndexDataBytes);
         mCityMeshBufferI->Unlock();
     }
-}
\ No newline at end of file
+
+    gCvarGraphicsMergeCityMeshFaces.ClearModified();
+
+    UpdateCityMeshStats();
+}
+
+void MapRenderer::UpdateMapMesh()
+{
+    if (gCvarGraphicsMergeCityMeshFaces.IsModified() && gGameMap.IsLoaded())
+    {
+        BuildMapMesh();
+        return;
+    }
+
+    const std::vector<Point>& changedColumns = gGameMap.GetChangedColumns();
+    if (changedColumns.empty())
+        return;
+
+    for (const Point& currColumn: changedColumns)
+    {
+        InvalidateMapChunks(currColumn);
+    }
+
+    for (int ichunk = 0; ichunk < BlocksBatchCount; ++ichunk)
+    {
+        MapBlocksChunk& currChunk = mMapBlocksChunks[ichunk];
+        if (!currChunk.mGeometryDirty)
+            continue;
+
+        BuildMapChunkMesh(gGameMap, ichunk, mChunkMeshData);
+        if (!UploadMapChunkMesh(ichunk, mChunkMeshData))
+        {
+            // chunk geometry grown too much, have to rebuild everything
+            BuildMapMesh();
+            return;
+        }
+        currChunk.mGeometryDirty = false;
+    }
+
+    UpdateCityMeshStats();
+}
+
+void MapRenderer::UpdateCityMeshStats()
+{
+    mRenderStats.mCityMeshTrianglesCount = 0;
+    mRenderStats.mCityMeshCulledTrianglesCount = 0;
+    mRenderStats.mCityMeshMergedTrianglesCount = 0;
+
+    for (const MapBlocksChunk& currChunk: mMapBlocksChunks)
+    {
+        mRenderStats.mCityMeshTrianglesCount += currChunk.mIndicesCount / 3;
+        // two triangles per face
+        mRenderStats.mCityMeshCulledTrianglesCount += currChunk.mCulledFacesCount * 2;
+        mRenderStats.mCityMeshMergedTrianglesCount += currChunk.mMergedFacesCount * 2;
+    }
+}
+
+void MapRenderer::InvalidateMapChunks(const Point& mapColumn)
+{
+    // neighbour blocks are also affected, note that chunks on map edges also contain clamped blocks beyond map bounds
+    int minx = (mapColumn.x > 0) ? (mapColumn.x - 1) : -ExtraBlocksPerSide;
+    int miny = (mapColumn.y > 0) ? (mapColumn.y - 1) : -ExtraBlocksPerSide;
+    int maxx = (mapColumn.x < MAP_DIMENSIONS - 1) ? (mapColumn.x + 1) : (MAP_DIMENSIONS - 1 + ExtraBlocksPerSide);
+    int maxy = (mapColumn.y < MAP_DIMENSIONS - 1) ? (mapColumn.y + 1) : (MAP_DIMENSIONS - 1 + ExtraBlocksPerSide);
+
+    auto ToChunkCoord = [](int blockCoord)
+    {
+        return glm::clamp((blockCoord + ExtraBlocksPerSide) / BlocksBatchDims, 0, BlocksBatchesPerSide - 1);
+    };
+
+    for (int batchy = ToChunkCoord(miny), batchMaxy = ToChunkCoord(maxy); batchy <= batchMaxy; ++batchy)
+    {
+        for (int batchx = ToChunkCoord(minx), batchMaxx = ToChunkCoord(maxx); batchx <= batchMaxx; ++batchx)
+        {
+            mMapBlocksChunks[batchy * BlocksBatchesPerSide + batchx].mGeometryDirty = true;
+        }
+    }
+}
+
+void MapRenderer::BuildMapChunksMeshes(GameMapManager& city, std::vector<CityMeshData>& chunksMeshData)
+{
+    // chunks are independent from each other and map data is not modified, so they can be generated simultaneously
+    chunksMeshData.resize(BlocksBatchCount);
+    gJobsManager.ParallelFor(BlocksBatchCount, [&city, &chunksMeshData](int chunkIndex)
+        {
+            BuildMapChunkMesh(city, chunkIndex, chunksMeshData[chunkIndex]);
+        });
+}
+
+void MapRenderer::BuildMapChunkMesh(GameMapManager& city, int chunkIndex, CityMeshData& meshData)
+{
+    debug_assert(chunkIndex > -1 && chunkIndex < BlocksBatchCount);
+
+    // chunk geometry indices are starting from zero
+    meshData.Clear();
+    GameMapHelpers::BuildMapMesh(city, GetMapChunkArea(chunkIndex), meshData);
+}
+
+void MapRenderer::SpliceMapChunksMeshes(const std::vector<CityMeshData>& chunksMeshData, MapBlocksChunk* chunks, CityMeshData& outputMesh)
+{
+    debug_assert(chunksMeshData.size() == BlocksBatchCount);
+
+    // compute chunks locations
+    unsigned int totalVerticesCount = 0;
+    unsigned int totalIndicesCount = 0;
+    for (int ichunk = 0; ichunk < BlocksBatchCount; ++ichunk)
+    {
+        const CityMeshData& chunkMeshData = chunksMeshData[ichunk];
+
+        MapBlocksChunk& currChunk = chunks[ichunk];
+        currChunk.mVerticesStart = totalVerticesCount;
+        currChunk.mIndicesStart = totalIndicesCount;
+        currChunk.mVerticesCount = chunkMeshData.mBlocksVertices.size();
+        currChunk.mIndicesCount = chunkMeshData.mBlocksIndices.size();
+        currChunk.mCulledFacesCount = chunkMeshData.mCulledFacesCount;
+        currChunk.mMergedFacesCount = chunkMeshData.mMergedFacesCount;
+        // leave some free space after chunk geometry so it can be updated in place
+        currChunk.mVerticesCapacity = currChunk.mVerticesCount + ChunkExtraVertices;
+        currChunk.mIndicesCapacity = currChunk.mIndicesCount + (ChunkExtraVertices / 4) * 6;
+
+        totalVerticesCount += currChunk.mVerticesCapacity;
+        totalIndicesCount += currChunk.mIndicesCapacity;
+    }
+
+    outputMesh.Clear();
+    outputMesh.mBlocksVertices.resize(totalVerticesCount);
+    outputMesh.mBlocksIndices.resize(totalIndicesCount);
+
+    // copy geometry
+    for (int ichunk = 0; ichunk < BlocksBatchCount; ++ichunk)
+    {
+        const CityMeshData& chunkMeshData = chunksMeshData[ichunk];
+        const MapBlocksChunk& currChunk = chunks[ichunk];
+
+        std::copy(chunkMeshData.mBlocksVertices.begin(), chunkMeshData.mBlocksVertices.end(), 
+            outputMesh.mBlocksVertices.begin() + currChunk.mVerticesStart);
+
+        // rebase indices to chunk location within vertex buffer
+        DrawIndex* outputIndices = outputMesh.mBlocksIndices.data() + currChunk.mIndicesStart;
+        for (DrawIndex currIndex: chunkMeshData.mBlocksIndices)
+        {
+            *outputIndices++ = currIndex + currChunk.mVerticesStart;
+        }
+    }
+}
+
+Rect MapRenderer::GetMapChunkArea(int chunkIndex)
+{
+    int batchx = chunkIndex % BlocksBatchesPerSide;
+    int batchy = chunkIndex / BlocksBatchesPerSide;
+
+    Rect mapArea { 
+        batchx * BlocksBatchDims - ExtraBlocksPerSide, 
+        batchy * BlocksBatchDims - ExtraBlocksPerSide,
+        BlocksBatchDims,
+        BlocksBatchDims };
+
+    return mapArea;
+}
+
+bool MapRenderer::UploadMapChunkMesh(int chunkIndex, const CityMeshData& meshData)
+{
+    debug_assert(chunkIndex > -1 && chunkIndex < BlocksBatchCount);
+
+    MapBlocksChunk& currChunk = mMapBlocksChunks[chunkIndex];
+    if (meshData.mBlocksVertices.size() > currChunk.mVerticesCapacity || 
+        meshData.mBlocksIndices.size() > currChunk.mIndicesCapacity)
+    {
+        return false;
+    }
+
+    currChunk.mVerticesCount = meshData.mBlocksVertices.size();
+    currChunk.mIndicesCount = meshData.mBlocksIndices.size();
+    currChunk.mCulledFacesCount = meshData.mCulledFacesCount;
+    currChunk.mMergedFacesCount = meshData.mMergedFacesCount;
+
+    if (currChunk.mVerticesCount > 0)
+    {
+        mCityMeshBufferV->SubData(currChunk.mVerticesStart * Sizeof_CityVertex3D, 
+            currChunk.mVerticesCount * Sizeof_CityVertex3D, meshData.mBlocksVertices.data());
+    }
+
+    if (currChunk.mIndicesCount > 0)
+    {
+        // rebase indices to chunk location within vertex buffer
+        std::vector<DrawIndex> chunkIndices (meshData.mBlocksIndices);
+        for (DrawIndex& currIndex: chunkIndices)
+        {
+            currIndex += currChunk.mVerticesStart;
+        }
+        mCityMeshBufferI->SubData(currChunk.mIndicesStart * Sizeof_DrawIndex, 
+            currChunk.mIndicesCount * Sizeof_DrawIndex, chunkIndices.data());
+    }
+    return true;
+}
+
+void MapRenderer::DebugBenchmarkMapMesh(int maxThreads)
+{
+    const int currentThreadsCount = gJobsManager.GetWorkerThreadsCount();
+    if (maxThreads < 1)
+    {
+        maxThreads = currentThreadsCount + 1; // include calling thread
+    }
+
+    // map data is too large for stack
+    std::unique_ptr<GameMapManager> city = std::make_unique<GameMapManager>();
+
+    std::vector<CityMeshData> chunksMeshData;
+    std::vector<MapBlocksChunk> chunks (BlocksBatchCount);
+    CityMeshData blocksMesh;
+
+    for (const std::string& currMapname: gFiles.mGameMapsList)
+    {
+        if (!city->LoadFromFile(currMapname))
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Cannot load map '%s'", currMapname.c_str());
+            continue;
+        }
+
+        for (int numThreads = 1; numThreads <= maxThreads; ++numThreads)
+        {
+            gJobsManager.SetWorkerThreadsCount(numThreads - 1);
+
+            std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+            BuildMapChunksMeshes(*city, chunksMeshData);
+            SpliceMapChunksMeshes(chunksMeshData, chunks.data(), blocksMesh);
+            std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
+
+            long long elapsedMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(timeEnd - timeStart).count();
+            gConsole.LogMessage(eLogMessage_Info, "Map mesh '%s' (%d threads): %lld us, vertices %d, indices %d", 
+                currMapname.c_str(), numThreads, elapsedMicroseconds, 
+                (int) blocksMesh.mBlocksVertices.size(), 
+                (int) blocksMesh.mBlocksIndices.size());
+        }
+        city->Cleanup();
+    }
+
+    gJobsManager.SetWorkerThreadsCount(currentThreadsCount);
+}
@@ -17,6 +17,11 @@ public:
     int mBlockChunksDrawnCount = 0;  // per frame
     int mSpritesDrawnCount = 0; // per frame
 
+    // city mesh geometry, updated on rebuild
+    int mCityMeshTrianglesCount = 0;
+    int mCityMeshCulledTrianglesCount = 0; // hidden faces
+    int mCityMeshMergedTrianglesCount = 0; // merged lids
+
     unsigned int mRenderFramesCounter = 0; // gets incremented on every frame
 };
 
@@ -33,18 +38,23 @@ public:
     void RenderFrame(GameCamera* renderview);
     void DebugDraw(DebugRenderer& debugRender);
     void RenderFrameEnd();
+
+    // Build whole city mesh and upload it to video memory
     void BuildMapMesh();
 
-private:
-    void DrawCityMesh(GameCamera* renderview);
-    void DrawGameObject(GameCamera* renderview, GameObject* gameObject);
-    void PreDrawGameObject(GameObject* gameObject);
+    // Rebuild only chunks affected by map blocks modifications and update them in video memory
+    void UpdateMapMesh();
+
+    // Debug: build city mesh for each available map using different number of threads and print elapsed time to console
+    // @param maxThreads: Max number of threads to test
+    void DebugBenchmarkMapMesh(int maxThreads);
 
 private:
     enum
     {
         BlocksBatchDims = 22, // 22 x 22 x 6 blocks per batch
         ExtraBlocksPerSide = 4,
+        ChunkExtraVertices = 4 * 64, // reserve space for additional faces per chunk
         BlocksBatchesPerSide = ((MAP_DIMENSIONS + (ExtraBlocksPerSide * 2)) + BlocksBatchDims - 1) / BlocksBatchDims,
         BlocksBatchCount = BlocksBatchesPerSide * BlocksBatchesPerSide,
     };
@@ -52,13 +62,34 @@ private:
     {
         cxx::aabbox_t mBounds; // for culling
         // index/vertex data offset in vbo
-        unsigned int mIndicesStart = 0, mIndicesCount = 0;
-        unsigned int mVerticesStart = 0, mVerticesCount = 0;
+        unsigned int mIndicesStart = 0, mIndicesCount = 0, mIndicesCapacity = 0;
+        unsigned int mVerticesStart = 0, mVerticesCount = 0, mVerticesCapacity = 0;
+        int mCulledFacesCount = 0, mMergedFacesCount = 0;
+        bool mGeometryDirty = false; // chunk needs rebuild
     };
+
+    // Generate geometry for all map chunks, uses worker threads
+    static void BuildMapChunksMeshes(GameMapManager& city, std::vector<CityMeshData>& chunksMeshData);
+    static void BuildMapChunkMesh(GameMapManager& city, int chunkIndex, CityMeshData& meshData);
+
+    // Combine chunks geometry into single mesh, leaving some free space after each chunk
+    static void SpliceMapChunksMeshes(const std::vector<CityMeshData>& chunksMeshData, MapBlocksChunk* chunks, CityMeshData& outputMesh);
+    static Rect GetMapChunkArea(int chunkIndex);
+
+    bool UploadMapChunkMesh(int chunkIndex, const CityMeshData& meshData);
+    void InvalidateMapChunks(const Point& mapColumn);
+    void UpdateCityMeshStats();
+    void DrawCityMesh(GameCamera* renderview);
+    void DrawGameObject(GameCamera* renderview, GameObject* gameObject);
+    void PreDrawGameObject(GameObject* gameObject);
+
+private:
     MapBlocksChunk mMapBlocksChunks[BlocksBatchCount];
 
     GpuBuffer* mCityMeshBufferV;
     GpuBuffer* mCityMeshBufferI;
 
+    CityMeshData mChunkMeshData; // scratch buffer for incremental updates
+
     SpriteBatch mSpriteBatch;
 };
\ No newline at end of file
@@ -156,6 +156,8 @@ inline GLenum GetAttributeDataTypeGL(eVertexAttributeFormat attributeFormat)
         case eVertexAttributeFormat_1US:
         case eVertexAttributeFormat_2US:
         case eVertexAttributeFormat_4US: return GL_UNSIGNED_SHORT;
+
+        case eVertexAttributeFormat_4H: return GL_HALF_FLOAT;
         default: break;
     }
     debug_assert(false);
@@ -439,6 +439,9 @@ void Pedestrian::LeaveCar()
 
 bool Pedestrian::ReceiveDamage(const DamageInfo& damageInfo)
 {
+    // resting pedestrian may be knocked down
+    mPhysicsBody->SetAwake(true);
+
     PedestrianStateEvent evData { ePedestrianStateEvent_ReceiveDamage };
     evData.mDamageInfo = damageInfo;
     return mStatesManager.ProcessEvent(evData);
@@ -220,6 +220,7 @@ void PhysicsBody::SetTransform(const glm::vec3& position)
 
     b2Vec2 b2position { position.x, position.z };
     mBox2Body->SetTransform(b2position, mBox2Body->GetAngle());
+    mBox2Body->SetAwake(true); // teleported body must update its height and contacts
 }
 
 void PhysicsBody::SetTransform(const glm::vec3& position, cxx::angle_t rotationAngle)
@@ -228,11 +229,13 @@ void PhysicsBody::SetTransform(const glm::vec3& position, cxx::angle_t rotationA
 
     b2Vec2 b2position { position.x, position.z };
     mBox2Body->SetTransform(b2position, rotationAngle.to_radians());
+    mBox2Body->SetAwake(true); // teleported body must update its height and contacts
 }
 
 void PhysicsBody::SetOrientation(cxx::angle_t rotationAngle)
 {
     mBox2Body->SetTransform(mBox2Body->GetPosition(), rotationAngle.to_radians());
+    mBox2Body->SetAwake(true);
 }
 
 cxx::angle_t PhysicsBody::GetOrientation() const
@@ -245,6 +248,7 @@ void PhysicsBody::SetSignVector(const glm::vec2& signDirection)
 {
     float rotationAngleRadians = ::atan2f(signDirection.y, signDirection.x);
     mBox2Body->SetTransform(mBox2Body->GetPosition(), rotationAngleRadians);
+    mBox2Body->SetAwake(true);
 }
 
 void PhysicsBody::AddForce(const glm::vec2& force)
@@ -13,6 +13,9 @@
 #include "Collision.h"
 #include "GameObjectHelpers.h"
 #include "AudioManager.h"
+#include "FrameProfiler.h"
+#include "JobsManager.h"
+#include "GameObjectsManager.h"
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -27,10 +30,7 @@ union b2FixtureData_map
     {
     }
 
-    struct
-    {
-        unsigned char mX, mZ;
-    };
+    unsigned int mAreaIndex; // index in map collision areas table
 
     void* mAsPointer;
 };
@@ -75,6 +75,7 @@ void PhysicsManager::ClearWorld()
         mBox2World->DestroyBody(mBox2MapBody);
         mBox2MapBody = nullptr;
     }
+    mMapCollisionAreas.clear();
     SafeDelete(mBox2World);
 }
 
@@ -93,9 +94,13 @@ void PhysicsManager::UpdateFrame()
 
 void PhysicsManager::ProcessSimulationStep()
 {
+    PROFILER_SCOPE("PhysicsSimulationStep");
+
     const int velocityIterations = 6;
     const int positionIterations = 4;
 
+    std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+
     // fixed update
     for (size_t i = 0, NumElements = mBodiesList.size(); i < NumElements; ++i)
     {
@@ -107,37 +112,89 @@ void PhysicsManager::ProcessSimulationStep()
         }
     }
 
-    // drop old contacts before new simulation frame
-    for (PhysicsBody* currObjectBody: mBodiesList)
+    // drop old contacts before new simulation frame, sleeping bodies keep theirs until
+    // they are woken up or contact ends, objects contacts are refreshed in PreSolve
+    ParallelForBodies((int) mBodiesList.size(), [this](int bodyIndex)
+        {
+            PhysicsBody* currObjectBody = mBodiesList[bodyIndex];
+            if (currObjectBody->IsAwake() || currObjectBody->CheckFlags(PhysicsBodyFlags_Disabled))
+            {
+                GameObject* currGameObject = currObjectBody->mGameObject;
+                currGameObject->ClearContacts();
+            }
+        });
+
     {
-        GameObject* currGameObject = currObjectBody->mGameObject;
-        currObjectBody->SetAwake(true); // force contacting bodies awaken
-        currGameObject->ClearContacts();
+        PROFILER_SCOPE("Box2D");
+        mBox2World->Step(mSimulationStepTime, velocityIterations, positionIterations);
     }
 
-    mBox2World->Step(mSimulationStepTime, velocityIterations, positionIterations);
+    // process y position, fall events are queued and dispatched serially in bodies order,
+    // so results doesn't depend on number of worker threads
+    const int numStepBodies = (int) mBodiesList.size();
+    mBodiesFallEvents.resize(numStepBodies);
+    ParallelForBodies(numStepBodies, [this](int bodyIndex)
+        {
+            mBodiesFallEvents[bodyIndex] = eFallEvent_None;
 
-    // process y position
-    for (PhysicsBody* currObjectBody: mBodiesList)
-    {
-        GameObject* currGameObject = currObjectBody->mGameObject;
-        if (currGameObject->IsAttachedToObject() || currObjectBody->CheckFlags(PhysicsBodyFlags_Disabled))
-            continue;
+            PhysicsBody* currObjectBody = mBodiesList[bodyIndex];
+            GameObject* currGameObject = currObjectBody->mGameObject;
+            if (currGameObject->IsAttachedToObject() || currObjectBody->CheckFlags(PhysicsBodyFlags_Disabled))
+                return;
 
-        UpdateHeightPosition(currObjectBody);
+            // resting body stays at same height
+            if (!currObjectBody->IsAwake() && !currObjectBody->mFalling)
+                return;
+
+            mBodiesFallEvents[bodyIndex] = UpdateHeightPosition(currObjectBody);
+        });
+
+    // event handlers may create new bodies, they are appended to list so indices remain valid
+    for (int ibody = 0; ibody < numStepBodies; ++ibody)
+    {
+        if (mBodiesFallEvents[ibody] != eFallEvent_None)
+        {
+            DispatchFallEvent(mBodiesList[ibody], mBodiesFallEvents[ibody]);
+        }
     }
 
     DispatchCollisionEvents();
 
-    // sync transform
-    for (PhysicsBody* currObjectBody: mBodiesList)
+    // sync transform, roots are fetched simultaneously while spatial index and attached objects are updated serially
+    const int numSyncBodies = (int) mBodiesList.size();
+    mBodiesTransformChanged.resize(numSyncBodies);
+    ParallelForBodies(numSyncBodies, [this](int bodyIndex)
+        {
+            GameObject* currGameObject = mBodiesList[bodyIndex]->mGameObject;
+            mBodiesTransformChanged[bodyIndex] = !currGameObject->IsAttachedToObject() && currGameObject->FetchPhysicsTransform();
+        });
+
+    mPhysicsStats.mAwakeBodiesCount = 0;
+    mPhysicsStats.mSleepingBodiesCount = 0;
+
+    for (int ibody = 0; ibody < numSyncBodies; ++ibody)
     {
-        GameObject* currGameObject = currObjectBody->mGameObject;
-        if (!currGameObject->IsAttachedToObject())
+        PhysicsBody* currObjectBody = mBodiesList[ibody];
+        if (mBodiesTransformChanged[ibody])
+        {
+            currObjectBody->mGameObject->CommitPhysicsTransform();
+        }
+
+        if (currObjectBody->CheckFlags(PhysicsBodyFlags_Static | PhysicsBodyFlags_Disabled))
+            continue;
+
+        if (currObjectBody->IsAwake())
+        {
+            ++mPhysicsStats.mAwakeBodiesCount;
+        }
+        else
         {
-            currGameObject->SyncPhysicsTransform();
+            ++mPhysicsStats.mSleepingBodiesCount;
         }
     }
+
+    std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
+    mPhysicsStats.mSimulationStepTime = std::chrono::duration<float, std::micro>(timeEnd - timeStart).count();
 }
 
 PhysicsBody* PhysicsManager::CreateBody(GameObject* gameObject, PhysicsBodyFlags flags)
@@ -168,19 +225,34 @@ PhysicsBody* PhysicsManager::CreateBody(GameObject* gameObject, const CollisionS
 
 void PhysicsManager::CreateMapCollisionShape()
 {
-    b2BodyDef bodyDef;
-    bodyDef.type = b2_staticBody;
-    bodyDef.userData.pointer = reinterpret_cast<uintptr_t>(nullptr); // make sure userdata is nullptr
+    BuildMapCollisionAreas(gCvarPhysicsMergeMapShapes.mValue, mMapCollisionAreas);
 
-    mBox2MapBody = mBox2World->CreateBody(&bodyDef);
+    mBox2MapBody = CreateMapCollisionBody(mBox2World, mMapCollisionAreas);
     debug_assert(mBox2MapBody);
 
-    int numFixtures = 0;
-    // for each block create fixture
-    for (int x = 0; x < MAP_DIMENSIONS; ++x)
+    gConsole.LogMessage(eLogMessage_Debug, "Map collision fixtures count: %d (merge %s)", 
+        (int) mMapCollisionAreas.size(), gCvarPhysicsMergeMapShapes.mValue ? "on" : "off");
+}
+
+void PhysicsManager::BuildMapCollisionAreas(bool mergeColumns, std::vector<MapCollisionArea>& outputAreas) const
+{
+    outputAreas.clear();
+
+    auto is_walkable = [](eGroundType gtype)
     {
-        for (int y = 0; y < MAP_DIMENSIONS; ++y)
+        return gtype == eGroundType_Field || gtype == eGroundType_Pawement || gtype == eGroundType_Road;
+    };
+
+    // find out building layers for each block column, zero if column doesn't need collision shape
+    std::vector<unsigned char> columnsLayers(MAP_DIMENSIONS * MAP_DIMENSIONS, 0);
+    static_assert(MAP_LAYERS_COUNT <= 8, "Cannot pack building layers into byte");
+
+    for (int y = 0; y < MAP_DIMENSIONS; ++y)
+    {
+        for (int x = 0; x < MAP_DIMENSIONS; ++x)
         {
+            unsigned char buildingLayers = 0;
+            bool hasOuterBlock = false;
             for (int layer = 0; layer < MAP_LAYERS_COUNT; ++layer)
             {
                 const MapBlockInfo* blockData = gGameMap.GetBlockInfo(x, y, layer);
@@ -189,52 +261,200 @@ void PhysicsManager::CreateMapCollisionShape()
                 if (blockData->mGroundType != eGroundType_Building)
                     continue;
 
+                buildingLayers |= (1 << layer);
+
                 // checek blox is inner
+                const MapBlockInfo* neighbourE = gGameMap.GetBlockInfo(x + 1, y, layer);
+                const MapBlockInfo* neighbourW = gGameMap.GetBlockInfo(x - 1, y, layer);
+                const MapBlockInfo* neighbourN = gGameMap.GetBlockInfo(x, y - 1, layer);
+                const MapBlockInfo* neighbourS = gGameMap.GetBlockInfo(x, y + 1, layer);
+
+                if (is_walkable(neighbourE->mGroundType) || is_walkable(neighbourW->mGroundType) ||
+                    is_walkable(neighbourN->mGroundType) || is_walkable(neighbourS->mGroundType))
                 {
-                    const MapBlockInfo* neighbourE = gGameMap.GetBlockInfo(x + 1, y, layer);
-                    const MapBlockInfo* neighbourW = gGameMap.GetBlockInfo(x - 1, y, layer);
-                    const MapBlockInfo* neighbourN = gGameMap.GetBlockInfo(x, y - 1, layer);
-                    const MapBlockInfo* neighbourS = gGameMap.GetBlockInfo(x, y + 1, layer);
+                    hasOuterBlock = true;
+                }
+            }
 
-                    auto is_walkable = [](eGroundType gtype)
-                    {
-                        return gtype == eGroundType_Field || gtype == eGroundType_Pawement || gtype == eGroundType_Road;
-                    };
+            if (hasOuterBlock) // inner columns are just ignored
+            {
+                columnsLayers[y * MAP_DIMENSIONS + x] = buildingLayers;
+            }
+        }
+    }
+
+    if (!mergeColumns)
+    {
+        // single fixture per block column
+        for (int y = 0; y < MAP_DIMENSIONS; ++y)
+        {
+            for (int x = 0; x < MAP_DIMENSIONS; ++x)
+            {
+                if (columnsLayers[y * MAP_DIMENSIONS + x] == 0)
+                    continue;
 
-                    if (!is_walkable(neighbourE->mGroundType) && !is_walkable(neighbourW->mGroundType) &&
-                        !is_walkable(neighbourN->mGroundType) && !is_walkable(neighbourS->mGroundType))
+                MapCollisionArea& area = outputAreas.emplace_back();
+                area.mX = x;
+                area.mZ = y;
+                area.mSizeX = 1;
+                area.mSizeZ = 1;
+            }
+        }
+        return;
+    }
+
+    // greedy merge adjacent columns into maximal rectangles, only columns with same building layers are merged
+    // so collision filtering by object's height gives same result for any block within area
+
+    for (int y = 0; y < MAP_DIMENSIONS; ++y)
+    {
+        for (int x = 0; x < MAP_DIMENSIONS; ++x)
+        {
+            const unsigned char buildingLayers = columnsLayers[y * MAP_DIMENSIONS + x];
+            if (buildingLayers == 0)
+                continue;
+
+            int sizeX = 1;
+            while ((x + sizeX) < MAP_DIMENSIONS && columnsLayers[y * MAP_DIMENSIONS + x + sizeX] == buildingLayers)
+            {
+                ++sizeX;
+            }
+
+            int sizeZ = 1;
+            for (; (y + sizeZ) < MAP_DIMENSIONS; ++sizeZ)
+            {
+                const unsigned char* rowColumns = &columnsLayers[(y + sizeZ) * MAP_DIMENSIONS + x];
+                if (std::any_of(rowColumns, rowColumns + sizeX, [buildingLayers](unsigned char currLayers)
                     {
-                        continue; // just ignore this block
-                    }
+                        return currLayers != buildingLayers;
+                    }))
+                {
+                    break;
                 }
+            }
+
+            // mark columns processed
+            for (int currZ = y; currZ < (y + sizeZ); ++currZ)
+            {
+                unsigned char* rowColumns = &columnsLayers[currZ * MAP_DIMENSIONS + x];
+                std::fill(rowColumns, rowColumns + sizeX, 0);
+            }
+
+            MapCollisionArea& area = outputAreas.emplace_back();
+            area.mX = x;
+            area.mZ = y;
+            area.mSizeX = sizeX;
+            area.mSizeZ = sizeZ;
+        }
+    }
+}
+
+b2Body* PhysicsManager::CreateMapCollisionBody(b2World* box2World, const std::vector<MapCollisionArea>& areas) const
+{
+    b2BodyDef bodyDef;
+    bodyDef.type = b2_staticBody;
+    bodyDef.userData.pointer = reinterpret_cast<uintptr_t>(nullptr); // make sure userdata is nullptr
 
-                b2PolygonShape b2shapeDef;
+    b2Body* box2Body = box2World->CreateBody(&bodyDef);
+    debug_assert(box2Body);
 
-                glm::vec2 shapeCenter (x + 0.5f, y + 0.5f);
-                shapeCenter = Convert::MapUnitsToMeters(shapeCenter);
+    for (size_t iarea = 0, NumAreas = areas.size(); iarea < NumAreas; ++iarea)
+    {
+        const MapCollisionArea& area = areas[iarea];
 
-                glm::vec2 shapeLength (0.5f, 0.5f);
-                shapeLength = Convert::MapUnitsToMeters(shapeLength);
+        b2PolygonShape b2shapeDef;
 
-                b2shapeDef.SetAsBox(shapeLength.x, shapeLength.y, convert_vec2(shapeCenter), 0.0f);
+        glm::vec2 shapeLength (area.mSizeX * 0.5f, area.mSizeZ * 0.5f);
+        glm::vec2 shapeCenter (area.mX + shapeLength.x, area.mZ + shapeLength.y);
+        shapeCenter = Convert::MapUnitsToMeters(shapeCenter);
+        shapeLength = Convert::MapUnitsToMeters(shapeLength);
 
-                b2FixtureData_map fixtureData;
-                fixtureData.mX = x;
-                fixtureData.mZ = y;
+        b2shapeDef.SetAsBox(shapeLength.x, shapeLength.y, convert_vec2(shapeCenter), 0.0f);
 
-                b2FixtureDef b2fixtureDef;
-                b2fixtureDef.density = 0.0f;
-                b2fixtureDef.shape = &b2shapeDef;
-                b2fixtureDef.userData.pointer = reinterpret_cast<uintptr_t>(fixtureData.mAsPointer);
-                b2fixtureDef.filter.categoryBits = CollisionGroup_MapBlock;
+        b2FixtureData_map fixtureData;
+        fixtureData.mAreaIndex = iarea;
 
-                b2Fixture* b2fixture = mBox2MapBody->CreateFixture(&b2fixtureDef);
-                debug_assert(b2fixture);
+        b2FixtureDef b2fixtureDef;
+        b2fixtureDef.density = 0.0f;
+        b2fixtureDef.shape = &b2shapeDef;
+        b2fixtureDef.userData.pointer = reinterpret_cast<uintptr_t>(fixtureData.mAsPointer);
+        b2fixtureDef.filter.categoryBits = CollisionGroup_MapBlock;
 
-                ++numFixtures;
-                break; // single fixture per block column
-            }
+        b2Fixture* b2fixture = box2Body->CreateFixture(&b2fixtureDef);
+        debug_assert(b2fixture);
+    }
+    return box2Body;
+}
+
+const MapBlockInfo* PhysicsManager::GetMapFixtureBlockInfo(b2Fixture* mapFixture, const glm::vec2& position, int mapLayer) const
+{
+    b2FixtureData_map fxdata = (b2FixtureData_map*) mapFixture->GetUserData().pointer;
+    debug_assert(fxdata.mAreaIndex < mMapCollisionAreas.size());
+
+    const MapCollisionArea& area = mMapCollisionAreas[fxdata.mAreaIndex];
+
+    // find block within area which is closest to specified position
+    glm::vec2 positionMapUnits = Convert::MetersToMapUnits(position);
+    int blockX = glm::clamp((int) floorf(positionMapUnits.x), (int) area.mX, area.mX + area.mSizeX - 1);
+    int blockZ = glm::clamp((int) floorf(positionMapUnits.y), (int) area.mZ, area.mZ + area.mSizeZ - 1);
+    return gGameMap.GetBlockInfo(blockX, blockZ, mapLayer);
+}
+
+void PhysicsManager::DebugBenchmarkMapCollision(int numQueries)
+{
+    if (numQueries < 1)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Invalid benchmark arguments, expected number of queries");
+        return;
+    }
+
+    struct _query_callback: public b2QueryCallback
+    {
+    public:
+        bool ReportFixture(b2Fixture* fixture) override
+        {
+            ++mFixturesCount;
+            return true;
+        }
+    public:
+        long long mFixturesCount = 0;
+    };
+
+    std::vector<MapCollisionArea> collisionAreas;
+    // measure both modes using same set of queries
+    for (bool mergeColumns: {false, true})
+    {
+        std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+        BuildMapCollisionAreas(mergeColumns, collisionAreas);
+
+        b2World box2World ({0.0f, 0.0f});
+        CreateMapCollisionBody(&box2World, collisionAreas);
+        std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
+        long long buildMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(timeEnd - timeStart).count();
+
+        cxx::randomizer queriesRand;
+        _query_callback query_callback;
+
+        timeStart = std::chrono::steady_clock::now();
+        for (int iquery = 0; iquery < numQueries; ++iquery)
+        {
+            // object sized query area somewhere on map
+            glm::vec2 center (queriesRand.generate_float() * MAP_DIMENSIONS, queriesRand.generate_float() * MAP_DIMENSIONS);
+            glm::vec2 extents (queriesRand.generate_float(0.25f, 1.5f), queriesRand.generate_float(0.25f, 1.5f));
+            center = Convert::MapUnitsToMeters(center);
+            extents = Convert::MapUnitsToMeters(extents);
+
+            b2AABB aabb;
+            aabb.lowerBound = convert_vec2(center - extents);
+            aabb.upperBound = convert_vec2(center + extents);
+            box2World.QueryAABB(&query_callback, aabb);
         }
+        timeEnd = std::chrono::steady_clock::now();
+        long long queryMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(timeEnd - timeStart).count();
+
+        gConsole.LogMessage(eLogMessage_Info, "Map collision (merge %s): fixtures %d, build %lld us, %d queries %lld us, fixtures reported %lld", 
+            mergeColumns ? "on" : "off", 
+            (int) collisionAreas.size(), buildMicroseconds, numQueries, queryMicroseconds, query_callback.mFixturesCount);
     }
 }
 
@@ -269,7 +489,15 @@ void PhysicsManager::BeginContact(b2Contact* contact)
 
 void PhysicsManager::EndContact(b2Contact* contact)
 {
-    // do nothing
+    // contacts of sleeping bodies are not cleared each simulation step, so drop them explicitly
+    b2Fixture* fixtureA = contact->GetFixtureA();
+    b2Fixture* fixtureB = contact->GetFixtureB();
+    if (CheckCollisionGroup(fixtureA, CollisionGroup_MapBlock | CollisionGroup_Wall) ||
+        CheckCollisionGroup(fixtureB, CollisionGroup_MapBlock | CollisionGroup_Wall))
+    {
+        return;
+    }
+    UnregisterObjectsContact(fixtureA, fixtureB);
 }
 
 void PhysicsManager::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
@@ -292,6 +520,8 @@ void PhysicsManager::PreSolve(b2Contact* contact, const b2Manifold* oldManifold)
     }
     else // object vs object
     {
+        // contact might be registered on previous steps if one of bodies was sleeping
+        UnregisterObjectsContact(fixtureA, fixtureB);
         enableCollisionResponse = ShouldCollide_Objects(contact, fixtureA, fixtureB);
     }
     contact->SetEnabled(enableCollisionResponse);
@@ -327,7 +557,7 @@ void PhysicsManager::PostSolve(b2Contact* contact, const b2ContactImpulse* impul
     }
 }
 
-void PhysicsManager::UpdateHeightPosition(PhysicsBody* physicsBody)
+PhysicsManager::eFallEvent PhysicsManager::UpdateHeightPosition(PhysicsBody* physicsBody) const
 {
     GameObject* gameObject = physicsBody->mGameObject;
     debug_assert(gameObject);
@@ -335,11 +565,13 @@ void PhysicsManager::UpdateHeightPosition(PhysicsBody* physicsBody)
     if (gameObject->IsAttachedToObject())
     {
         debug_assert(false);
-        return;
+        return eFallEvent_None;
     }
 
     if (physicsBody->mWaterContact)
-        return;
+        return eFallEvent_None;
+
+    eFallEvent fallEvent = eFallEvent_None;
 
     float groundHeight = gGameMap.GetHeightAtPosition(physicsBody->GetPosition(), false);
 
@@ -353,14 +585,7 @@ void PhysicsManager::UpdateHeightPosition(PhysicsBody* physicsBody)
         {
             // handle water contact
             float waterHeight = gGameMap.GetWaterLevelAtPosition2(physicsBody->GetPosition2());
-            if (groundHeight <= waterHeight)
-            {
-                HandleFallsOnWater(physicsBody);
-            }
-            else
-            {
-                HandleFallsOnGround(physicsBody);
-            }
+            fallEvent = (groundHeight <= waterHeight) ? eFallEvent_FallsOnWater : eFallEvent_FallsOnGround;
         }
     }
     else
@@ -375,7 +600,7 @@ void PhysicsManager::UpdateHeightPosition(PhysicsBody* physicsBody)
         {
             if (gGameCheatsWindow.mEnableGravity)
             {
-                HandleFallingStarts(physicsBody);
+                fallEvent = eFallEvent_FallingStarts;
             }
         }
     }
@@ -385,6 +610,98 @@ void PhysicsManager::UpdateHeightPosition(PhysicsBody* physicsBody)
         // force body awake
         physicsBody->SetAwake(true);
     }
+    return fallEvent;
+}
+
+void PhysicsManager::DebugBenchmarkSimulationStep(int numSteps, int maxThreads)
+{
+    if (numSteps < 1)
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Invalid benchmark arguments, expected number of steps");
+        return;
+    }
+
+    const int currentThreadsCount = gJobsManager.GetWorkerThreadsCount();
+    if (maxThreads < 1)
+    {
+        maxThreads = currentThreadsCount + 1; // include calling thread
+    }
+
+    std::vector<Pedestrian*> benchObjects;
+    for (int numObjects: {2000, 5000, 10000})
+    {
+        for (int numThreads = 1; numThreads <= maxThreads; ++numThreads)
+        {
+            gJobsManager.SetWorkerThreadsCount(numThreads - 1);
+
+            // same spawn positions for each run
+            cxx::randomizer benchRand;
+            benchObjects.clear();
+            for (int icurr = 0; icurr < numObjects; ++icurr)
+            {
+                glm::vec2 position2 = Convert::MapUnitsToMeters(glm::vec2(
+                    benchRand.generate_float() * MAP_DIMENSIONS, 
+                    benchRand.generate_float() * MAP_DIMENSIONS));
+                glm::vec3 spawnPosition (position2.x, Convert::MapUnitsToMeters(MAP_LAYERS_COUNT * 1.0f), position2.y);
+                spawnPosition.y = gGameMap.GetHeightAtPosition(spawnPosition);
+
+                cxx::angle_t heading;
+                Pedestrian* pedestrian = gGameObjectsManager.CreatePedestrian(spawnPosition, heading, ePedestrianType_Civilian);
+                debug_assert(pedestrian);
+                pedestrian->mPhysicsBody->SetAwake(true);
+                benchObjects.push_back(pedestrian);
+            }
+
+            std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+            for (int istep = 0; istep < numSteps; ++istep)
+            {
+                ProcessSimulationStep();
+            }
+            std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
+
+            long long elapsedMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(timeEnd - timeStart).count();
+            gConsole.LogMessage(eLogMessage_Info, "Physics step %d bodies (%d threads): %d steps %lld us, %lld us per step, awake %d", 
+                (int) mBodiesList.size(), numThreads, numSteps, elapsedMicroseconds, elapsedMicroseconds / numSteps, 
+                mPhysicsStats.mAwakeBodiesCount);
+
+            // cleanup bench objects
+            for (Pedestrian* currPedestrian: benchObjects)
+            {
+                gGameObjectsManager.DestroyGameObject(currPedestrian);
+            }
+        }
+    }
+
+    gJobsManager.SetWorkerThreadsCount(currentThreadsCount);
+}
+
+void PhysicsManager::DispatchFallEvent(PhysicsBody* physicsBody, eFallEvent fallEvent)
+{
+    if (fallEvent == eFallEvent_FallingStarts)
+    {
+        HandleFallingStarts(physicsBody);
+    }
+    else if (fallEvent == eFallEvent_FallsOnGround)
+    {
+        HandleFallsOnGround(physicsBody);
+    }
+    else if (fallEvent == eFallEvent_FallsOnWater)
+    {
+        HandleFallsOnWater(physicsBody);
+    }
+}
+
+void PhysicsManager::ParallelForBodies(int numBodies, const std::function<void(int bodyIndex)>& bodyProc) const
+{
+    // bodies are split into batches to keep jobs overhead low
+    const int numJobs = (numBodies + BodiesPerJob - 1) / BodiesPerJob;
+    gJobsManager.ParallelFor(numJobs, [numBodies, &bodyProc](int jobIndex)
+        {
+            for (int ibody = jobIndex * BodiesPerJob, endBody = std::min(ibody + BodiesPerJob, numBodies); ibody < endBody; ++ibody)
+            {
+                bodyProc(ibody);
+            }
+        });
 }
 
 void PhysicsManager::QueryObjectsLinecast(const glm::vec2& pointA, const glm::vec2& pointB, PhysicsQueryResult& outputResult, CollisionGroup collisionMask) const
@@ -505,8 +822,8 @@ bool PhysicsManager::ShouldCollide_ObjectWithMap(b2Contact* contact, b2Fixture*
 
     // todo: this is temporary implementation
 
-    b2FixtureData_map fxdata = (b2FixtureData_map*) mapFixture->GetUserData().pointer;
-    const MapBlockInfo* blockData = gGameMap.GetBlockInfo(fxdata.mX, fxdata.mZ, mapLayer);
+    // all blocks within collision area has same building layers, so any of them may be checked
+    const MapBlockInfo* blockData = GetMapFixtureBlockInfo(mapFixture, gameObject->mPhysicsBody->GetPosition2(), mapLayer);
     return (blockData->mGroundType == eGroundType_Building);
 }
 
@@ -561,6 +878,20 @@ bool PhysicsManager::ShouldCollide_Objects(b2Contact* box2contact, b2Fixture* fi
     return shouldCollide;
 }
 
+void PhysicsManager::UnregisterObjectsContact(b2Fixture* fixtureA, b2Fixture* fixtureB) const
+{
+    GameObject* gameObjectA = b2Fixture_get_game_object(fixtureA);
+    GameObject* gameObjectB = b2Fixture_get_game_object(fixtureB);
+    if (gameObjectA == nullptr || gameObjectB == nullptr)
+        return;
+
+    Collider* colliderA = b2Fixture_get_collider(fixtureA);
+    Collider* colliderB = b2Fixture_get_collider(fixtureB);
+
+    gameObjectA->UnregisterContact(colliderA, colliderB);
+    gameObjectB->UnregisterContact(colliderB, colliderA);
+}
+
 void PhysicsManager::HandleCollision_ObjectWithMap(b2Fixture* objectFixture, b2Fixture* mapFixture, b2Contact* contact, const b2ContactImpulse* impulse)
 {
     GameObject* gameObject = b2Fixture_get_game_object(objectFixture);
@@ -569,7 +900,14 @@ void PhysicsManager::HandleCollision_ObjectWithMap(b2Fixture* objectFixture, b2F
     float height = gGameMap.GetHeightAtPosition(gameObject->mPhysicsBody->GetPosition());
     int mapLayer = (int) (Convert::MetersToMapUnits(height) + 0.5f);
 
-    b2FixtureData_map fxdata = (b2FixtureData_map*) mapFixture->GetUserData().pointer;
+    // find out exact block which is hit
+    glm::vec2 contactPoint = gameObject->mPhysicsBody->GetPosition2();
+    if (contact->GetManifold()->pointCount > 0)
+    {
+        b2WorldManifold wmanifold;
+        contact->GetWorldManifold(&wmanifold);
+        contactPoint = convert_vec2(wmanifold.points[0]);
+    }
 
     // queue collision event
     mObjectsCollisionList.emplace_back();
@@ -578,7 +916,7 @@ void PhysicsManager::HandleCollision_ObjectWithMap(b2Fixture* objectFixture, b2F
     collisionEvent.mBox2Impulse = *impulse;
     collisionEvent.mBox2Contact = contact;
     collisionEvent.mBox2FixtureA = objectFixture;
-    collisionEvent.mMapBlockInfo = gGameMap.GetBlockInfo(fxdata.mX, fxdata.mZ, mapLayer);
+    collisionEvent.mMapBlockInfo = GetMapFixtureBlockInfo(mapFixture, contactPoint, mapLayer);
     debug_assert(collisionEvent.mMapBlockInfo);
 
     if (Vehicle* carObject = ToVehicle(gameObject))
@@ -775,6 +1113,7 @@ void PhysicsManager::HandleFallsOnWater(PhysicsBody* physicsBody)
     physicsBody->mGameObject->HandleFallsOnWater(fallDistance);
 
     physicsBody->mPositionY -= Convert::MapUnitsToMeters(1.0f); // put it down
+    physicsBody->SetAwake(true);
 }
 
 float PhysicsManager::GetSimulationStepTime() const
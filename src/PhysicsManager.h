@@ -5,11 +5,27 @@
 
 // note that the physics only works with meter units (Mt) not map units
 
+// physics simulation statistics info
+struct PhysicsStats
+{
+public:
+    PhysicsStats() = default;
+
+public:
+    // last simulation step
+    float mSimulationStepTime = 0.0f; // microseconds
+    int mAwakeBodiesCount = 0;
+    int mSleepingBodiesCount = 0;
+};
+
 // this class manages physics and collision detections for map and objects
 class PhysicsManager final: private b2ContactListener
 {
     friend class PhysicsBody;
 
+public:
+    PhysicsStats mPhysicsStats;
+
 public:
     PhysicsManager();
 
@@ -37,6 +53,15 @@ public:
     void QueryObjectsLinecast(const glm::vec2& pointA, const glm::vec2& pointB, PhysicsQueryResult& outputResult, CollisionGroup collisionMask) const;
     void QueryObjectsWithinBox(const glm::vec2& center, const glm::vec2& extents, PhysicsQueryResult& outputResult, CollisionGroup collisionMask) const;
 
+    // Debug: build map collision shape with and without merging columns and print fixtures count, build time and queries time
+    // @param numQueries: Number of random box queries against map body
+    void DebugBenchmarkMapCollision(int numQueries);
+
+    // Debug: spawn 2k, 5k and 10k pedestrians and measure simulation step time with different number of threads
+    // @param numSteps: Number of simulation steps per run
+    // @param maxThreads: Max number of threads including calling thread, 0 for current workers count
+    void DebugBenchmarkSimulationStep(int numSteps, int maxThreads);
+
 private:
     // override b2ContactListener
     void BeginContact(b2Contact* contact) override;
@@ -47,6 +72,9 @@ private:
     bool ShouldCollide_ObjectWithMap(b2Contact* contact, b2Fixture* objectFixture, b2Fixture* mapFixture) const;
     bool ShouldCollide_Objects(b2Contact* contact, b2Fixture* fixtureA, b2Fixture* fixtureB) const;
 
+    // Remove contact between objects colliders registered on previous simulation steps
+    void UnregisterObjectsContact(b2Fixture* fixtureA, b2Fixture* fixtureB) const;
+
     void HandleCollision_ObjectWithMap(b2Fixture* objectFixture, b2Fixture* mapFixture, b2Contact* contact, const b2ContactImpulse* impulse);
     void HandleCollision_Objects(b2Fixture* fixtureA, b2Fixture* fixtureB, b2Contact* contact, const b2ContactImpulse* impulse);
 
@@ -54,12 +82,43 @@ private:
     void HandleCollision_CarVsCar(Vehicle* carA, Vehicle* carB, b2Contact* contact, const b2ContactImpulse* impulse);
     void HandleCollision_CarVsMap(Vehicle* car, b2Contact* contact, const b2ContactImpulse* impulse);
 
+    // map collision area, single fixture covers one or more adjacent block columns
+    struct MapCollisionArea
+    {
+        unsigned char mX, mZ; // top left block column
+        unsigned short mSizeX, mSizeZ; // size in block columns
+    };
+
     // create level map body, used internally
     void CreateMapCollisionShape();
+    void BuildMapCollisionAreas(bool mergeColumns, std::vector<MapCollisionArea>& outputAreas) const;
+    b2Body* CreateMapCollisionBody(b2World* box2World, const std::vector<MapCollisionArea>& areas) const;
+
+    // Get map block that was hit by object within specific map fixture
+    // @param position: Contact point or object position
+    const MapBlockInfo* GetMapFixtureBlockInfo(b2Fixture* mapFixture, const glm::vec2& position, int mapLayer) const;
+
+    // bodies processed by single job in parallel step phases
+    static const int BodiesPerJob = 256;
+
+    enum eFallEvent: unsigned char
+    {
+        eFallEvent_None,
+        eFallEvent_FallingStarts,
+        eFallEvent_FallsOnGround,
+        eFallEvent_FallsOnWater,
+    };
 
     void ProcessInterpolation();
     void ProcessSimulationStep();
-    void UpdateHeightPosition(PhysicsBody* physicsBody);
+
+    // Compute body height above ground, touches only specified body so might be called simultaneously
+    // @returns falling state change that must be dispatched serially
+    eFallEvent UpdateHeightPosition(PhysicsBody* physicsBody) const;
+    void DispatchFallEvent(PhysicsBody* physicsBody, eFallEvent fallEvent);
+
+    // Run procedure for each body index in range [0, numBodies) using worker threads, wait until completed
+    void ParallelForBodies(int numBodies, const std::function<void(int bodyIndex)>& bodyProc) const;
 
     void DispatchCollisionEvents();
 
@@ -96,6 +155,11 @@ private:
     std::vector<PhysicsBody*> mBodiesList;
 
     std::vector<CollisionEvent> mObjectsCollisionList;
+
+    // per-body results of parallel simulation step phases
+    std::vector<eFallEvent> mBodiesFallEvents;
+    std::vector<unsigned char> mBodiesTransformChanged; // not vector<bool> because it is written from multiple threads
+    std::vector<MapCollisionArea> mMapCollisionAreas; // map fixtures data
 };
 
 extern PhysicsManager gPhysics;
\ No newline at end of file
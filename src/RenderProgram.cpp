@@ -3,8 +3,9 @@
 #include "GpuProgram.h"
 #include "cvars.h"
 
-RenderProgram::RenderProgram(const char* srcFileName)
+RenderProgram::RenderProgram(const char* srcFileName, const char* srcDefines)
     : mSourceFileName(srcFileName)
+    , mSourceDefines(srcDefines)
 {
 }
 
@@ -41,6 +42,12 @@ bool RenderProgram::Reinitialize()
         return false;
     }
 
+    // same source might be shared by several programs with different definitions
+    if (mSourceDefines)
+    {
+        shaderSourceCode.insert(0, mSourceDefines);
+    }
+
     bool isCompiled = mGpuProgram->CompileSourceCode(shaderSourceCode.c_str());
     if (isCompiled)
     {
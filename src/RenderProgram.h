@@ -7,13 +7,15 @@ class RenderProgram: public cxx::noncopyable
 {
 public:
     const char* const mSourceFileName; // immutable
+    const char* const mSourceDefines; // immutable
 
     // public for convenience, should not be modified directly
     GpuProgram* mGpuProgram = nullptr;
 
 public:
     // @param srcFileName: File name of shader source, should be static string
-    RenderProgram(const char* srcFileName);
+    // @param srcDefines: Preprocessor definitions prepended to shader source, should be static string
+    RenderProgram(const char* srcFileName, const char* srcDefines = nullptr);
     virtual ~RenderProgram();
 
     // loading and uloading routines, returns false on error
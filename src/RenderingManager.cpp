@@ -2,6 +2,7 @@
 #include "RenderingManager.h"
 #include "GpuTexture2D.h"
 #include "GpuProgram.h"
+#include "GpuBuffer.h"
 #include "SpriteManager.h"
 #include "GameCheatsWindow.h"
 #include "AiManager.h"
@@ -9,6 +10,7 @@
 #include "ParticleEffectsManager.h"
 #include "ParticleRenderdata.h"
 #include "CarnageGame.h"
+#include "FrameProfiler.h"
 
 RenderingManager gRenderManager;
 
@@ -17,6 +19,7 @@ RenderingManager::RenderingManager()
     , mGuiTexColorProgram("shaders/gui.glsl")
     , mCityMeshProgram("shaders/city_mesh.glsl")
     , mSpritesProgram("shaders/sprites.glsl")
+    , mSpritesInstancedProgram("shaders/sprites.glsl", "#define INSTANCED_SPRITES\n")
     , mDebugProgram("shaders/debug.glsl")
     , mParticleProgram("shaders/particle.glsl")
 {
@@ -49,11 +52,22 @@ void RenderingManager::Deinit()
     mMapRenderer.Deinit();
     gSpriteManager.Cleanup();
 
+    if (mQuadsIndexBuffer)
+    {
+        gGraphicsDevice.DestroyBuffer(mQuadsIndexBuffer);
+        mQuadsIndexBuffer = nullptr;
+    }
+    mQuadsIndexBufferCapacity = 0;
+
     FreeRenderPrograms();
 }
 
 void RenderingManager::RenderFrame()
 {
+    PROFILER_SCOPE("Render");
+
+    std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+
     gGraphicsDevice.ClearScreen();
     gSpriteManager.RenderFrameBegin();
     mMapRenderer.RenderFrameBegin();
@@ -64,12 +78,19 @@ void RenderingManager::RenderFrame()
         currRenderview->ComputeMatricesAndFrustum();
         gGraphicsDevice.SetViewportRect(currRenderview->mViewportRect);
 
-        mMapRenderer.RenderFrame(currRenderview);
-        RenderParticleEffects(currRenderview);
+        {
+            PROFILER_SCOPE("RenderMap");
+            mMapRenderer.RenderFrame(currRenderview);
+        }
+        {
+            PROFILER_SCOPE("RenderParticles");
+            RenderParticleEffects(currRenderview);
+        }
 
         // draw debug info for first human view only
         if (currRenderview == mActiveRenderViews[0] && gGameCheatsWindow.mEnableDebugDraw)
         {
+            PROFILER_SCOPE("RenderDebug");
             mDebugRenderer.RenderFrameBegin(currRenderview);
             mMapRenderer.DebugDraw(mDebugRenderer);
             gTrafficManager.DebugDraw(mDebugRenderer);
@@ -80,11 +101,58 @@ void RenderingManager::RenderFrame()
     }
     gGraphicsDevice.SetViewportRect(prevScreenRect);
 
-    gGuiManager.RenderFrame();
+    {
+        PROFILER_SCOPE("RenderGui");
+        gGuiManager.RenderFrame();
+    }
 
     mMapRenderer.RenderFrameEnd();
     gSpriteManager.RenderFrameEnd();
-    gGraphicsDevice.Present();
+
+    std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
+    mRenderFrameTime = std::chrono::duration_cast<std::chrono::microseconds>(timeEnd - timeStart).count();
+    {
+        PROFILER_SCOPE("Present");
+        gGraphicsDevice.Present();
+    }
+}
+
+GpuBuffer* RenderingManager::GetQuadsIndexBuffer(unsigned int numQuads)
+{
+    if (numQuads <= mQuadsIndexBufferCapacity)
+        return mQuadsIndexBuffer;
+
+    unsigned int newCapacity = std::max(mQuadsIndexBufferCapacity * 2, 4096U);
+    while (newCapacity < numQuads)
+    {
+        newCapacity *= 2;
+    }
+
+    std::vector<DrawIndex> quadsIndices(newCapacity * 6);
+    for (unsigned int iquad = 0; iquad < newCapacity; ++iquad)
+    {
+        DrawIndex* indexData = &quadsIndices[iquad * 6];
+        DrawIndex vertexOffset = iquad * 4;
+        indexData[0] = vertexOffset + 0;
+        indexData[1] = vertexOffset + 1;
+        indexData[2] = vertexOffset + 2;
+        indexData[3] = vertexOffset + 1;
+        indexData[4] = vertexOffset + 2;
+        indexData[5] = vertexOffset + 3;
+    }
+
+    unsigned int dataLength = Sizeof_DrawIndex * quadsIndices.size();
+    if (mQuadsIndexBuffer == nullptr)
+    {
+        mQuadsIndexBuffer = gGraphicsDevice.CreateBuffer(eBufferContent_Indices, eBufferUsage_Static, dataLength, quadsIndices.data());
+        debug_assert(mQuadsIndexBuffer);
+    }
+    else if (!mQuadsIndexBuffer->Setup(eBufferUsage_Static, dataLength, quadsIndices.data()))
+    {
+        debug_assert(false);
+    }
+    mQuadsIndexBufferCapacity = mQuadsIndexBuffer ? newCapacity : 0;
+    return mQuadsIndexBuffer;
 }
 
 void RenderingManager::FreeRenderPrograms()
@@ -93,6 +161,7 @@ void RenderingManager::FreeRenderPrograms()
     mCityMeshProgram.Deinit();
     mGuiTexColorProgram.Deinit();
     mSpritesProgram.Deinit();
+    mSpritesInstancedProgram.Deinit();
     mParticleProgram.Deinit();
     mDebugProgram.Deinit();
 }
@@ -103,6 +172,7 @@ bool RenderingManager::InitRenderPrograms()
     mGuiTexColorProgram.Initialize();
     mCityMeshProgram.Initialize(); 
     mSpritesProgram.Initialize();
+    mSpritesInstancedProgram.Initialize();
     mParticleProgram.Initialize();
     mDebugProgram.Initialize();
 
@@ -117,6 +187,7 @@ void RenderingManager::ReloadRenderPrograms()
     mGuiTexColorProgram.Reinitialize();
     mDebugProgram.Reinitialize();
     mSpritesProgram.Reinitialize();
+    mSpritesInstancedProgram.Reinitialize();
     mParticleProgram.Reinitialize();
     mCityMeshProgram.Reinitialize();
 }
@@ -14,6 +14,7 @@ public:
     RenderProgram mCityMeshProgram;
     RenderProgram mGuiTexColorProgram;
     RenderProgram mSpritesProgram;
+    RenderProgram mSpritesInstancedProgram;
     RenderProgram mDebugProgram;
     RenderProgram mParticleProgram;
 
@@ -21,6 +22,10 @@ public:
 
     std::vector<GameCamera*> mActiveRenderViews;
 
+    // readonly
+    // last frame render time excluding present, in microseconds
+    long long mRenderFrameTime = 0;
+
 public:
     RenderingManager();
 
@@ -46,6 +51,10 @@ public:
     void RegisterParticleEffect(ParticleEffect* particleEffect);
     void UnregisterParticleEffect(ParticleEffect* particleEffect);
 
+    // Get shared index buffer filled with quads pattern 0, 1, 2, 1, 2, 3, buffer grows on demand
+    // @param numQuads: Minimum number of quads
+    GpuBuffer* GetQuadsIndexBuffer(unsigned int numQuads);
+
 private:
     void RenderParticleEffects(GameCamera* renderview);
     void RenderParticleEffect(GameCamera* renderview, ParticleEffect* particleEffect);
@@ -56,6 +65,9 @@ private:
 
 private:
     DebugRenderer mDebugRenderer;
+
+    GpuBuffer* mQuadsIndexBuffer = nullptr;
+    unsigned int mQuadsIndexBufferCapacity = 0; // quads
 };
 
 extern RenderingManager gRenderManager;
\ No newline at end of file
@@ -0,0 +1,435 @@
+#include "stdafx.h"
+#include "ReplayManager.h"
+#include "TimeManager.h"
+#include "cvars.h"
+
+//////////////////////////////////////////////////////////////////////////
+// cvars
+//////////////////////////////////////////////////////////////////////////
+
+CvarString gCvarReplayRecord("g_replayRecord", "", "Record game session to specified replay file", CvarFlags_Init);
+CvarString gCvarReplayPlayback("g_replayPlayback", "", "Play back game session from specified replay file", CvarFlags_Init);
+
+//////////////////////////////////////////////////////////////////////////
+
+static const unsigned int ReplayFileSignature = 0x50523343; // C3RP
+static const unsigned short ReplayFileVersion = 1;
+
+enum eReplayInputEvent: unsigned char
+{
+    eReplayInputEvent_Key,
+    eReplayInputEvent_KeyChar,
+    eReplayInputEvent_MouseButton,
+    eReplayInputEvent_MouseMoved,
+    eReplayInputEvent_MouseScroll,
+    eReplayInputEvent_Gamepad,
+};
+
+//////////////////////////////////////////////////////////////////////////
+
+ReplayManager gReplayManager;
+
+//////////////////////////////////////////////////////////////////////////
+
+bool ReplayManager::Initialize()
+{
+    mReplayMode = eReplayMode_None;
+    mFramesCounter = 0;
+    mFrameEventsCount = 0;
+    mFrameEventsData.clear();
+    mHeaderWritten = false;
+    mPlaybackFinished = false;
+    mDispatchingEvents = false;
+
+    if (!gCvarReplayPlayback.mValue.empty())
+    {
+        if (!gCvarReplayRecord.mValue.empty())
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Replay recording is ignored during playback");
+        }
+        return StartPlayback(gCvarReplayPlayback.mValue);
+    }
+
+    if (!gCvarReplayRecord.mValue.empty())
+        return StartRecording(gCvarReplayRecord.mValue);
+
+    return true;
+}
+
+void ReplayManager::Deinit()
+{
+    if (IsRecording())
+    {
+        gConsole.LogMessage(eLogMessage_Info, "Replay recording finished, frames recorded: %d", mFramesCounter);
+    }
+
+    mRecordStream.close();
+    mPlaybackStream.close();
+    mReplayMode = eReplayMode_None;
+    mFrameEventsData.clear();
+    mFrameEventsCount = 0;
+}
+
+void ReplayManager::UpdateFrame()
+{
+    if (IsRecording())
+    {
+        if (!WriteFrame())
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Cannot write replay frame, recording stopped");
+            mRecordStream.close();
+            mReplayMode = eReplayMode_None;
+        }
+        return;
+    }
+
+    if (IsPlayback())
+    {
+        if (!ReadFrame())
+        {
+            FinishPlayback();
+        }
+        return;
+    }
+}
+
+bool ReplayManager::IsRecording() const
+{
+    return mReplayMode == eReplayMode_Recording;
+}
+
+bool ReplayManager::IsPlayback() const
+{
+    return mReplayMode == eReplayMode_Playback;
+}
+
+bool ReplayManager::IsPlaybackFinished() const
+{
+    return mPlaybackFinished;
+}
+
+template<typename TValue>
+inline void ReplayManager::PutEventData(const TValue& value)
+{
+    const unsigned char* valueBytes = reinterpret_cast<const unsigned char*>(&value);
+    mFrameEventsData.insert(mFrameEventsData.end(), valueBytes, valueBytes + sizeof(TValue));
+}
+
+bool ReplayManager::ProcessInputEvent(const KeyInputEvent& inputEvent)
+{
+    if (IsPlayback())
+        return mDispatchingEvents;
+
+    if (IsRecording())
+    {
+        ++mFrameEventsCount;
+        PutEventData(eReplayInputEvent_Key);
+        PutEventData((short) inputEvent.mKeycode);
+        PutEventData((int) inputEvent.mScancode);
+        PutEventData((unsigned char) inputEvent.mMods);
+        PutEventData((unsigned char) inputEvent.mPressed);
+    }
+    return true;
+}
+
+bool ReplayManager::ProcessInputEvent(const KeyCharEvent& inputEvent)
+{
+    if (IsPlayback())
+        return mDispatchingEvents;
+
+    if (IsRecording())
+    {
+        ++mFrameEventsCount;
+        PutEventData(eReplayInputEvent_KeyChar);
+        PutEventData(inputEvent.mUnicodeChar);
+    }
+    return true;
+}
+
+bool ReplayManager::ProcessInputEvent(const MouseButtonInputEvent& inputEvent)
+{
+    if (IsPlayback())
+        return mDispatchingEvents;
+
+    if (IsRecording())
+    {
+        ++mFrameEventsCount;
+        PutEventData(eReplayInputEvent_MouseButton);
+        PutEventData((unsigned char) inputEvent.mButton);
+        PutEventData((unsigned char) inputEvent.mMods);
+        PutEventData((unsigned char) inputEvent.mPressed);
+    }
+    return true;
+}
+
+bool ReplayManager::ProcessInputEvent(const MouseMovedInputEvent& inputEvent)
+{
+    if (IsPlayback())
+        return mDispatchingEvents;
+
+    if (IsRecording())
+    {
+        ++mFrameEventsCount;
+        PutEventData(eReplayInputEvent_MouseMoved);
+        PutEventData((short) inputEvent.mCursorPositionX);
+        PutEventData((short) inputEvent.mCursorPositionY);
+        PutEventData((short) inputEvent.mDeltaX);
+        PutEventData((short) inputEvent.mDeltaY);
+    }
+    return true;
+}
+
+bool ReplayManager::ProcessInputEvent(const MouseScrollInputEvent& inputEvent)
+{
+    if (IsPlayback())
+        return mDispatchingEvents;
+
+    if (IsRecording())
+    {
+        ++mFrameEventsCount;
+        PutEventData(eReplayInputEvent_MouseScroll);
+        PutEventData((short) inputEvent.mScrollX);
+        PutEventData((short) inputEvent.mScrollY);
+    }
+    return true;
+}
+
+bool ReplayManager::ProcessInputEvent(const GamepadInputEvent& inputEvent)
+{
+    if (IsPlayback())
+        return mDispatchingEvents;
+
+    if (IsRecording())
+    {
+        ++mFrameEventsCount;
+        PutEventData(eReplayInputEvent_Gamepad);
+        PutEventData((unsigned char) inputEvent.mGamepad);
+        PutEventData((unsigned char) inputEvent.mButton);
+        PutEventData((unsigned char) inputEvent.mPressed);
+    }
+    return true;
+}
+
+bool ReplayManager::StartRecording(const std::string& fileName)
+{
+    if (!gFiles.CreateBinaryFile(fileName, mRecordStream))
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot create replay file '%s'", fileName.c_str());
+        return false;
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Replay recording started '%s'", fileName.c_str());
+    mReplayMode = eReplayMode_Recording;
+    return true;
+}
+
+bool ReplayManager::StartPlayback(const std::string& fileName)
+{
+    if (!gFiles.OpenBinaryFile(fileName, mPlaybackStream))
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot open replay file '%s'", fileName.c_str());
+        return false;
+    }
+
+    if (!ReadReplayHeader())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot read replay file header '%s'", fileName.c_str());
+        mPlaybackStream.close();
+        return false;
+    }
+
+    gConsole.LogMessage(eLogMessage_Info, "Replay playback started '%s'", fileName.c_str());
+    mReplayMode = eReplayMode_Playback;
+    return true;
+}
+
+bool ReplayManager::WriteReplayHeader()
+{
+    const std::string& mapName = gCvarMapname.mValue;
+
+    // game params that affect simulation
+    cxx::write_to_stream(mRecordStream, ReplayFileSignature);
+    cxx::write_to_stream(mRecordStream, ReplayFileVersion);
+    cxx::write_to_stream(mRecordStream, gCvarRandomSeed.mValue);
+    cxx::write_to_stream(mRecordStream, gCvarPhysicsFramerate.mValue);
+    cxx::write_to_stream(mRecordStream, (unsigned char) gCvarNumPlayers.mValue);
+    cxx::write_to_stream(mRecordStream, (unsigned short) mapName.size());
+    return !!mRecordStream.write(mapName.data(), mapName.size());
+}
+
+bool ReplayManager::ReadReplayHeader()
+{
+    unsigned int signature = 0;
+    unsigned short version = 0;
+    if (!cxx::read_from_stream(mPlaybackStream, signature) || (signature != ReplayFileSignature))
+        return false;
+
+    if (!cxx::read_from_stream(mPlaybackStream, version) || (version != ReplayFileVersion))
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Unsupported replay version %d", version);
+        return false;
+    }
+
+    int randomSeed = 0;
+    float physicsFramerate = 0.0f;
+    int numPlayers = 0;
+    unsigned short mapNameLength = 0;
+
+    READ_SI32(mPlaybackStream, randomSeed);
+    if (!cxx::read_from_stream(mPlaybackStream, physicsFramerate))
+        return false;
+
+    READ_I8(mPlaybackStream, numPlayers);
+    READ_I16(mPlaybackStream, mapNameLength);
+
+    std::string mapName (mapNameLength, 0);
+    if (!mPlaybackStream.read(&mapName[0], mapNameLength))
+        return false;
+
+    // override game params
+    gCvarRandomSeed.mValue = randomSeed;
+    gCvarPhysicsFramerate.mValue = physicsFramerate;
+    gCvarNumPlayers.mValue = numPlayers;
+    gCvarMapname.mValue = mapName;
+
+    gConsole.LogMessage(eLogMessage_Info, "Replay map '%s', seed %d, players %d", mapName.c_str(), randomSeed, numPlayers);
+    return true;
+}
+
+bool ReplayManager::WriteFrame()
+{
+    if (!mHeaderWritten)
+    {
+        mHeaderWritten = true;
+        if (!WriteReplayHeader())
+            return false;
+    }
+
+    debug_assert(mFrameEventsCount <= std::numeric_limits<unsigned short>::max());
+
+    cxx::write_to_stream(mRecordStream, gTimeManager.mGameFrameDelta);
+    cxx::write_to_stream(mRecordStream, (unsigned short) mFrameEventsCount);
+    if (!mFrameEventsData.empty())
+    {
+        mRecordStream.write(reinterpret_cast<const char*>(mFrameEventsData.data()), mFrameEventsData.size());
+    }
+
+    mFrameEventsData.clear();
+    mFrameEventsCount = 0;
+    ++mFramesCounter;
+    return !!mRecordStream;
+}
+
+bool ReplayManager::ReadFrame()
+{
+    float frameDelta = 0.0f;
+    if (!cxx::read_from_stream(mPlaybackStream, frameDelta))
+        return false;
+
+    int numEvents = 0;
+    READ_I16(mPlaybackStream, numEvents);
+
+    gTimeManager.SetGameFrameDelta(frameDelta);
+
+    // events are dispatched before game frame as live events would be
+    mDispatchingEvents = true;
+    for (int ievent = 0; ievent < numEvents; ++ievent)
+    {
+        if (!ReadInputEvent())
+        {
+            mDispatchingEvents = false;
+            return false;
+        }
+    }
+    mDispatchingEvents = false;
+    ++mFramesCounter;
+    return true;
+}
+
+bool ReplayManager::ReadInputEvent()
+{
+    unsigned char eventType = 0;
+    READ_I8(mPlaybackStream, eventType);
+
+    switch (eventType)
+    {
+        case eReplayInputEvent_Key:
+        {
+            KeyInputEvent inputEvent;
+            short keycode = 0;
+            READ_SI16(mPlaybackStream, keycode);
+            inputEvent.mKeycode = (eKeycode) keycode;
+            READ_SI32(mPlaybackStream, inputEvent.mScancode);
+            READ_I8(mPlaybackStream, inputEvent.mMods);
+            READ_BOOL(mPlaybackStream, inputEvent.mPressed);
+            gInputs.InputEvent(inputEvent);
+        }
+        return true;
+
+        case eReplayInputEvent_KeyChar:
+        {
+            KeyCharEvent inputEvent;
+            if (!cxx::read_from_stream(mPlaybackStream, inputEvent.mUnicodeChar))
+                return false;
+
+            gInputs.InputEvent(inputEvent);
+        }
+        return true;
+
+        case eReplayInputEvent_MouseButton:
+        {
+            MouseButtonInputEvent inputEvent;
+            unsigned char button = 0;
+            READ_I8(mPlaybackStream, button);
+            inputEvent.mButton = (eMButton) button;
+            READ_I8(mPlaybackStream, inputEvent.mMods);
+            READ_BOOL(mPlaybackStream, inputEvent.mPressed);
+            gInputs.InputEvent(inputEvent);
+        }
+        return true;
+
+        case eReplayInputEvent_MouseMoved:
+        {
+            MouseMovedInputEvent inputEvent;
+            READ_SI16(mPlaybackStream, inputEvent.mCursorPositionX);
+            READ_SI16(mPlaybackStream, inputEvent.mCursorPositionY);
+            READ_SI16(mPlaybackStream, inputEvent.mDeltaX);
+            READ_SI16(mPlaybackStream, inputEvent.mDeltaY);
+            gInputs.InputEvent(inputEvent);
+        }
+        return true;
+
+        case eReplayInputEvent_MouseScroll:
+        {
+            MouseScrollInputEvent inputEvent;
+            READ_SI16(mPlaybackStream, inputEvent.mScrollX);
+            READ_SI16(mPlaybackStream, inputEvent.mScrollY);
+            gInputs.InputEvent(inputEvent);
+        }
+        return true;
+
+        case eReplayInputEvent_Gamepad:
+        {
+            GamepadInputEvent inputEvent;
+            unsigned char button = 0;
+            READ_I8(mPlaybackStream, inputEvent.mGamepad);
+            READ_I8(mPlaybackStream, button);
+            inputEvent.mButton = (eGamepadButton) button;
+            READ_BOOL(mPlaybackStream, inputEvent.mPressed);
+            gInputs.InputEvent(inputEvent);
+        }
+        return true;
+    }
+
+    debug_assert(false);
+    return false;
+}
+
+void ReplayManager::FinishPlayback()
+{
+    gConsole.LogMessage(eLogMessage_Info, "Replay playback finished, frames played: %d", mFramesCounter);
+
+    mPlaybackStream.close();
+    mReplayMode = eReplayMode_None;
+    mPlaybackFinished = true;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "InputsDefs.h"
+
+// Records game session into binary file so it can be played back later exactly as it was,
+// replay contains game randomizer seed, game time delta of each frame and all input events
+class ReplayManager final: public cxx::noncopyable
+{
+public:
+    // Setup recording or playback depending on startup params,
+    // playback overrides game params with values stored in replay file
+    // @returns false on error
+    bool Initialize();
+
+    void Deinit();
+
+    // Write or read data of current frame, must be called after time manager frame update
+    void UpdateFrame();
+
+    // Record input event or discard live input during playback
+    // @returns false if input event should be ignored
+    bool ProcessInputEvent(const KeyInputEvent& inputEvent);
+    bool ProcessInputEvent(const KeyCharEvent& inputEvent);
+    bool ProcessInputEvent(const MouseButtonInputEvent& inputEvent);
+    bool ProcessInputEvent(const MouseMovedInputEvent& inputEvent);
+    bool ProcessInputEvent(const MouseScrollInputEvent& inputEvent);
+    bool ProcessInputEvent(const GamepadInputEvent& inputEvent);
+
+    // Current replay mode
+    bool IsRecording() const;
+    bool IsPlayback() const;
+
+    // Whether playback was started and all recorded frames were processed
+    bool IsPlaybackFinished() const;
+
+private:
+    enum eReplayMode
+    {
+        eReplayMode_None,
+        eReplayMode_Recording,
+        eReplayMode_Playback,
+    };
+
+    bool StartRecording(const std::string& fileName);
+    bool StartPlayback(const std::string& fileName);
+
+    bool WriteReplayHeader();
+    bool ReadReplayHeader();
+    bool WriteFrame();
+    bool ReadFrame();
+    bool ReadInputEvent();
+
+    void FinishPlayback();
+
+    template<typename TValue>
+    void PutEventData(const TValue& value);
+
+private:
+    eReplayMode mReplayMode = eReplayMode_None;
+
+    std::ofstream mRecordStream;
+    std::ifstream mPlaybackStream;
+
+    // input events received since last recorded frame
+    std::vector<unsigned char> mFrameEventsData;
+    int mFrameEventsCount = 0;
+
+    int mFramesCounter = 0;
+    bool mHeaderWritten = false;
+    bool mPlaybackFinished = false;
+    bool mDispatchingEvents = false;
+};
+
+extern ReplayManager gReplayManager;
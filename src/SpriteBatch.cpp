@@ -3,6 +3,10 @@
 #include "RenderingManager.h"
 #include "SpriteManager.h"
 #include "GpuTexture2D.h"
+#include "GraphicsDevice.h"
+#include "cvars.h"
+
+CvarBoolean gCvarGraphicsSpritesInstancing("r_spritesInstancing", true, "Expand map sprites to quads on gpu when supported", CvarFlags_Archive);
 
 const unsigned int NumVerticesPerSprite = 4;
 const unsigned int NumIndicesPerSprite = 6;
@@ -22,8 +26,8 @@ void SpriteBatch::Deinit()
 void SpriteBatch::Clear()
 {
     mSpritesList.clear();
-    mDrawVertices.clear();
-    mDrawIndices.clear();
+    mSortEntries.clear();
+    mSortTextures.clear();
     mBatchesList.clear();
 }
 
@@ -42,28 +46,50 @@ void SpriteBatch::Flush()
     if (!mSpritesList.empty())
     {
         SortSprites();
-        GenerateSpritesBatches();
-        RenderSpritesBatches();
+        BuildSpritesBatches();
+
+        // write sprites data directly to streaming buffer, indices are static
+        if (mInstancing)
+        {
+            unsigned int instancesLength = Sizeof_SpriteInstance3D * mSpritesList.size();
+            if (void* instanceData = mTrimeshBuffer.LockStreamVertices(instancesLength, Sizeof_SpriteInstance3D))
+            {
+                GenerateSpritesInstances(static_cast<SpriteInstance3D*>(instanceData));
+                mTrimeshBuffer.UnlockStreamVertices();
+                RenderSpritesInstancedBatches();
+            }
+            else
+            {
+                debug_assert(false);
+            }
+        }
+        else
+        {
+            unsigned int verticesLength = Sizeof_SpriteVertex3D * NumVerticesPerSprite * mSpritesList.size();
+            if (void* vertexData = mTrimeshBuffer.LockStreamVertices(verticesLength, Sizeof_SpriteVertex3D))
+            {
+                GenerateSpritesVertices(static_cast<SpriteVertex3D*>(vertexData));
+                mTrimeshBuffer.UnlockStreamVertices();
+                RenderSpritesBatches();
+            }
+            else
+            {
+                debug_assert(false);
+            }
+        }
     }
     Clear();
 }
 
-void SpriteBatch::GenerateSpritesBatches()
+bool SpriteBatch::IsInstancingEnabled() const
 {
-    int numSprites = mSpritesList.size();
-
-    int totalVertexCount = numSprites * NumVerticesPerSprite; 
-    debug_assert(totalVertexCount > 0);
-
-    int totalIndexCount = numSprites * NumIndicesPerSprite; 
-    debug_assert(totalIndexCount > 0);
-
-    // allocate memory for mesh data
-    mDrawVertices.resize(totalVertexCount);
-    SpriteVertex3D* vertexData = mDrawVertices.data();
+    return mInstancing;
+}
 
-    mDrawIndices.resize(totalIndexCount);
-    DrawIndex* indexData = mDrawIndices.data();
+void SpriteBatch::BuildSpritesBatches()
+{
+    int numSprites = mSpritesList.size();
+    debug_assert(numSprites > 0);
 
     // initial batch
     mBatchesList.clear();
@@ -73,11 +99,11 @@ void SpriteBatch::GenerateSpritesBatches()
     currentBatch->mFirstIndex = 0;
     currentBatch->mVertexCount = 0;
     currentBatch->mIndexCount = 0;
-    currentBatch->mSpriteTexture = mSpritesList[0].mTexture;
+    currentBatch->mSpriteTexture = mSpritesList[mSortEntries[0].mSpriteIndex].mTexture;
 
     for (int isprite = 0; isprite < numSprites; ++isprite)
     {
-        const Sprite2D& sprite = mSpritesList[isprite];
+        const Sprite2D& sprite = mSpritesList[mSortEntries[isprite].mSpriteIndex];
         // start new batch
         if (sprite.mTexture != currentBatch->mSpriteTexture)
         {
@@ -93,6 +119,15 @@ void SpriteBatch::GenerateSpritesBatches()
 
         currentBatch->mVertexCount += NumVerticesPerSprite;   
         currentBatch->mIndexCount += NumIndicesPerSprite;
+    }
+}
+
+void SpriteBatch::GenerateSpritesVertices(SpriteVertex3D* vertexData)
+{
+    int numSprites = mSpritesList.size();
+    for (int isprite = 0; isprite < numSprites; ++isprite)
+    {
+        const Sprite2D& sprite = mSpritesList[mSortEntries[isprite].mSpriteIndex];
 
         int vertexOffset = isprite * NumVerticesPerSprite;
 
@@ -137,23 +172,52 @@ void SpriteBatch::GenerateSpritesBatches()
                 vertexData[vertexOffset + i].mTextureSize[1] = sprite.mTexture->mSize.y;
             }
         }
+    }
+}
+
+void SpriteBatch::GenerateSpritesInstances(SpriteInstance3D* instanceData)
+{
+    int numSprites = mSpritesList.size();
+    for (int isprite = 0; isprite < numSprites; ++isprite)
+    {
+        const Sprite2D& sprite = mSpritesList[mSortEntries[isprite].mSpriteIndex];
+
+        // same corners as in Sprite2D::GetCorners, but only first corner and edges are stored
+        glm::vec2 spriteSize = sprite.GetSpriteSize();
+        glm::vec2 origin = sprite.GetOriginPoint();
+        glm::vec2 axisX (spriteSize.x, 0.0f);
+        glm::vec2 axisY (0.0f, spriteSize.y);
+
+        sprite.mRotateAngle.to_degrees_normalize_360();
+        if (sprite.mRotateAngle) // has rotation
+        {
+            float angleRadians = sprite.mRotateAngle.to_radians();
+            origin = glm::rotate(origin, angleRadians);
+            axisX = glm::rotate(axisX, angleRadians);
+            axisY = glm::rotate(axisY, angleRadians);
+        }
+        origin += sprite.mPosition;
 
-        // setup indices
-        int indexOffset = isprite * NumIndicesPerSprite;
-        indexData[indexOffset + 0] = vertexOffset + 0;
-        indexData[indexOffset + 1] = vertexOffset + 1;
-        indexData[indexOffset + 2] = vertexOffset + 2;
-        indexData[indexOffset + 3] = vertexOffset + 1;
-        indexData[indexOffset + 4] = vertexOffset + 2;
-        indexData[indexOffset + 5] = vertexOffset + 3;
+        // position needs full precision, sprite axes are short and texcoords are within [0, 1]
+        SpriteInstance3D& instance = instanceData[isprite];
+        instance.mOriginHeight = glm::vec3(origin, sprite.mHeight);
+        instance.mAxes[0] = glm::packHalf1x16(axisX.x);
+        instance.mAxes[1] = glm::packHalf1x16(axisX.y);
+        instance.mAxes[2] = glm::packHalf1x16(axisY.x);
+        instance.mAxes[3] = glm::packHalf1x16(axisY.y);
+        instance.mTexcoords[0] = glm::packUnorm1x16(sprite.mTextureRegion.mU0);
+        instance.mTexcoords[1] = glm::packUnorm1x16(sprite.mTextureRegion.mV0);
+        instance.mTexcoords[2] = glm::packUnorm1x16(sprite.mTextureRegion.mU1);
+        instance.mTexcoords[3] = glm::packUnorm1x16(sprite.mTextureRegion.mV1);
+        instance.mClutIndex = sprite.mPaletteIndex;
     }
 }
 
 void SpriteBatch::RenderSpritesBatches()
 {
     SpriteVertex3D_Format vFormat;
-    mTrimeshBuffer.SetVertices(Sizeof_SpriteVertex3D * mDrawVertices.size(), mDrawVertices.data());
-    mTrimeshBuffer.SetIndices(Sizeof_DrawIndex * mDrawIndices.size(), mDrawIndices.data());
+    // vertices of sprites are laid out sequentially, so quads pattern matches them
+    mTrimeshBuffer.SetSharedIndices(gRenderManager.GetQuadsIndexBuffer(mSpritesList.size()));
     mTrimeshBuffer.Bind(vFormat);
 
     for (const DrawSpriteBatch& currBatch: mBatchesList)
@@ -165,50 +229,217 @@ void SpriteBatch::RenderSpritesBatches()
     }
 }
 
-void SpriteBatch::BeginBatch(DepthAxis depthAxis, eSpritesSortMode sortMode)
+void SpriteBatch::RenderSpritesInstancedBatches()
+{
+    SpriteInstance3D_Format iFormat;
+    // all instances share indices of first quad
+    mTrimeshBuffer.SetSharedIndices(gRenderManager.GetQuadsIndexBuffer(1));
+
+    for (const DrawSpriteBatch& currBatch: mBatchesList)
+    {
+        // instance attributes can not be offset in draw call on gl 3.2, rebind them instead
+        iFormat.mBaseOffset = Sizeof_SpriteInstance3D * (currBatch.mFirstVertex / NumVerticesPerSprite);
+        mTrimeshBuffer.Bind(iFormat);
+
+        gGraphicsDevice.BindTexture(eTextureUnit_0, currBatch.mSpriteTexture);
+        gGraphicsDevice.RenderIndexedPrimitivesInstanced(ePrimitiveType_Triangles, eIndicesType_i32, 0, NumIndicesPerSprite, 
+            currBatch.mVertexCount / NumVerticesPerSprite);
+    }
+}
+
+void SpriteBatch::BeginBatch(DepthAxis depthAxis, eSpritesSortMode sortMode, bool enableInstancing)
 {
     Clear();
 
     mDepthAxis = depthAxis;
     mSortMode = sortMode;
+    // instanced program expands sprites on ground plane only
+    mInstancing = enableInstancing && gCvarGraphicsSpritesInstancing.mValue && (depthAxis == DepthAxis_Y) &&
+        gGraphicsDevice.mCaps.mFeatures[eGraphicsFeature_InstancedArrays] &&
+        gRenderManager.mSpritesInstancedProgram.IsProgramInited();
 }
 
 void SpriteBatch::SortSprites()
 {
+    const int numSprites = (int) mSpritesList.size();
+    mSortEntries.resize(numSprites);
+
+    // build keys: height 32 bits, draw order 8 bits, texture 24 bits,
+    // sprites with same height and draw order are grouped by texture to reduce batch breaks
+    for (int isprite = 0; isprite < numSprites; ++isprite)
+    {
+        const Sprite2D& sprite = mSpritesList[isprite];
+
+        unsigned long long sortKey = 0;
+        if (mSortMode == eSpritesSortMode_Height || mSortMode == eSpritesSortMode_HeightAndDrawOrder)
+        {
+            // order preserving float bits
+            unsigned int heightBits;
+            ::memcpy(&heightBits, &sprite.mHeight, sizeof(heightBits));
+            heightBits ^= (heightBits & 0x80000000U) ? 0xFFFFFFFFU : 0x80000000U;
+            sortKey |= ((unsigned long long) heightBits << 32);
+        }
+        if (mSortMode == eSpritesSortMode_DrawOrder || mSortMode == eSpritesSortMode_HeightAndDrawOrder)
+        {
+            sortKey |= ((unsigned long long) sprite.mDrawOrder << 24);
+        }
+        if (mSortMode != eSpritesSortMode_None)
+        {
+            sortKey |= GetTextureSortID(sprite.mTexture);
+        }
+        mSortEntries[isprite].mSortKey = sortKey;
+        mSortEntries[isprite].mSpriteIndex = isprite;
+    }
+
     if (mSortMode == eSpritesSortMode_None)
         return;
 
-    if (mSortMode == eSpritesSortMode_Height)
+    // lsd radix sort by bytes, stable so sprites with equal keys keep submission order
+    mSortEntriesTemp.resize(numSprites);
+    for (int ishift = 0; ishift < 64; ishift += 8)
     {
-        static auto SortProc = [](const Sprite2D& lhs, const Sprite2D& rhs)
+        int counters[256] = {};
+        for (const SpriteSortEntry& currEntry: mSortEntries)
         {
-            return lhs.mHeight < rhs.mHeight;
-        };
-        std::stable_sort(mSpritesList.begin(), mSpritesList.end(), SortProc);
-        return;
+            ++counters[(currEntry.mSortKey >> ishift) & 0xFF];
+        }
+
+        // skip byte that is same for all keys
+        if (counters[(mSortEntries[0].mSortKey >> ishift) & 0xFF] == numSprites)
+            continue;
+
+        int offset = 0;
+        for (int& currCounter: counters)
+        {
+            int count = currCounter;
+            currCounter = offset;
+            offset += count;
+        }
+        for (const SpriteSortEntry& currEntry: mSortEntries)
+        {
+            mSortEntriesTemp[counters[(currEntry.mSortKey >> ishift) & 0xFF]++] = currEntry;
+        }
+        mSortEntries.swap(mSortEntriesTemp);
     }
+}
 
-    if (mSortMode == eSpritesSortMode_DrawOrder)
+unsigned int SpriteBatch::GetTextureSortID(GpuTexture2D* texture)
+{
+    // there are only few distinct textures per batch
+    for (unsigned int itexture = (unsigned int) mSortTextures.size(); itexture > 0; --itexture)
     {
-        static auto SortProc = [](const Sprite2D& lhs, const Sprite2D& rhs)
-        {
-            return lhs.mDrawOrder < rhs.mDrawOrder;
-        };
-        std::stable_sort(mSpritesList.begin(), mSpritesList.end(), SortProc);
+        if (mSortTextures[itexture - 1] == texture)
+            return itexture - 1;
+    }
+    mSortTextures.push_back(texture);
+    return (unsigned int) (mSortTextures.size() - 1) & 0xFFFFFF;
+}
+
+void SpriteBatch::DebugBenchmarkSort(int numSprites)
+{
+    if (!gGraphicsDevice.IsDeviceInited())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Sprites sort benchmark requires graphics device");
         return;
     }
 
-    if (mSortMode == eSpritesSortMode_HeightAndDrawOrder)
+    numSprites = std::max(numSprites, 1);
+
+    const int NumTextures = 8;
+    GpuTexture2D* textures[NumTextures];
+    for (GpuTexture2D*& currTexture: textures)
+    {
+        currTexture = gGraphicsDevice.CreateTexture2D(eTextureFormat_R8UI, 16, 16, nullptr);
+    }
+
+    // random sprites with few distinct heights like on map layers
+    cxx::randomizer random;
+    std::vector<Sprite2D> sprites(numSprites);
+    for (Sprite2D& currSprite: sprites)
     {
-        static auto SortProc = [](const Sprite2D& lhs, const Sprite2D& rhs)
+        currSprite.mTexture = textures[random.generate_int(0, NumTextures - 1)];
+        currSprite.mTextureRegion.SetRegion(Point(16, 16));
+        currSprite.mPosition.x = random.generate_float() * 100.0f;
+        currSprite.mPosition.y = random.generate_float() * 100.0f;
+        currSprite.mHeight = Convert::MapUnitsToMeters(random.generate_int(0, 6) * 1.0f);
+        currSprite.mDrawOrder = (eSpriteDrawOrder) random.generate_int(0, eSpriteDrawOrder_Trees);
+    }
+
+    auto CountBatches = [](const std::vector<const Sprite2D*>& sortedSprites)
+    {
+        int numBatches = 1;
+        for (size_t isprite = 1; isprite < sortedSprites.size(); ++isprite)
+        {
+            if (sortedSprites[isprite]->mTexture != sortedSprites[isprite - 1]->mTexture)
+            {
+                ++numBatches;
+            }
+        }
+        return numBatches;
+    };
+
+    std::vector<const Sprite2D*> sortedSprites(numSprites);
+
+    // legacy path: comparison sort over sprite structs
+    {
+        std::vector<Sprite2D> spritesList = sprites;
+        std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+        std::stable_sort(spritesList.begin(), spritesList.end(), [](const Sprite2D& lhs, const Sprite2D& rhs)
         {
             if (lhs.mHeight != rhs.mHeight)
             {
                 return (lhs.mHeight < rhs.mHeight);
             }
             return (lhs.mDrawOrder < rhs.mDrawOrder);
-        };  
-        std::stable_sort(mSpritesList.begin(), mSpritesList.end(), SortProc);
-        return;
+        });
+        std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
+
+        for (int isprite = 0; isprite < numSprites; ++isprite)
+        {
+            sortedSprites[isprite] = &spritesList[isprite];
+        }
+        gConsole.LogMessage(eLogMessage_Info, "Sprites sort (stable sort, %d sprites): %lld us, %d batches", numSprites, 
+            std::chrono::duration_cast<std::chrono::microseconds>(timeEnd - timeStart).count(), CountBatches(sortedSprites));
+    }
+
+    // radix sort over packed keys
+    {
+        SpriteBatch spriteBatch;
+        spriteBatch.BeginBatch(DepthAxis_Y, eSpritesSortMode_HeightAndDrawOrder);
+        spriteBatch.mSpritesList = sprites;
+
+        std::vector<SpriteVertex3D> vertices(numSprites * NumVerticesPerSprite);
+        std::vector<SpriteInstance3D> instances(numSprites);
+
+        std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+        spriteBatch.SortSprites();
+        spriteBatch.BuildSpritesBatches();
+        std::chrono::steady_clock::time_point timeSorted = std::chrono::steady_clock::now();
+        spriteBatch.GenerateSpritesVertices(vertices.data());
+        std::chrono::steady_clock::time_point timeVertices = std::chrono::steady_clock::now();
+        spriteBatch.GenerateSpritesInstances(instances.data());
+        std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
+
+        for (int isprite = 0; isprite < numSprites; ++isprite)
+        {
+            sortedSprites[isprite] = &spriteBatch.mSpritesList[spriteBatch.mSortEntries[isprite].mSpriteIndex];
+        }
+        gConsole.LogMessage(eLogMessage_Info, "Sprites sort (radix sort, %d sprites): %lld us, %d batches", numSprites, 
+            std::chrono::duration_cast<std::chrono::microseconds>(timeSorted - timeStart).count(), CountBatches(sortedSprites));
+        gConsole.LogMessage(eLogMessage_Info, "Sprites generate vertices: %lld us, %u bytes", 
+            std::chrono::duration_cast<std::chrono::microseconds>(timeVertices - timeSorted).count(), 
+            (unsigned int) (Sizeof_SpriteVertex3D * vertices.size()));
+        gConsole.LogMessage(eLogMessage_Info, "Sprites generate instances: %lld us, %u bytes", 
+            std::chrono::duration_cast<std::chrono::microseconds>(timeEnd - timeVertices).count(), 
+            (unsigned int) (Sizeof_SpriteInstance3D * instances.size()));
+        spriteBatch.Clear();
+    }
+
+    for (GpuTexture2D* currTexture: textures)
+    {
+        if (currTexture)
+        {
+            gGraphicsDevice.DestroyTexture(currTexture);
+        }
     }
 }
@@ -23,7 +23,8 @@ public:
     bool Initialize();
     void Deinit();
 
-    void BeginBatch(DepthAxis depthAxis, eSpritesSortMode sortMode);
+    // @param enableInstancing: Expand sprites to quads on gpu when supported, see IsInstancingEnabled
+    void BeginBatch(DepthAxis depthAxis, eSpritesSortMode sortMode, bool enableInstancing = false);
 
     // sort and then render all sprites in current batch
     void Flush();
@@ -35,11 +36,30 @@ public:
     // @param sourceSprite: Source sprite data
     void DrawSprite(const Sprite2D& sourceSprite);
 
+    // Whether current batch expands sprites to quads on gpu, in that case caller should activate
+    // instanced sprites program instead of regular one before flush
+    bool IsInstancingEnabled() const;
+
+    // Debug: sort random sprites with legacy comparison sort and with radix sort, then generate vertices
+    // and instances for them, print timings to console
+    // @param numSprites: Number of sprites
+    static void DebugBenchmarkSort(int numSprites);
+
 private:
-    void GenerateSpritesBatches();
+    void BuildSpritesBatches();
+
+    // @param vertexData: Destination buffer for vertices of all sprites
+    void GenerateSpritesVertices(SpriteVertex3D* vertexData);
+    // @param instanceData: Destination buffer for instances of all sprites
+    void GenerateSpritesInstances(SpriteInstance3D* instanceData);
+
     void RenderSpritesBatches();
+    void RenderSpritesInstancedBatches();
     void SortSprites();
 
+    // get small identifier of sprite texture, unique within current batch
+    unsigned int GetTextureSortID(GpuTexture2D* texture);
+
 private:
     // single batch of drawing sprites
     struct DrawSpriteBatch
@@ -53,13 +73,20 @@ private:
     // all sprites stored as is until they needs to be flushed
     std::vector<Sprite2D> mSpritesList;
 
-    // draw data buffers
-    std::vector<SpriteVertex3D> mDrawVertices;
-    std::vector<DrawIndex> mDrawIndices;
+    // sprites are never moved, they are emitted in order of sorted keys instead
+    struct SpriteSortEntry
+    {
+        unsigned long long mSortKey; // height, draw order, texture
+        unsigned int mSpriteIndex;
+    };
+    std::vector<SpriteSortEntry> mSortEntries;
+    std::vector<SpriteSortEntry> mSortEntriesTemp;
+    std::vector<GpuTexture2D*> mSortTextures;
 
     std::vector<DrawSpriteBatch> mBatchesList;
     TrimeshBuffer mTrimeshBuffer;
 
     DepthAxis mDepthAxis = DepthAxis_Y;
     eSpritesSortMode mSortMode = eSpritesSortMode_None;
+    bool mInstancing = false;
 };
\ No newline at end of file
@@ -7,10 +7,15 @@
 #include "stb_rect_pack.h"
 #include "GameCheatsWindow.h"
 #include "MemoryManager.h"
+#include "cvars.h"
 
 const int ObjectsTextureSizeX = 2048;
 const int ObjectsTextureSizeY = 1024;
 const int SpritesSpacing = 4;
+const int AtlasPageSize = 1024;
+const int AtlasSlotGranularity = 8;
+
+CvarInt gCvarGraphicsSpriteCacheBudget("r_spriteCacheBudget", 2048, 1024, 65536, "Memory budget of sprites with deltas atlas, kilobytes", CvarFlags_Archive | CvarFlags_RequiresMapRestart);
 
 SpriteManager gSpriteManager;
 
@@ -46,7 +51,7 @@ bool SpriteManager::InitLevelSprites()
 void SpriteManager::Cleanup()
 {
     FlushSpritesCache();
-    DestroySpriteTextures();
+    DestroyAtlasPages();
     FreeExplosionFrames();
     mIndicesTableChanged = false;
     if (mBlocksTextureArray)
@@ -99,11 +104,16 @@ bool SpriteManager::InitObjectsSpritesheet()
     debug_assert(ObjectsTextureSizeX > 0);
     debug_assert(ObjectsTextureSizeY > 0);
 
-    mObjectsSpritesheet.mSpritesheetTexture = gGraphicsDevice.CreateTexture2D(eTextureFormat_R8UI, ObjectsTextureSizeX, ObjectsTextureSizeY, nullptr);
-    debug_assert(mObjectsSpritesheet.mSpritesheetTexture);
+    // without graphics device only sprites layout is built, it is still required by game objects
+    const bool uploadSpritesheet = gGraphicsDevice.IsDeviceInited();
+    if (uploadSpritesheet)
+    {
+        mObjectsSpritesheet.mSpritesheetTexture = gGraphicsDevice.CreateTexture2D(eTextureFormat_R8UI, ObjectsTextureSizeX, ObjectsTextureSizeY, nullptr);
+        debug_assert(mObjectsSpritesheet.mSpritesheetTexture);
 
-    if (mObjectsSpritesheet.mSpritesheetTexture == nullptr)
-        return false;
+        if (mObjectsSpritesheet.mSpritesheetTexture == nullptr)
+            return false;
+    }
 
     mObjectsSpritesheet.mEntries.resize(totalSprites);
 
@@ -149,7 +159,7 @@ bool SpriteManager::InitObjectsSpritesheet()
                 continue;
 
             ++numPacked;
-            if (!cityStyle.GetSpriteTexture(curr_rc.id, &spritesBitmap, curr_rc.x, curr_rc.y))
+            if (uploadSpritesheet && !cityStyle.GetSpriteTexture(curr_rc.id, &spritesBitmap, curr_rc.x, curr_rc.y))
             {
                 debug_assert(false);
                 return false;
@@ -173,7 +183,7 @@ bool SpriteManager::InitObjectsSpritesheet()
         }
 
         // upload to texture
-        if (!mObjectsSpritesheet.mSpritesheetTexture->Upload(spritesBitmap.mData))
+        if (uploadSpritesheet && !mObjectsSpritesheet.mSpritesheetTexture->Upload(spritesBitmap.mData))
         {
             debug_assert(false);
         }
@@ -194,6 +204,10 @@ bool SpriteManager::InitBlocksTexture()
         return true;
     }
 
+    // blocks textures are only used for rendering
+    if (!gGraphicsDevice.IsDeviceInited())
+        return true;
+
     // allocate temporary bitmap
     PixelsArray blockBitmap;
     if (!blockBitmap.Create(eTextureFormat_R8, MAP_BLOCK_TEXTURE_DIMS, MAP_BLOCK_TEXTURE_DIMS, gMemoryManager.mFrameHeapAllocator))
@@ -204,6 +218,9 @@ bool SpriteManager::InitBlocksTexture()
 
     mBlocksTextureArray = gGraphicsDevice.CreateTextureArray2D(eTextureFormat_R8UI, blockBitmap.mSizex, blockBitmap.mSizey, totalTextures, nullptr);
     debug_assert(mBlocksTextureArray);
+
+    // merged city mesh faces relies on texture repeating
+    mBlocksTextureArray->SetSamplerState(eTextureFilterMode_Nearest, eTextureWrapMode_Repeat);
     
     int currentLayerIndex = 0;
     for (int iblockType = 0; iblockType < eBlockType_COUNT; ++iblockType)
@@ -250,6 +267,9 @@ bool SpriteManager::InitBlocksIndicesTable()
         mBlocksIndices[i] = i;
     }
 
+    if (!gGraphicsDevice.IsDeviceInited())
+        return true;
+
     int textureWidth = cxx::get_next_pot(mBlocksIndices.size());
     mBlocksIndicesTable = gGraphicsDevice.CreateTexture2D(eTextureFormat_R16UI, textureWidth, 1, nullptr);
     debug_assert(mBlocksIndicesTable);
@@ -262,6 +282,9 @@ bool SpriteManager::InitBlocksIndicesTable()
 
 void SpriteManager::InitPalettesTable()
 {
+    if (!gGraphicsDevice.IsDeviceInited())
+        return;
+
     StyleData& cityStyle = gGameMap.mStyleData;
 
     int textureHeight = cxx::get_next_pot(cityStyle.mPalettes.size());
@@ -491,38 +514,50 @@ void SpriteManager::DumpSpriteDeltas(const std::string& outputLocation, int spri
 
 void SpriteManager::FlushSpritesCache()
 {
-    // move all textures to pool
-    for (SpriteCacheElement& currElement: mSpritesCache)
+    mSpritesCache.clear();
+    mReferencedSprites.clear();
+    mUnreferencedSprites.clear();
+
+    // keep page textures, just reset layout
+    for (SpriteAtlasPage& currPage: mAtlasPages)
     {
-        mFreeSpriteTextures.push_back(currElement.mTexture);
+        currPage.mShelves.clear();
+        currPage.mShelvesHeight = 0;
     }
-
-    mSpritesCache.clear();
+    mSpriteCacheStats.mEntriesCount = 0;
 }
 
 void SpriteManager::FlushSpritesCache(GameObjectID objectID)
 {
+    mReferencedSprites.erase(objectID);
+
     for (auto icurrent = mSpritesCache.begin(); icurrent != mSpritesCache.end(); )
     {
-        if (icurrent->mObjectID == objectID)
+        if (icurrent->first.mObjectID == objectID)
         {
-            // move texture to pool
-            mFreeSpriteTextures.push_back(icurrent->mTexture);
+            SpriteCacheElement& cacheElement = icurrent->second;
+            if (!cacheElement.mReferenced)
+            {
+                mUnreferencedSprites.erase(cacheElement.mLruIterator);
+            }
+            FreeAtlasSlot(cacheElement.mAtlasPage, cacheElement.mAtlasSlot);
 
             icurrent = mSpritesCache.erase(icurrent);
             continue;
         }
         ++icurrent;
     }
+    mSpriteCacheStats.mEntriesCount = (int) mSpritesCache.size();
 }
 
-void SpriteManager::DestroySpriteTextures()
+void SpriteManager::DestroyAtlasPages()
 {
-    for (GpuTexture2D* currTexture: mFreeSpriteTextures)
+    for (SpriteAtlasPage& currPage: mAtlasPages)
     {
-        gGraphicsDevice.DestroyTexture(currTexture);
+        gGraphicsDevice.DestroyTexture(currPage.mTexture);
     }
-    mFreeSpriteTextures.clear();
+    mAtlasPages.clear();
+    mSpriteCacheStats.mAtlasPagesCount = 0;
 }
 
 void SpriteManager::GetSpriteTexture(GameObjectID objectID, int spriteIndex, int remap, SpriteDeltaBits deltaBits, Sprite2D& sourceSprite)
@@ -543,91 +578,90 @@ void SpriteManager::GetSpriteTexture(GameObjectID objectID, int spriteIndex, int
     debug_assert(remap >= 0);
     sourceSprite.mPaletteIndex = gGameMap.mStyleData.GetSpritePaletteIndex(spriteStyle.mClut, remap);
 
-    if (deltaBits == 0)
+    // deltas does not affect sprite dimensions so it is enough to have spritesheet entry without graphics device
+    if (deltaBits == 0 || !gGraphicsDevice.IsDeviceInited())
     {
         GetSpriteTexture(objectID, spriteIndex, remap, sourceSprite);
         return;
     }
 
-    // find sprite with deltas within cache
-    for (SpriteCacheElement& currElement: mSpritesCache)
+    SpriteCacheKey cacheKey;
+    cacheKey.mObjectID = objectID;
+    cacheKey.mSpriteIndex = spriteIndex;
+    cacheKey.mSpriteDeltaBits = deltaBits;
+
+    auto cacheIterator = mSpritesCache.find(cacheKey);
+    if (cacheIterator != mSpritesCache.end())
     {
-        if (currElement.mObjectID == objectID && currElement.mSpriteIndex == spriteIndex)
-        {
-            if (currElement.mSpriteDeltaBits == deltaBits)
-            {
-                sourceSprite.mTexture = currElement.mTexture;
-                sourceSprite.mTextureRegion = currElement.mTextureRegion;
-                return;
-            }
-            currElement.mSpriteDeltaBits = deltaBits;
+        ++mSpriteCacheStats.mHitsCount;
+    }
+    else
+    {
+        ++mSpriteCacheStats.mMissesCount;
 
-            // upload changes
-            PixelsArray pixels;
-            if (!pixels.Create(currElement.mTexture->mFormat, 
-                currElement.mTexture->mSize.x, 
-                currElement.mTexture->mSize.y, gMemoryManager.mFrameHeapAllocator))
-            {
-                debug_assert(false);
-            }
+        // previous sprite of object is not needed anymore and can be evicted
+        ReleaseReferencedSprite(objectID);
 
-            if (!gGameMap.mStyleData.GetSpriteTexture(spriteIndex, deltaBits, &pixels, 0, 0))
-            {
-                debug_assert(false);
-            }
-            sourceSprite.mTextureRegion = currElement.mTextureRegion;
-            sourceSprite.mTexture = currElement.mTexture;
-            sourceSprite.mTexture->Upload(pixels.mData);
+        SpriteCacheElement cacheElement;
+        bool slotAllocated = AllocAtlasSlot(spriteStyle.mWidth, spriteStyle.mHeight, cacheElement.mAtlasPage, cacheElement.mAtlasSlot);
+        while (!slotAllocated && EvictUnreferencedSprite())
+        {
+            slotAllocated = AllocAtlasSlot(spriteStyle.mWidth, spriteStyle.mHeight, cacheElement.mAtlasPage, cacheElement.mAtlasSlot);
+        }
+
+        if (!slotAllocated)
+        {
+            // all atlas space is used by visible sprites, draw without deltas
+            ++mSpriteCacheStats.mFailuresCount;
+            GetSpriteTexture(objectID, spriteIndex, remap, sourceSprite);
             return;
         }
-    }
-    
-    // cache miss
-    Point dimensions;
-    dimensions.x = cxx::get_next_pot(spriteStyle.mWidth);
-    dimensions.y = cxx::get_next_pot(spriteStyle.mHeight);
 
-    sourceSprite.mTexture = GetFreeSpriteTexture(dimensions, eTextureFormat_R8UI);
-    if (sourceSprite.mTexture == nullptr)
-    {
-        debug_assert(false);
-    }
+        // rows of uploaded data must be aligned to 4 bytes, extra columns are written over slot spacing
+        PixelsArray pixels;
+        if (!pixels.Create(eTextureFormat_R8UI, (int) cxx::align_up(spriteStyle.mWidth, 4), spriteStyle.mHeight, 
+            gMemoryManager.mFrameHeapAllocator))
+        {
+            debug_assert(false);
+        }
 
-    PixelsArray pixels;
-    if (!pixels.Create(eTextureFormat_R8UI, dimensions.x, dimensions.y, 
-        gMemoryManager.mFrameHeapAllocator))
-    {
-        debug_assert(false);
-    }
+        pixels.FillWithColor(0);
 
-    pixels.FillWithCheckerBoard();
+        // combine soruce image with deltas
+        if (!gGameMap.mStyleData.GetSpriteTexture(spriteIndex, deltaBits, &pixels, 0, 0))
+        {
+            debug_assert(false);
+        }
 
-    // combine soruce image with deltas
-    if (!gGameMap.mStyleData.GetSpriteTexture(spriteIndex, deltaBits, &pixels, 0, 0))
-    {
-        debug_assert(false);
-    }
+        // upload to atlas region
+        GpuTexture2D* atlasTexture = mAtlasPages[cacheElement.mAtlasPage].mTexture;
+        atlasTexture->Upload(0, cacheElement.mAtlasSlot.x, cacheElement.mAtlasSlot.y, pixels.mSizex, pixels.mSizey, pixels.mData);
 
-    // upload to texture
-    sourceSprite.mTexture->Upload(pixels.mData);
+        Rect srcRect;
+        srcRect.x = cacheElement.mAtlasSlot.x;
+        srcRect.y = cacheElement.mAtlasSlot.y;
+        srcRect.w = spriteStyle.mWidth;
+        srcRect.h = spriteStyle.mHeight;
+        cacheElement.mTextureRegion.SetRegion(srcRect, atlasTexture->mSize);
+        cacheElement.mReferenced = true;
 
-    Rect srcRect;
-    srcRect.x = 0;
-    srcRect.y = 0;
-    srcRect.w = spriteStyle.mWidth;
-    srcRect.h = spriteStyle.mHeight;
+        cacheIterator = mSpritesCache.emplace(cacheKey, cacheElement).first;
+        mReferencedSprites[objectID] = cacheKey;
+        mSpriteCacheStats.mEntriesCount = (int) mSpritesCache.size();
+    }
 
-    sourceSprite.mTextureRegion.SetRegion(srcRect, dimensions);
+    SpriteCacheElement& cacheElement = cacheIterator->second;
+    if (!cacheElement.mReferenced)
+    {
+        ReleaseReferencedSprite(objectID);
 
-    // add to sprites cache
-    SpriteCacheElement spriteCacheElement;
-    spriteCacheElement.mObjectID = objectID;
-    spriteCacheElement.mSpriteIndex = spriteIndex;
-    spriteCacheElement.mSpriteDeltaBits = deltaBits;
-    spriteCacheElement.mTexture = sourceSprite.mTexture;
-    spriteCacheElement.mTextureRegion = sourceSprite.mTextureRegion;
+        mUnreferencedSprites.erase(cacheElement.mLruIterator);
+        cacheElement.mReferenced = true;
+        mReferencedSprites[objectID] = cacheKey;
+    }
 
-    mSpritesCache.push_back(spriteCacheElement);
+    sourceSprite.mTexture = mAtlasPages[cacheElement.mAtlasPage].mTexture;
+    sourceSprite.mTextureRegion = cacheElement.mTextureRegion;
 }
 
 void SpriteManager::GetSpriteTexture(GameObjectID objectID, int spriteIndex, int remap, Sprite2D& sourceSprite)
@@ -637,26 +671,166 @@ void SpriteManager::GetSpriteTexture(GameObjectID objectID, int spriteIndex, int
     debug_assert(spriteIndex < (int) mObjectsSpritesheet.mEntries.size());
     SpriteInfo& spriteStyle = gGameMap.mStyleData.mSprites[spriteIndex];
 
+    // object does not use sprite with deltas anymore
+    if (objectID != GAMEOBJECT_ID_NULL)
+    {
+        ReleaseReferencedSprite(objectID);
+    }
+
     sourceSprite.mPaletteIndex = gGameMap.mStyleData.GetSpritePaletteIndex(spriteStyle.mClut, remap);
     sourceSprite.mTexture = mObjectsSpritesheet.mSpritesheetTexture;
     sourceSprite.mTextureRegion = mObjectsSpritesheet.mEntries[spriteIndex];
 }
 
-GpuTexture2D* SpriteManager::GetFreeSpriteTexture(const Point& dimensions, eTextureFormat format)
+void SpriteManager::ReleaseReferencedSprite(GameObjectID objectID)
+{
+    auto referenceIterator = mReferencedSprites.find(objectID);
+    if (referenceIterator == mReferencedSprites.end())
+        return;
+
+    auto cacheIterator = mSpritesCache.find(referenceIterator->second);
+    if (cacheIterator != mSpritesCache.end())
+    {
+        SpriteCacheElement& cacheElement = cacheIterator->second;
+        debug_assert(cacheElement.mReferenced);
+        cacheElement.mReferenced = false;
+        cacheElement.mLruIterator = mUnreferencedSprites.insert(mUnreferencedSprites.begin(), cacheIterator->first);
+    }
+    mReferencedSprites.erase(referenceIterator);
+}
+
+bool SpriteManager::EvictUnreferencedSprite()
+{
+    if (mUnreferencedSprites.empty())
+        return false;
+
+    // least recently used is at back
+    auto cacheIterator = mSpritesCache.find(mUnreferencedSprites.back());
+    mUnreferencedSprites.pop_back();
+
+    debug_assert(cacheIterator != mSpritesCache.end());
+    if (cacheIterator != mSpritesCache.end())
+    {
+        FreeAtlasSlot(cacheIterator->second.mAtlasPage, cacheIterator->second.mAtlasSlot);
+        mSpritesCache.erase(cacheIterator);
+    }
+    ++mSpriteCacheStats.mEvictionsCount;
+    mSpriteCacheStats.mEntriesCount = (int) mSpritesCache.size();
+    return true;
+}
+
+bool SpriteManager::AllocAtlasSlot(int sizex, int sizey, int& pageIndex, Rect& slotRect)
+{
+    // slots sizes are rounded up so that similar sprites share shelves
+    const int slotSizex = (int) cxx::align_up(sizex + SpritesSpacing, AtlasSlotGranularity);
+    const int slotSizey = (int) cxx::align_up(sizey + SpritesSpacing, AtlasSlotGranularity);
+    if (slotSizex > AtlasPageSize || slotSizey > AtlasPageSize)
+        return false;
+
+    for (int ipage = 0; ; ++ipage)
+    {
+        if (ipage == (int) mAtlasPages.size())
+        {
+            // allocate new page within memory budget
+            const int maxPages = std::max(1, (gCvarGraphicsSpriteCacheBudget.mValue * 1024) / (AtlasPageSize * AtlasPageSize));
+            if (ipage >= maxPages)
+                return false;
+
+            SpriteAtlasPage atlasPage;
+            atlasPage.mTexture = gGraphicsDevice.CreateTexture2D(eTextureFormat_R8UI, AtlasPageSize, AtlasPageSize, nullptr);
+            debug_assert(atlasPage.mTexture);
+            if (atlasPage.mTexture == nullptr)
+                return false;
+
+            mAtlasPages.push_back(atlasPage);
+            mSpriteCacheStats.mAtlasPagesCount = (int) mAtlasPages.size();
+        }
+
+        SpriteAtlasPage& atlasPage = mAtlasPages[ipage];
+        SpriteAtlasShelf* targetShelf = nullptr;
+        for (SpriteAtlasShelf& currShelf: atlasPage.mShelves)
+        {
+            // empty shelf may be reused for slots of other width
+            if (currShelf.mSlotsUsed == 0 && currShelf.mHeight >= slotSizey && currShelf.mHeight <= slotSizey + AtlasSlotGranularity)
+            {
+                currShelf.mSlotWidth = slotSizex;
+                currShelf.mNextPosX = 0;
+                currShelf.mFreeSlots.clear();
+            }
+
+            if (currShelf.mSlotWidth != slotSizex || currShelf.mHeight < slotSizey || currShelf.mHeight > slotSizey + AtlasSlotGranularity)
+                continue;
+
+            if (!currShelf.mFreeSlots.empty() || (currShelf.mNextPosX + slotSizex <= AtlasPageSize))
+            {
+                targetShelf = &currShelf;
+                break;
+            }
+        }
+
+        if (targetShelf == nullptr && (atlasPage.mShelvesHeight + slotSizey <= AtlasPageSize))
+        {
+            SpriteAtlasShelf atlasShelf;
+            atlasShelf.mPosY = atlasPage.mShelvesHeight;
+            atlasShelf.mHeight = slotSizey;
+            atlasShelf.mSlotWidth = slotSizex;
+            atlasPage.mShelves.push_back(atlasShelf);
+            atlasPage.mShelvesHeight += slotSizey;
+            targetShelf = &atlasPage.mShelves.back();
+        }
+
+        if (targetShelf == nullptr)
+            continue;
+
+        slotRect.y = targetShelf->mPosY;
+        slotRect.w = slotSizex;
+        slotRect.h = targetShelf->mHeight;
+        if (targetShelf->mFreeSlots.empty())
+        {
+            slotRect.x = targetShelf->mNextPosX;
+            targetShelf->mNextPosX += slotSizex;
+        }
+        else
+        {
+            slotRect.x = targetShelf->mFreeSlots.back();
+            targetShelf->mFreeSlots.pop_back();
+        }
+        ++targetShelf->mSlotsUsed;
+        pageIndex = ipage;
+        return true;
+    }
+    return false;
+}
+
+void SpriteManager::FreeAtlasSlot(int pageIndex, const Rect& slotRect)
 {
-    for (auto icurr = mFreeSpriteTextures.begin(); icurr != mFreeSpriteTextures.end(); )
+    debug_assert(pageIndex < (int) mAtlasPages.size());
+
+    SpriteAtlasPage& atlasPage = mAtlasPages[pageIndex];
+    for (SpriteAtlasShelf& currShelf: atlasPage.mShelves)
     {
-        GpuTexture2D* currTexture = *icurr;
-        if (currTexture->mSize == dimensions && currTexture->mFormat == format)
+        if (currShelf.mPosY != slotRect.y)
+            continue;
+
+        debug_assert(currShelf.mSlotsUsed > 0);
+        if (--currShelf.mSlotsUsed == 0)
+        {
+            currShelf.mNextPosX = 0;
+            currShelf.mFreeSlots.clear();
+        }
+        else
         {
-            mFreeSpriteTextures.erase(icurr);
-            return currTexture;
+            currShelf.mFreeSlots.push_back(slotRect.x);
         }
-        ++icurr;
+        break;
     }
 
-    GpuTexture2D* texture = gGraphicsDevice.CreateTexture2D(format, dimensions.x, dimensions.y, nullptr);
-    return texture;
+    // return empty shelves at page end
+    while (!atlasPage.mShelves.empty() && atlasPage.mShelves.back().mSlotsUsed == 0)
+    {
+        atlasPage.mShelvesHeight -= atlasPage.mShelves.back().mHeight;
+        atlasPage.mShelves.pop_back();
+    }
 }
 
 void SpriteManager::InitExplosionFrames()
@@ -677,6 +851,17 @@ void SpriteManager::InitExplosionFrames()
     int textureSizex = sprite.mWidth * 2;
     int textureSizey = sprite.mHeight * 2;
 
+    mExplosionFrameSize.x = textureSizex;
+    mExplosionFrameSize.y = textureSizey;
+    mExplosionPaletteIndex = cityStyle.GetSpritePaletteIndex(sprite.mClut, 0);
+
+    if (!gGraphicsDevice.IsDeviceInited())
+    {
+        // frames are only used for rendering, keep count
+        mExplosionFrames.resize(framesCount, nullptr);
+        return;
+    }
+
     PixelsArray pixels;
     if (!pixels.Create(eTextureFormat_R8UI, textureSizex, textureSizey, 
         gMemoryManager.mFrameHeapAllocator))
@@ -709,15 +894,16 @@ void SpriteManager::InitExplosionFrames()
         }
         debug_assert(texture);
     }
-    
-    mExplosionPaletteIndex = cityStyle.GetSpritePaletteIndex(sprite.mClut, 0);
 }
 
 void SpriteManager::FreeExplosionFrames()
 {
     for (GpuTexture2D* currTexure: mExplosionFrames)
     {
-        gGraphicsDevice.DestroyTexture(currTexure);
+        if (currTexure)
+        {
+            gGraphicsDevice.DestroyTexture(currTexure);
+        }
     }
     mExplosionFrames.clear();
 }
@@ -729,7 +915,7 @@ bool SpriteManager::GetExplosionTexture(int frameIndex, Sprite2D& sourceSprite)
     {
         sourceSprite.mPaletteIndex = mExplosionPaletteIndex;
         sourceSprite.mTexture = mExplosionFrames[frameIndex];
-        sourceSprite.mTextureRegion.SetRegion(sourceSprite.mTexture->mSize);
+        sourceSprite.mTextureRegion.SetRegion(mExplosionFrameSize);
         return true;
     }
     return false;
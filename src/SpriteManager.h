@@ -3,6 +3,18 @@
 #include "GameDefs.h"
 #include "Sprite2D.h"
 
+// dynamic sprites cache statistics
+struct SpriteCacheStats
+{
+public:
+    int mHitsCount = 0;
+    int mMissesCount = 0;
+    int mEvictionsCount = 0;
+    int mFailuresCount = 0; // sprites drawn without deltas because atlas was full
+    int mEntriesCount = 0;
+    int mAtlasPagesCount = 0;
+};
+
 // This class implements caching mechanism for graphic resources
 
 // Since engine uses original GTA assets, cache requires styledata to be provided
@@ -22,6 +34,9 @@ public:
     // all default objects bitmaps (with no deltas applied) are stored in single 2d texture
     Spritesheet mObjectsSpritesheet;
 
+    // readonly
+    SpriteCacheStats mSpriteCacheStats;
+
 public:
     // preload sprite textures for current level
     bool InitLevelSprites();
@@ -72,9 +87,15 @@ private:
     void InitExplosionFrames();
     void FreeExplosionFrames();
 
-    // find texture with required size and format or create new if nothing found
-    GpuTexture2D* GetFreeSpriteTexture(const Point& dimensions, eTextureFormat format);
-    void DestroySpriteTextures();
+    // sprites with deltas atlas management
+    bool AllocAtlasSlot(int sizex, int sizey, int& pageIndex, Rect& slotRect);
+    void FreeAtlasSlot(int pageIndex, const Rect& slotRect);
+    void DestroyAtlasPages();
+
+    // current sprite with deltas of object becomes candidate for eviction
+    void ReleaseReferencedSprite(GameObjectID objectID);
+    // @returns false if there is nothing to evict
+    bool EvictUnreferencedSprite();
 
 private:
     // animation state for blocks sharing specific texture
@@ -88,25 +109,69 @@ private:
     std::vector<unsigned short> mBlocksIndices;
     bool mIndicesTableChanged;
 
-    // usused sprite textures
-    std::vector<GpuTexture2D*> mFreeSpriteTextures;
-
     // explosion sprite is huge and it was originally split into four pieces, 
     // so it must be assembled in one piece again before use
     std::vector<GpuTexture2D*> mExplosionFrames;
+    Point mExplosionFrameSize;
     int mExplosionPaletteIndex = 0;
 
+    // sprites with deltas are packed into dynamic atlas pages, 
+    // each page is split into shelves of equally sized slots
+    struct SpriteAtlasShelf
+    {
+    public:
+        int mPosY = 0;
+        int mHeight = 0;
+        int mSlotWidth = 0;
+        int mNextPosX = 0; // start of unused space
+        int mSlotsUsed = 0;
+        std::vector<int> mFreeSlots; // positions of released slots
+    };
+    struct SpriteAtlasPage
+    {
+    public:
+        GpuTexture2D* mTexture = nullptr;
+        std::vector<SpriteAtlasShelf> mShelves;
+        int mShelvesHeight = 0;
+    };
+    std::vector<SpriteAtlasPage> mAtlasPages;
+
     // cached sprite textures with deltas
-    struct SpriteCacheElement
+    struct SpriteCacheKey
     {
+    public:
+        inline bool operator == (const SpriteCacheKey& other) const
+        {
+            return (mObjectID == other.mObjectID) && (mSpriteIndex == other.mSpriteIndex) && 
+                (mSpriteDeltaBits == other.mSpriteDeltaBits);
+        }
     public:
         GameObjectID mObjectID; // object identifier which this sprite belongs to
         int mSpriteIndex;
         SpriteDeltaBits mSpriteDeltaBits; // all deltas applied to this sprite
-        GpuTexture2D* mTexture;
+    };
+    struct SpriteCacheKeyHash
+    {
+        inline size_t operator () (const SpriteCacheKey& cacheKey) const
+        {
+            unsigned long long keyValue = ((unsigned long long) cacheKey.mObjectID << 32) ^ 
+                ((unsigned long long) cacheKey.mSpriteIndex << 16) ^ cacheKey.mSpriteDeltaBits;
+            return (size_t) ((keyValue * 0x9E3779B97F4A7C15ULL) >> 16);
+        }
+    };
+    struct SpriteCacheElement
+    {
+    public:
+        int mAtlasPage = 0;
+        Rect mAtlasSlot;
         TextureRegion mTextureRegion;
+        // current sprite of object, referenced sprites are never evicted
+        bool mReferenced = false;
+        std::list<SpriteCacheKey>::iterator mLruIterator; // valid only if not referenced
     };
-    std::vector<SpriteCacheElement> mSpritesCache;
+    std::unordered_map<SpriteCacheKey, SpriteCacheElement, SpriteCacheKeyHash> mSpritesCache;
+    std::unordered_map<GameObjectID, SpriteCacheKey> mReferencedSprites;
+    std::list<SpriteCacheKey> mUnreferencedSprites; // most recently used first
 };
 
 extern SpriteManager gSpriteManager;
\ No newline at end of file
@@ -275,6 +275,8 @@ void StyleData::Cleanup()
     mObjects.clear();
     mSprites.clear();
     mSpriteGraphicsRaw.clear();
+    mSpriteDeltasCache.clear();
+    mSpriteDeltasCacheStats = SpriteDeltasCacheStats();
     mLidBlocksCount = 0;
     mSideBlocksCount = 0;
     mAuxBlocksCount = 0;
@@ -485,24 +487,126 @@ bool StyleData::GetSpriteTexture(int spriteIndex, PixelsArray* bitmap, int destP
 
 bool StyleData::GetSpriteTexture(int spriteIndex, SpriteDeltaBits deltas, PixelsArray* bitmap, int destPositionX, int destPositionY)
 {
-    if (!GetSpriteTexture(spriteIndex, bitmap, destPositionY, destPositionY))
+    const int NumSprites = mSprites.size();
+    if (spriteIndex < 0 || spriteIndex >= NumSprites)
+    {
+        // not an error
         return false;
+    }
 
     SpriteInfo& sprite = mSprites[spriteIndex];
-    if (deltas > 0 && sprite.mDeltaCount > 0)
+    deltas &= sprite.GetDeltaBits();
+    if (deltas == 0)
+        return GetSpriteTexture(spriteIndex, bitmap, destPositionX, destPositionY);
+
+    if (bitmap == nullptr || !bitmap->HasContent())
     {
-        for (int idelta = 0; idelta < MAX_SPRITE_DELTAS && idelta < sprite.mDeltaCount; ++idelta)
-        {
-            if ((deltas & BIT(idelta)) == 0)
-                continue;
+        debug_assert(false);
+        return false;
+    }
+
+    // color index in palette, use composited sprite
+    if (NumBytesPerPixel(bitmap->mFormat) == 1)
+    {
+        debug_assert(bitmap->mSizex >= destPositionX + sprite.mWidth);
+        debug_assert(bitmap->mSizey >= destPositionY + sprite.mHeight);
 
-            SpriteInfo::DeltaInfo& delta = sprite.mDeltas[idelta];
-            ApplySpriteDelta(sprite, delta, bitmap, destPositionX, destPositionY);
+        const std::vector<unsigned char>& spritePixels = GetSpriteDeltasBitmap(spriteIndex, deltas);
+        for (int iy = 0; iy < sprite.mHeight; ++iy)
+        {
+            unsigned char* destRow = bitmap->mData + ((destPositionY + iy) * bitmap->mSizex) + destPositionX;
+            ::memcpy(destRow, spritePixels.data() + (iy * sprite.mWidth), sprite.mWidth);
         }
+        return true;
+    }
+
+    if (!GetSpriteTexture(spriteIndex, bitmap, destPositionX, destPositionY))
+        return false;
+
+    for (int idelta = 0; idelta < MAX_SPRITE_DELTAS && idelta < sprite.mDeltaCount; ++idelta)
+    {
+        if ((deltas & BIT(idelta)) == 0)
+            continue;
+
+        SpriteInfo::DeltaInfo& delta = sprite.mDeltas[idelta];
+        ApplySpriteDelta(sprite, delta, bitmap, destPositionX, destPositionY);
     }
     return true;
 }
 
+const std::vector<unsigned char>& StyleData::GetSpriteDeltasBitmap(int spriteIndex, SpriteDeltaBits deltas)
+{
+    const unsigned long long cacheKey = ((unsigned long long) spriteIndex << 32) | deltas;
+
+    auto cacheIterator = mSpriteDeltasCache.find(cacheKey);
+    if (cacheIterator != mSpriteDeltasCache.end())
+    {
+        ++mSpriteDeltasCacheStats.mHitsCount;
+        return cacheIterator->second;
+    }
+
+    ++mSpriteDeltasCacheStats.mMissesCount;
+
+    const SpriteInfo& sprite = mSprites[spriteIndex];
+    const int spriteBytes = sprite.mWidth * sprite.mHeight;
+
+    // damage states are few per car model so overflow is rare, just start over
+    const int MaxCachedBytes = 4 * 1024 * 1024;
+    if (mSpriteDeltasCacheStats.mCachedBytes + spriteBytes > MaxCachedBytes)
+    {
+        mSpriteDeltasCache.clear();
+        mSpriteDeltasCacheStats.mCachedBytes = 0;
+        ++mSpriteDeltasCacheStats.mFlushesCount;
+    }
+
+    std::vector<unsigned char>& spritePixels = mSpriteDeltasCache[cacheKey];
+    spritePixels.resize(spriteBytes);
+    mSpriteDeltasCacheStats.mCachedBytes += spriteBytes;
+
+    // copy base sprite rows
+    const unsigned char* srcPixels = mSpriteGraphicsRaw.data() + GTA_SPRITE_PAGE_SIZE * sprite.mPageNumber;
+    for (int iy = 0; iy < sprite.mHeight; ++iy)
+    {
+        const unsigned char* srcRow = srcPixels + ((sprite.mPageOffsetY + iy) * GTA_SPRITE_PAGE_DIMS) + sprite.mPageOffsetX;
+        ::memcpy(spritePixels.data() + (iy * sprite.mWidth), srcRow, sprite.mWidth);
+    }
+
+    // delta is a sequence of pixel runs, each run lies within single row so it is copied at once
+    const int HeaderSize = 3;
+    for (int idelta = 0; idelta < MAX_SPRITE_DELTAS && idelta < sprite.mDeltaCount; ++idelta)
+    {
+        if ((deltas & BIT(idelta)) == 0)
+            continue;
+
+        const SpriteInfo::DeltaInfo& delta = sprite.mDeltas[idelta];
+        const unsigned char* srcData = mSpriteGraphicsRaw.data() + delta.mOffset;
+
+        unsigned int dstPixelOffset = 0;
+        for (int curr_pos = 0; curr_pos < delta.mSize; )
+        {
+            debug_assert(curr_pos + HeaderSize < delta.mSize);
+
+            unsigned short destination_offset = ((unsigned short) srcData[curr_pos + 0] | ((unsigned short) srcData[curr_pos + 1] << 8));
+            unsigned char source_length = srcData[curr_pos + 2];
+            curr_pos += HeaderSize;
+            debug_assert(curr_pos + source_length <= delta.mSize);
+
+            // offsets are relative to sprite page
+            dstPixelOffset += destination_offset;
+            int pagex = dstPixelOffset % GTA_SPRITE_PAGE_DIMS;
+            int pagey = dstPixelOffset / GTA_SPRITE_PAGE_DIMS;
+            debug_assert(pagey < sprite.mHeight);
+            debug_assert(pagex + source_length <= sprite.mWidth);
+
+            ::memcpy(spritePixels.data() + (pagey * sprite.mWidth) + pagex, srcData + curr_pos, source_length);
+
+            dstPixelOffset += source_length;
+            curr_pos += source_length;
+        }
+    }
+    return spritePixels;
+}
+
 void StyleData::ApplySpriteDelta(SpriteInfo& sprite, SpriteInfo::DeltaInfo& spriteDelta, PixelsArray* bitmap, int positionX, int positionY)
 {
     unsigned char* srcData = mSpriteGraphicsRaw.data() + spriteDelta.mOffset;
@@ -6,11 +6,23 @@
 
 class PixelsArray;
 
+// composited sprites with deltas cache statistics
+struct SpriteDeltasCacheStats
+{
+public:
+    int mHitsCount = 0;
+    int mMissesCount = 0;
+    int mFlushesCount = 0;
+    int mCachedBytes = 0;
+};
+
 // this class holds gta style data which get loaded from G24-files
 class StyleData final
 {
 public:
     // readonly
+    SpriteDeltasCacheStats mSpriteDeltasCacheStats;
+
     std::vector<GameObjectInfo> mObjects;
     std::vector<SpriteInfo> mSprites;
     std::vector<VehicleInfo> mVehicles;
@@ -78,7 +90,8 @@ public:
     // @param destPositionX, destPositionY: Location within destination texture where block will be placed
     bool GetSpriteTexture(int spriteIndex, PixelsArray* bitmap, int destPositionX, int destPositionY);
 
-    // Read sprite with delta delta bitmap to specific location at target texture
+    // Read sprite with delta delta bitmap to specific location at target texture,
+    // for palette indices bitmaps composited sprites are cached and shared between all callers
     // @param spriteIndex: Sprite index
     // @param deltas: All applied deltas
     // @param bitmap: Target bitmap, must be created
@@ -115,6 +128,9 @@ private:
     // apply single delta on sprite
     void ApplySpriteDelta(SpriteInfo& sprite, SpriteInfo::DeltaInfo& spriteDelta, PixelsArray* pixelsArray, int positionX, int positionY);
 
+    // Get palette indices of sprite with deltas applied, bitmap rows are sprite width long
+    const std::vector<unsigned char>& GetSpriteDeltasBitmap(int spriteIndex, SpriteDeltaBits deltas);
+
     // Reading style data internals
     // @param file: Source stream
     bool ReadBlockTextures(std::ifstream& file);
@@ -163,6 +179,9 @@ private:
     std::vector<unsigned char> mBlockTexturesRaw;
     std::vector<unsigned char> mSpriteGraphicsRaw;
 
+    // composited sprites with deltas, key is sprite index and delta bits
+    std::unordered_map<unsigned long long, std::vector<unsigned char>> mSpriteDeltasCache;
+
     // sprites animations
     SpriteAnimData mPedestrianAnimations[ePedestrianAnim_COUNT];
 
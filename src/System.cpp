@@ -3,11 +3,17 @@
 #include "GraphicsDevice.h"
 #include "RenderingManager.h"
 #include "MemoryManager.h"
+#include "JobsManager.h"
 #include "CarnageGame.h"
 #include "ImGuiManager.h"
 #include "TimeManager.h"
 #include "AudioDevice.h"
 #include "AudioManager.h"
+#include "ReplayManager.h"
+#include "FrameProfiler.h"
+#include "PhysicsManager.h"
+#include "AiManager.h"
+#include "TrafficManager.h"
 #include "cvars.h"
 
 //////////////////////////////////////////////////////////////////////////
@@ -23,13 +29,21 @@ CvarPoint gCvarGraphicsScreenDims("r_screenDims", Point(1024, 768), "Screen dime
 CvarBoolean gCvarGraphicsFullscreen("r_fullscreen", false, "Is fullscreen mode enabled", CvarFlags_Archive);
 CvarBoolean gCvarGraphicsVSync("r_vsync", true, "Is vertical synchronization enabled", CvarFlags_Archive);
 CvarBoolean gCvarGraphicsTexFiltering("r_texFiltering", false, "Is texture filtering enabled", CvarFlags_Archive | CvarFlags_Readonly);
+CvarBoolean gCvarGraphicsMergeCityMeshFaces("r_mergeCityMeshFaces", true, "Merge adjacent city mesh lids with same texture", CvarFlags_Archive);
 
 // physics
 CvarFloat gCvarPhysicsFramerate("g_physicsFps", 60.0f, "Physical world update framerate", CvarFlags_Archive | CvarFlags_Init);
+CvarBoolean gCvarPhysicsMergeMapShapes("g_physicsMergeMapShapes", true, "Merge adjacent map block columns into single collision shape", CvarFlags_Archive | CvarFlags_RequiresMapRestart);
 
 // memory
 CvarBoolean gCvarMemEnableFrameHeapAllocator("mem_enableFrameHeapAllocator", true, "Enable frame heap allocator", CvarFlags_Archive | CvarFlags_Init);
 
+// jobs
+CvarInt gCvarSysWorkerThreads("sys_workerThreads", -1, "Number of worker threads, -1 to detect automatically", CvarFlags_Archive | CvarFlags_Init);
+
+// headless
+CvarInt gCvarSysHeadlessFrames("sys_headlessFrames", 0, "Simulate specified number of frames without graphics and audio, then quit", CvarFlags_Init);
+
 // audio
 CvarBoolean gCvarAudioActive("a_audioActive", true, "Enable audio system", CvarFlags_Archive | CvarFlags_Init);
 
@@ -69,49 +83,68 @@ void System::Initialize(int argc, char *argv[])
         Terminate();
     }
 
-    if (!gGraphicsDevice.Initialize())
+    if (!gJobsManager.Initialize())
     {
-        gConsole.LogMessage(eLogMessage_Error, "Cannot initialize graphics device");
+        gConsole.LogMessage(eLogMessage_Error, "Cannot initialize jobs manager");
         Terminate();
     }
 
-    if (!gImGuiManager.Initialize())
+    if (IsHeadless())
     {
-        gConsole.LogMessage(eLogMessage_Warning, "Cannot initialize debug ui system");
-        // ignore failure
+        gConsole.LogMessage(eLogMessage_Info, "Headless mode, graphics and audio are disabled");
     }
+    else
+    {
+        if (!gGraphicsDevice.Initialize())
+        {
+            gConsole.LogMessage(eLogMessage_Error, "Cannot initialize graphics device");
+            Terminate();
+        }
 
-    if (!gRenderManager.Initialize())
-    {
-        gConsole.LogMessage(eLogMessage_Error, "Cannot initialize render system");
-        Terminate();
-    }
+        if (!gImGuiManager.Initialize())
+        {
+            gConsole.LogMessage(eLogMessage_Warning, "Cannot initialize debug ui system");
+            // ignore failure
+        }
 
-    if (gCvarAudioActive.mValue)
-    {
-        if (!gAudioDevice.Initialize())
+        if (!gRenderManager.Initialize())
         {
-            gConsole.LogMessage(eLogMessage_Warning, "Cannot initialize audio device");
+            gConsole.LogMessage(eLogMessage_Error, "Cannot initialize render system");
+            Terminate();
         }
 
-        if (!gAudioManager.Initialize())
+        if (gCvarAudioActive.mValue)
         {
-            gConsole.LogMessage(eLogMessage_Warning, "Cannot initialize audio manager");
+            if (!gAudioDevice.Initialize())
+            {
+                gConsole.LogMessage(eLogMessage_Warning, "Cannot initialize audio device");
+            }
+
+            if (!gAudioManager.Initialize())
+            {
+                gConsole.LogMessage(eLogMessage_Warning, "Cannot initialize audio manager");
+            }
+        }
+        else
+        {
+            gConsole.LogMessage(eLogMessage_Info, "Audio is disabled via config");
         }
-    }
-    else
-    {
-        gConsole.LogMessage(eLogMessage_Info, "Audio is disabled via config");
-    }
 
-    if (!gGuiManager.Initialize())
-    {
-        gConsole.LogMessage(eLogMessage_Error, "Cannot initialize gui system");
-        Terminate();
+        if (!gGuiManager.Initialize())
+        {
+            gConsole.LogMessage(eLogMessage_Error, "Cannot initialize gui system");
+            Terminate();
+        }
     }
 
     gTimeManager.Initialize();
 
+    // playback must be started before game initialization as it overrides game params
+    if (!gReplayManager.Initialize())
+    {
+        gConsole.LogMessage(eLogMessage_Warning, "Cannot initialize replay");
+    }
+
     if (!gFiles.SetupGtaDataLocation())
     {
         gConsole.LogMessage(eLogMessage_Warning, "Set valid gta gamedata location via sys config param 'g_gtadata'");
@@ -128,22 +161,28 @@ void System::Deinit(bool isTermination)
 {
     gConsole.LogMessage(eLogMessage_Info, "System shutdown");
 
-    if (!isTermination)
+    if (!isTermination && !IsHeadless())
     {
         SaveConfiguration();
     }
 
     gTimeManager.Deinit();
     gCarnageGame.Deinit();
-    gImGuiManager.Deinit();
-    gGuiManager.Deinit();
-    if (gAudioDevice.IsInitialized())
+    gReplayManager.Deinit();
+    gFrameProfiler.Deinit();
+    if (!IsHeadless())
     {
-        gAudioManager.Deinit();
-        gAudioDevice.Deinit();
+        gImGuiManager.Deinit();
+        gGuiManager.Deinit();
+        if (gAudioDevice.IsInitialized())
+        {
+            gAudioManager.Deinit();
+            gAudioDevice.Deinit();
+        }
+        gRenderManager.Deinit();
+        gGraphicsDevice.Deinit();
     }
-    gRenderManager.Deinit();
-    gGraphicsDevice.Deinit();
+    gJobsManager.Deinit();
     gMemoryManager.Deinit();
     gFiles.Deinit();
     gConsole.Deinit();
@@ -153,6 +192,13 @@ void System::Run(int argc, char *argv[])
 {
     Initialize(argc, argv);
 
+    if (IsHeadless())
+    {
+        ExecuteHeadlessFrames();
+        Deinit(false);
+        return;
+    }
+
     // main loop
 
 #ifndef __EMSCRIPTEN__
@@ -243,23 +289,48 @@ bool System::SaveConfiguration()
 
 double System::GetSystemSeconds() const
 {
+    if (IsHeadless())
+    {
+        // glfw is not initialized without graphics device
+        static const std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+    }
+
     double currentTime = ::glfwGetTime();
     return currentTime;
 }
 
+bool System::IsHeadless() const
+{
+    return gCvarSysHeadlessFrames.mValue > 0;
+}
+
 bool System::ExecuteFrame()
 {
     if (mQuitRequested)
         return false;
 
-    gInputs.UpdateFrame();
-    gTimeManager.UpdateFrame();
+    gFrameProfiler.BeginFrame();
+
+    {
+        PROFILER_SCOPE("Inputs");
+        gInputs.UpdateFrame();
+        gTimeManager.UpdateFrame();
+        gReplayManager.UpdateFrame();
+    }
     gMemoryManager.FlushFrameHeapMemory();
-    gImGuiManager.UpdateFrame();
-    gGuiManager.UpdateFrame();
-    gCarnageGame.UpdateFrame();
+    {
+        PROFILER_SCOPE("Ui");
+        gImGuiManager.UpdateFrame();
+        gGuiManager.UpdateFrame();
+    }
+    {
+        PROFILER_SCOPE("Game");
+        gCarnageGame.UpdateFrame();
+    }
     if (gAudioDevice.IsInitialized())
     {
+        PROFILER_SCOPE("Audio");
         gAudioManager.UpdateFrame();
         gAudioDevice.UpdateFrame(); // update at logic frame end
     }
@@ -294,9 +365,95 @@ bool System::ExecuteFrame()
         gCvarGraphicsVSync.ClearModified();
     }
     gRenderManager.RenderFrame();
+    gFrameProfiler.EndFrame();
     return true;
 }
 
+void System::ExecuteHeadlessFrames()
+{
+    const int numFrames = gCvarSysHeadlessFrames.mValue;
+    // fixed timestep matches physics framerate so each frame performs exactly one physics step
+    const float frameDelta = 1.0f / gCvarPhysicsFramerate.mValue;
+
+    gConsole.LogMessage(eLogMessage_Info, "Headless simulation started: %d frames, timestep %.4f", numFrames, frameDelta);
+
+    long long subsystemsTime[eGameplaySubsystem_COUNT] = {};
+
+    int numFramesDone = 0;
+    std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+    for (; numFramesDone < numFrames && !mQuitRequested; ++numFramesDone)
+    {
+        gFrameProfiler.BeginFrame();
+
+        gInputs.UpdateFrame();
+        gTimeManager.UpdateFixedFrame(frameDelta);
+        gReplayManager.UpdateFrame();
+        if (gReplayManager.IsPlaybackFinished())
+        {
+            gFrameProfiler.EndFrame();
+            break;
+        }
+
+        gMemoryManager.FlushFrameHeapMemory();
+        gCarnageGame.UpdateFrame();
+
+        gFrameProfiler.EndFrame();
+
+        if (!gCarnageGame.IsInGameState())
+            continue;
+
+        const GameplayGamestate* gameplayState = static_cast<const GameplayGamestate*>(gCarnageGame.mCurrentGamestate);
+        for (int isubsystem = 0; isubsystem < eGameplaySubsystem_COUNT; ++isubsystem)
+        {
+            subsystemsTime[isubsystem] += gameplayState->mSubsystemsFrameTime[isubsystem];
+        }
+    }
+    std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
+
+    // report
+    double elapsedSeconds = std::chrono::duration<double>(timeEnd - timeStart).count();
+    double framesPerSecond = (elapsedSeconds > 0.0) ? (numFramesDone / elapsedSeconds) : 0.0;
+    gConsole.LogMessage(eLogMessage_Info, "Headless simulation finished: %d frames in %.3f s, %.1f simulated frames per second", 
+        numFramesDone, elapsedSeconds, framesPerSecond);
+
+    if (numFramesDone > 0)
+    {
+        for (int isubsystem = 0; isubsystem < eGameplaySubsystem_COUNT; ++isubsystem)
+        {
+            gConsole.LogMessage(eLogMessage_Info, " - %s: total %.3f ms, %.3f ms per frame", 
+                cxx::enum_to_string((eGameplaySubsystem) isubsystem),
+                subsystemsTime[isubsystem] / 1000.0, 
+                subsystemsTime[isubsystem] / 1000.0 / numFramesDone);
+        }
+    }
+    gConsole.LogMessage(eLogMessage_Info, "Game objects: %d pedestrians, %d vehicles", 
+        (int) gGameObjectsManager.mPedestriansList.size(), 
+        (int) gGameObjectsManager.mVehiclesList.size());
+    gConsole.LogMessage(eLogMessage_Info, "Physics bodies: %d awake, %d sleeping", 
+        gPhysics.mPhysicsStats.mAwakeBodiesCount, 
+        gPhysics.mPhysicsStats.mSleepingBodiesCount);
+    gConsole.LogMessage(eLogMessage_Info, "Ai controllers updated on last frame: near %d/%d, mid %d/%d, far %d/%d, deferred %d", 
+        gAiManager.mAiStats.mUpdatedControllersCount[eAiLodTier_Near], gAiManager.mAiStats.mControllersCount[eAiLodTier_Near],
+        gAiManager.mAiStats.mUpdatedControllersCount[eAiLodTier_Mid], gAiManager.mAiStats.mControllersCount[eAiLodTier_Mid],
+        gAiManager.mAiStats.mUpdatedControllersCount[eAiLodTier_Far], gAiManager.mAiStats.mControllersCount[eAiLodTier_Far],
+        gAiManager.mAiStats.mDeferredControllersCount);
+
+    const TrafficStats& trafficStats = gTrafficManager.mTrafficStats;
+    gConsole.LogMessage(eLogMessage_Info, "Traffic per minute: %.1f/%.1f peds spawned/destroyed, %.1f/%.1f cars spawned/destroyed", 
+        trafficStats.GetRatePerMinute(trafficStats.mPedsSpawnedCount, gTimeManager.mGameTime),
+        trafficStats.GetRatePerMinute(trafficStats.mPedsDestroyedCount, gTimeManager.mGameTime),
+        trafficStats.GetRatePerMinute(trafficStats.mCarsSpawnedCount, gTimeManager.mGameTime),
+        trafficStats.GetRatePerMinute(trafficStats.mCarsDestroyedCount, gTimeManager.mGameTime));
+    gConsole.LogMessage(eLogMessage_Info, "Traffic density scale: %.2f, average frame time %.3f ms", 
+        trafficStats.mDensityScale, trafficStats.mAverageFrameTime / 1000.0f);
+    gConsole.LogMessage(eLogMessage_Info, "Virtual traffic: %d peds, %d cars, %d/%d peds promoted/demoted, %d/%d cars promoted/demoted", 
+        trafficStats.mVirtualPedsCount, trafficStats.mVirtualCarsCount,
+        trafficStats.mPedsPromotedCount, trafficStats.mPedsDemotedCount,
+        trafficStats.mCarsPromotedCount, trafficStats.mCarsDemotedCount);
+    gConsole.LogMessage(eLogMessage_Info, "Virtual traffic: %d peds, %d cars not demoted (dead, wrecked, burning or abandoned)", 
+        trafficStats.mPedsDemoteSkippedCount, trafficStats.mCarsDemoteSkippedCount);
+}
+
 void System::ParseStartupParams(int argc, char *argv[])
 {
     for (int iarg = 0; iarg < argc; )
@@ -331,6 +488,30 @@ void System::ParseStartupParams(int argc, char *argv[])
             iarg += 2;
             continue;
         }
+        if (cxx_stricmp(argv[iarg], "-headless") == 0 && (argc > iarg + 1))
+        {
+            gCvarSysHeadlessFrames.SetFromString(argv[iarg + 1], eCvarSetMethod_CommandLine);
+            iarg += 2;
+            continue;
+        }
+        if (cxx_stricmp(argv[iarg], "-seed") == 0 && (argc > iarg + 1))
+        {
+            gCvarRandomSeed.SetFromString(argv[iarg + 1], eCvarSetMethod_CommandLine);
+            iarg += 2;
+            continue;
+        }
+        if (cxx_stricmp(argv[iarg], "-record") == 0 && (argc > iarg + 1))
+        {
+            gCvarReplayRecord.SetFromString(argv[iarg + 1], eCvarSetMethod_CommandLine);
+            iarg += 2;
+            continue;
+        }
+        if (cxx_stricmp(argv[iarg], "-replay") == 0 && (argc > iarg + 1))
+        {
+            gCvarReplayPlayback.SetFromString(argv[iarg + 1], eCvarSetMethod_CommandLine);
+            iarg += 2;
+            continue;
+        }
         if (cxx_stricmp(argv[iarg], "-weather") == 0)
         {
             gCvarWeatherActive.SetFromString("true", eCvarSetMethod_CommandLine);
@@ -16,10 +16,14 @@ public:
     // Get real time seconds since system started
     double GetSystemSeconds() const;
 
+    // Whether game simulation is running without graphics and audio
+    bool IsHeadless() const;
+
 private:
     void Initialize(int argc, char *argv[]);
     void Deinit(bool isTermination);
     bool ExecuteFrame();
+    void ExecuteHeadlessFrames();
     void ParseStartupParams(int argc, char *argv[]);
 
     // Save/Load configuration to/from external file
@@ -33,6 +33,7 @@ bool TimeManager::Initialize()
     mGameTime = 0.0f;
     mGameFrameDelta = 0.0f;
     mGameTimeScale = 1.0f;
+    mGameFrameStartTime = 0.0f;
 
     mUiTime = 0.0f;
     mUiFrameDelta = 0.0f;
@@ -89,6 +90,7 @@ void TimeManager::UpdateFrame()
     mSystemTime += mSystemFrameDelta;
 
     mGameFrameDelta = (float) (mGameTimeScale * frameDelta);
+    mGameFrameStartTime = mGameTime;
     mGameTime += mGameFrameDelta;
     
     mUiFrameDelta = (float) (mUiTimeScale * frameDelta);
@@ -97,6 +99,29 @@ void TimeManager::UpdateFrame()
     mLastFrameTimestamp = frameTimestamp;
 }
 
+void TimeManager::UpdateFixedFrame(float frameDelta)
+{
+    debug_assert(frameDelta >= 0.0f);
+
+    mSystemFrameDelta = frameDelta;
+    mSystemTime += mSystemFrameDelta;
+
+    mGameFrameDelta = mGameTimeScale * frameDelta;
+    mGameFrameStartTime = mGameTime;
+    mGameTime += mGameFrameDelta;
+
+    mUiFrameDelta = mUiTimeScale * frameDelta;
+    mUiTime += mUiFrameDelta;
+}
+
+void TimeManager::SetGameFrameDelta(float frameDelta)
+{
+    debug_assert(frameDelta >= 0.0f);
+
+    mGameFrameDelta = frameDelta;
+    mGameTime = mGameFrameStartTime + mGameFrameDelta;
+}
+
 void TimeManager::SetGameTimeScale(float timeScale)
 {
     debug_assert(timeScale >= 0.0f);
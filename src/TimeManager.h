@@ -25,6 +25,12 @@ public:
 
     void UpdateFrame();
 
+    // Advance timers by constant delta ignoring real time, used by headless simulation
+    void UpdateFixedFrame(float frameDelta);
+
+    // Replace game time delta of current frame, used by replay playback
+    void SetGameFrameDelta(float frameDelta);
+
     // Set fps limitations
     void SetMinFramerate(float framesPerSecond);
     void SetMaxFramerate(float framesPerSecond);
@@ -37,6 +43,7 @@ private:
     double mMaxFrameDelta = 0.0f;
     double mMinFrameDelta = 0.0f;
     double mLastFrameTimestamp = 0.0f;
+    float mGameFrameStartTime = 0.0f;
 };
 
 extern TimeManager gTimeManager;
\ No newline at end of file
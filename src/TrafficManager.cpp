@@ -6,23 +6,75 @@
 #include "AiManager.h"
 #include "GameCheatsWindow.h"
 #include "AiCharacterController.h"
+#include "MapNavigation.h"
+#include "RenderingManager.h"
+#include "ReplayManager.h"
+#include "cvars.h"
+
+CvarBoolean gCvarTrafficAdaptiveDensity("g_trafficAdaptiveDensity", true, "Scale traffic density to hold target frame time", CvarFlags_Archive);
+CvarFloat gCvarTrafficTargetFrameTime("g_trafficTargetFrameTime", 12.0f, 1.0f, 100.0f, "Target simulation and render frame time for adaptive traffic density, milliseconds", CvarFlags_Archive);
+CvarFloat gCvarTrafficDensityScale("g_trafficDensityScale", 1.0f, "Current traffic density scale", CvarFlags_Readonly);
 
 TrafficManager gTrafficManager;
 
+//////////////////////////////////////////////////////////////////////////
+
+static const float MinDensityScale = 0.25f;
+static const float DensityScaleSpeed = 0.25f; // per second at full frame time error
+static const float DensityScaleTolerance = 0.1f; // frame time error that is ignored
+static const float FrameTimeSmoothing = 0.05f;
+
+//////////////////////////////////////////////////////////////////////////
+
+// heading of object moving in navigation direction: n, e, s, w
+inline float GetNavDirectionAngle(int direction)
+{
+    static const float DirectionAngles[] = { -90.0f, 0.0f, 90.0f, 180.0f };
+    return DirectionAngles[direction];
+}
+
+inline int GetNavDirectionFromAngle(cxx::angle_t heading)
+{
+    int direction = (int) std::round(heading.to_degrees_normalize_180() / 90.0f) + 1;
+    return (direction + 4) % 4;
+}
+
+inline glm::ivec3 GetMapBlockAtPosition(const glm::vec3& position)
+{
+    return glm::ivec3(
+        (int) std::floor(Convert::MetersToMapUnits(position.x)),
+        (int) std::floor(Convert::MetersToMapUnits(position.y)),
+        (int) std::floor(Convert::MetersToMapUnits(position.z)));
+}
+
+//////////////////////////////////////////////////////////////////////////
+
 TrafficManager::TrafficManager()
 {
 }
 
 void TrafficManager::StartupTraffic()
 {   
+    BuildSpawnTables();
+
+    mTrafficStats = TrafficStats();
+    mTrafficStats.mStartupTime = gTimeManager.mGameTime;
+
+    mDensityScale = 1.0f;
+    mAverageFrameTime = 0.0f;
+    UpdateDensityScale();
+
     mLastGenHareKrishnasTime = gTimeManager.mGameTime;
 
+    mStartupGeneration = true;
+
     mLastGenPedsTime = 0.0f;
     GeneratePeds();
 
     mLastGenCarsTime = 0.0f;
     GenerateCars();
 
+    mStartupGeneration = false;
 }
 
 void TrafficManager::CleanupTraffic()
@@ -36,10 +88,24 @@ void TrafficManager::CleanupTraffic()
     {
         TryRemoveTrafficPed(currPedestrian);
     }
+
+    for (std::vector<VirtualTrafficObject>& currObjects: mVirtualObjects)
+    {
+        currObjects.clear();
+    }
 }
 
 void TrafficManager::UpdateFrame()
 {
+    // map blocks modified since last frame
+    for (const Point& currColumn: gGameMap.GetChangedColumns())
+    {
+        UpdateSpawnTables(currColumn.x, currColumn.y);
+    }
+
+    UpdateDensityScale();
+    UpdateVirtualTraffic();
+
     GeneratePeds();
     GenerateCars();
 }
@@ -51,7 +117,7 @@ void TrafficManager::DebugDraw(DebugRenderer& debugRender)
 void TrafficManager::GeneratePeds()
 {
     if ((mLastGenPedsTime > 0.0f) && 
-        (mLastGenPedsTime + gGameParams.mTrafficGenPedsCooldownTime) > gTimeManager.mGameTime)
+        (mLastGenPedsTime + gGameParams.mTrafficGenPedsCooldownTime / mDensityScale) > gTimeManager.mGameTime)
     {
         return;
     }
@@ -69,9 +135,27 @@ void TrafficManager::GeneratePeds()
             continue;
 
         int generatePedsCount = GetPedsToGenerateCount(humanPlayer->mViewCamera);
-        if (generatePedsCount > 0)
+        if (generatePedsCount < 1)
+            continue;
+
+        if (mStartupGeneration || !gGameCheatsWindow.mEnableVirtualTraffic)
         {
             GenerateTrafficPeds(generatePedsCount, humanPlayer->mViewCamera);
+            continue;
+        }
+
+        // hare krishnas gang is not simulated virtually
+        if ((mLastGenHareKrishnasTime + gGameParams.mTrafficGenHareKrishnasTime) < gTimeManager.mGameTime)
+        {
+            GenerateTrafficPeds(1, humanPlayer->mViewCamera);
+        }
+
+        Rect virtualAreaRect = GetViewAreaRect(humanPlayer->mViewCamera, 
+            gGameParams.mTrafficGenPedsMaxDistance + gGameParams.mTrafficVirtualPedsDistance);
+        generatePedsCount -= CountVirtualObjects(eNavAgent_Pedestrian, virtualAreaRect);
+        if (generatePedsCount > 0)
+        {
+            GenerateVirtualTraffic(eNavAgent_Pedestrian, generatePedsCount, humanPlayer->mViewCamera);
         }
     }
 }
@@ -112,7 +196,18 @@ void TrafficManager::RemoveOffscreenPeds()
             continue;
 
         // remove ped
-        pedestrian->MarkForDeletion();
+        const bool canDemote = CanDemoteTrafficPed(pedestrian);
+        if (TryRemoveTrafficPed(pedestrian) && gGameCheatsWindow.mEnableVirtualTraffic)
+        {
+            if (canDemote)
+            {
+                DemoteTrafficPed(pedestrian);
+            }
+            else
+            {
+                ++mTrafficStats.mPedsDemoteSkippedCount;
+            }
+        }
     }
 }
 
@@ -148,37 +243,12 @@ void TrafficManager::GenerateTrafficPeds(int pedsCount, GameCamera& view)
         outerRect.h += expandSize * 2;
     }
     
-    mCandidatePosArray.clear();
-
-    for (int iy = 0; iy < outerRect.h; ++iy)
-    for (int ix = 0; ix < outerRect.w; ++ix)
-    {
-        Point pos (ix + outerRect.x, iy + outerRect.y);
-        if (innerRect.PointWithin(pos))
-            continue;
+    std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+    GatherSpawnCandidates(innerRect, outerRect, mPedsSpawnLayers);
+    std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
 
-        // scan candidate from top
-        for (int iz = (MAP_LAYERS_COUNT - 1); iz > 0; --iz)
-        {
-            const MapBlockInfo* mapBlock = gGameMap.GetBlockInfo(pos.x, pos.y, iz);
-
-            if (mapBlock->mGroundType == eGroundType_Air)
-                continue;
-
-            if (mapBlock->mGroundType == eGroundType_Pawement)
-            {
-                if (mapBlock->mIsRailway)
-                    continue;
-
-                CandidatePos candidatePos;
-                candidatePos.mMapX = pos.x;
-                candidatePos.mMapY = pos.y;
-                candidatePos.mMapLayer = iz;
-                mCandidatePosArray.push_back(candidatePos);
-            }
-            break;
-        }
-    }
+    mTrafficStats.mPedsCandidatesGatherTime = std::chrono::duration<float, std::micro>(timeEnd - timeStart).count();
+    mTrafficStats.mPedsCandidatesCount = (int) mCandidatePosArray.size();
 
     if (mCandidatePosArray.empty())
         return;
@@ -231,7 +301,7 @@ int TrafficManager::GetPedsToGenerateCount(GameCamera& view) const
         }
     }
 
-    return std::max(0, (gGameParams.mTrafficGenMaxPeds - pedestriansCounter));
+    return std::max(0, (mMaxPedsCount - pedestriansCounter));
 }
 
 int TrafficManager::CountTrafficPedestrians() const
@@ -283,13 +353,13 @@ int TrafficManager::GetCarsToGenerateCount(GameCamera& view) const
         }
     }
 
-    return std::max(0, (gGameParams.mTrafficGenMaxCars - carsCounter));
+    return std::max(0, (mMaxCarsCount - carsCounter));
 }
 
 void TrafficManager::GenerateCars()
 {
     if ((mLastGenCarsTime > 0.0f) && 
-        (mLastGenCarsTime + gGameParams.mTrafficGenCarsCooldownTime) > gTimeManager.mGameTime)
+        (mLastGenCarsTime + gGameParams.mTrafficGenCarsCooldownTime / mDensityScale) > gTimeManager.mGameTime)
     {
         return;
     }
@@ -307,9 +377,21 @@ void TrafficManager::GenerateCars()
             continue;
 
         int generateCarsCount = GetCarsToGenerateCount(humanPlayer->mViewCamera);
-        if (generateCarsCount > 0)
+        if (generateCarsCount < 1)
+            continue;
+
+        if (mStartupGeneration || !gGameCheatsWindow.mEnableVirtualTraffic)
         {
             GenerateTrafficCars(generateCarsCount, humanPlayer->mViewCamera);
+            continue;
+        }
+
+        Rect virtualAreaRect = GetViewAreaRect(humanPlayer->mViewCamera, 
+            gGameParams.mTrafficGenCarsMaxDistance + gGameParams.mTrafficVirtualCarsDistance);
+        generateCarsCount -= CountVirtualObjects(eNavAgent_Car, virtualAreaRect);
+        if (generateCarsCount > 0)
+        {
+            GenerateVirtualTraffic(eNavAgent_Car, generateCarsCount, humanPlayer->mViewCamera);
         }
     }
 }
@@ -346,42 +428,12 @@ void TrafficManager::GenerateTrafficCars(int carsCount, GameCamera& view)
         outerRect.h += expandSize * 2;
     }
     
-    mCandidatePosArray.clear();
+    std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+    GatherSpawnCandidates(innerRect, outerRect, mCarsSpawnLayers);
+    std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
 
-    for (int iy = 0; iy < outerRect.h; ++iy)
-    for (int ix = 0; ix < outerRect.w; ++ix)
-    {
-        Point pos (ix + outerRect.x, iy + outerRect.y);
-        if (innerRect.PointWithin(pos))
-            continue;
-
-        // scan candidate from top
-        for (int iz = (MAP_LAYERS_COUNT - 1); iz > 0; --iz)
-        {
-            const MapBlockInfo* mapBlock = gGameMap.GetBlockInfo(pos.x, pos.y, iz);
-
-            if (mapBlock->mGroundType == eGroundType_Air)
-                continue;
-
-            if (mapBlock->mGroundType == eGroundType_Road)
-            {
-                int bits = (int) (mapBlock->mDownDirection) + 
-                    (int) (mapBlock->mUpDirection) +
-                    (int) (mapBlock->mLeftDirection) + 
-                    (int) (mapBlock->mRightDirection);
-
-                if ((bits == 0 || bits > 1) || mapBlock->mIsRailway)
-                    continue;
-
-                CandidatePos candidatePos;
-                candidatePos.mMapX = pos.x;
-                candidatePos.mMapY = pos.y;
-                candidatePos.mMapLayer = iz;
-                mCandidatePosArray.push_back(candidatePos);
-            }
-            break;
-        }
-    }
+    mTrafficStats.mCarsCandidatesGatherTime = std::chrono::duration<float, std::micro>(timeEnd - timeStart).count();
+    mTrafficStats.mCarsCandidatesCount = (int) mCandidatePosArray.size();
 
     if (mCandidatePosArray.empty())
         return;
@@ -432,19 +484,120 @@ void TrafficManager::RemoveOffscreenCars()
         if (isOnScreen)
             continue;
 
-        TryRemoveTrafficCar(currentCar);
+        const bool canDemote = CanDemoteTrafficCar(currentCar);
+        if (TryRemoveTrafficCar(currentCar) && gGameCheatsWindow.mEnableVirtualTraffic)
+        {
+            if (canDemote)
+            {
+                DemoteTrafficCar(currentCar);
+            }
+            else
+            {
+                ++mTrafficStats.mCarsDemoteSkippedCount;
+            }
+        }
+    }
+}
+
+void TrafficManager::BuildSpawnTables()
+{
+    for (int tiley = 0; tiley < MAP_DIMENSIONS; ++tiley)
+    for (int tilex = 0; tilex < MAP_DIMENSIONS; ++tilex)
+    {
+        UpdateSpawnTables(tilex, tiley);
+    }
+}
+
+void TrafficManager::UpdateSpawnTables(int mapx, int mapy)
+{
+    debug_assert(mapx > -1 && mapx < MAP_DIMENSIONS);
+    debug_assert(mapy > -1 && mapy < MAP_DIMENSIONS);
+
+    mPedsSpawnLayers[mapy][mapx] = -1;
+    mCarsSpawnLayers[mapy][mapx] = -1;
+
+    // scan pedestrian candidate from top, air blocks above topmost layer are skipped
+    for (int iz = gGameMap.GetTopmostLayer(mapx, mapy); iz > 0; --iz)
+    {
+        eGroundType groundType = gGameMap.GetGroundType(mapx, mapy, iz);
+        if (groundType == eGroundType_Air)
+            continue;
+
+        if (groundType == eGroundType_Pawement)
+        {
+            const MapBlockInfo* mapBlock = gGameMap.GetBlockInfo(mapx, mapy, iz);
+            if (mapBlock->mIsRailway)
+                continue;
+
+            mPedsSpawnLayers[mapy][mapx] = iz;
+        }
+        break;
+    }
+
+    // scan car candidate from top
+    for (int iz = gGameMap.GetTopmostLayer(mapx, mapy); iz > 0; --iz)
+    {
+        eGroundType groundType = gGameMap.GetGroundType(mapx, mapy, iz);
+        if (groundType == eGroundType_Air)
+            continue;
+
+        if (groundType == eGroundType_Road)
+        {
+            const MapBlockInfo* mapBlock = gGameMap.GetBlockInfo(mapx, mapy, iz);
+            int bits = (int) (mapBlock->mDownDirection) + 
+                (int) (mapBlock->mUpDirection) +
+                (int) (mapBlock->mLeftDirection) + 
+                (int) (mapBlock->mRightDirection);
+
+            if ((bits == 0 || bits > 1) || mapBlock->mIsRailway)
+                continue;
+
+            mCarsSpawnLayers[mapy][mapx] = iz;
+        }
+        break;
+    }
+}
+
+void TrafficManager::GatherSpawnCandidates(const Rect& innerRect, const Rect& outerRect, const signed char spawnLayers[MAP_DIMENSIONS][MAP_DIMENSIONS])
+{
+    mCandidatePosArray.clear();
+
+    auto AddCandidates = [this, spawnLayers](int mapy, int minx, int maxx)
+    {
+        minx = std::max(minx, 0);
+        maxx = std::min(maxx, MAP_DIMENSIONS);
+        for (int mapx = minx; mapx < maxx; ++mapx)
+        {
+            int mapLayer = spawnLayers[mapy][mapx];
+            if (mapLayer < 0)
+                continue;
+
+            CandidatePos candidatePos;
+            candidatePos.mMapX = mapx;
+            candidatePos.mMapY = mapy;
+            candidatePos.mMapLayer = mapLayer;
+            mCandidatePosArray.push_back(candidatePos);
+        }
+    };
+
+    // visit columns between inner and outer rects, positions beyond map bounds are ignored
+    const int miny = std::max(outerRect.y, 0);
+    const int maxy = std::min(outerRect.y + outerRect.h, MAP_DIMENSIONS);
+    for (int mapy = miny; mapy < maxy; ++mapy)
+    {
+        if (mapy < innerRect.y || mapy >= innerRect.y + innerRect.h)
+        {
+            AddCandidates(mapy, outerRect.x, outerRect.x + outerRect.w);
+            continue;
+        }
+        AddCandidates(mapy, outerRect.x, innerRect.x);
+        AddCandidates(mapy, innerRect.x + innerRect.w, outerRect.x + outerRect.w);
     }
 }
 
 Vehicle* TrafficManager::GenerateRandomTrafficCar(int posx, int posy, int posz)
 {
     const MapBlockInfo* mapBlock = gGameMap.GetBlockInfo(posx, posz, posy);
-  
-    glm::vec3 positions(
-        Convert::MapUnitsToMeters(posx + 0.5f),
-        Convert::MapUnitsToMeters(posy * 1.0f),
-        Convert::MapUnitsToMeters(posz + 0.5f)
-    );
 
     float turnAngle = 0.0f;
     if (mapBlock->mUpDirection)
@@ -460,11 +613,16 @@ Vehicle* TrafficManager::GenerateRandomTrafficCar(int posx, int posy, int posz)
         turnAngle = 180.0f;
     }
 
-    // generate car
+    VehicleInfo* carModel = ChooseRandomTrafficCarModel();
+    if (carModel == nullptr)
+        return nullptr;
+
     cxx::angle_t carHeading(turnAngle, cxx::angle_t::units::degrees);
-    positions.y = gGameMap.GetHeightAtPosition(positions);
+    return GenerateTrafficCar(posx, posy, posz, carHeading, carModel);
+}
 
-    // choose car model
+VehicleInfo* TrafficManager::ChooseRandomTrafficCarModel() const
+{
     std::vector<VehicleInfo*> models;
     for(VehicleInfo& currModel: gGameMap.mStyleData.mVehicles)
     {
@@ -489,11 +647,28 @@ Vehicle* TrafficManager::GenerateRandomTrafficCar(int posx, int posy, int posz)
 
     // shuffle candidates
     gCarnageGame.mGameRand.shuffle(models);
+    return models.front();
+}
+
+Vehicle* TrafficManager::GenerateTrafficCar(int posx, int posy, int posz, cxx::angle_t heading, VehicleInfo* carModel)
+{
+    debug_assert(carModel);
+
+    glm::vec3 positions(
+        Convert::MapUnitsToMeters(posx + 0.5f),
+        Convert::MapUnitsToMeters(posy * 1.0f),
+        Convert::MapUnitsToMeters(posz + 0.5f)
+    );
+
+    // generate car
+    positions.y = gGameMap.GetHeightAtPosition(positions);
 
-    Vehicle* vehicle = gGameObjectsManager.CreateVehicle(positions, carHeading, models.front());
+    Vehicle* vehicle = gGameObjectsManager.CreateVehicle(positions, heading, carModel);
     debug_assert(vehicle);
     if (vehicle)
     {
+        ++mTrafficStats.mCarsSpawnedCount;
+
         vehicle->mObjectFlags = (vehicle->mObjectFlags | GameObjectFlags_Traffic);
         // todo: remap
 
@@ -508,12 +683,19 @@ Pedestrian* TrafficManager::GenerateRandomTrafficPedestrian(int posx, int posy,
 {
     cxx::randomizer& random = gCarnageGame.mGameRand;
 
+    cxx::angle_t pedestrianHeading(360.0f * random.generate_float(), cxx::angle_t::units::degrees);
+    return GenerateTrafficPedestrian(posx, posy, posz, pedestrianHeading, NO_REMAP);
+}
+
+Pedestrian* TrafficManager::GenerateTrafficPedestrian(int posx, int posy, int posz, cxx::angle_t heading, int remap)
+{
+    cxx::randomizer& random = gCarnageGame.mGameRand;
+
     // generate pedestrian
     glm::vec2 positionOffset(
         Convert::MapUnitsToMeters(random.generate_float() - 0.5f),
         Convert::MapUnitsToMeters(random.generate_float() - 0.5f)
     );
-    cxx::angle_t pedestrianHeading(360.0f * random.generate_float(), cxx::angle_t::units::degrees);
     glm::vec3 pedestrianPosition(
         Convert::MapUnitsToMeters(posx + 0.5f) + positionOffset.x,
         Convert::MapUnitsToMeters(posy * 1.0f),
@@ -522,10 +704,12 @@ Pedestrian* TrafficManager::GenerateRandomTrafficPedestrian(int posx, int posy,
     // fix height
     pedestrianPosition.y = gGameMap.GetHeightAtPosition(pedestrianPosition);
 
-    Pedestrian* pedestrian = gGameObjectsManager.CreatePedestrian(pedestrianPosition, pedestrianHeading, ePedestrianType_Civilian);
+    Pedestrian* pedestrian = gGameObjectsManager.CreatePedestrian(pedestrianPosition, heading, ePedestrianType_Civilian, remap);
     debug_assert(pedestrian);
     if (pedestrian)
     {
+        ++mTrafficStats.mPedsSpawnedCount;
+
         pedestrian->mObjectFlags = (pedestrian->mObjectFlags | GameObjectFlags_Traffic);
 
         AiCharacterController* controller = gAiManager.CreateAiController(pedestrian);
@@ -557,6 +741,7 @@ Pedestrian* TrafficManager::GenerateHareKrishnas(int posx, int posy, int posz)
     {
         Pedestrian* character = gGameObjectsManager.CreatePedestrian(pedestrianPosition, pedestrianHeading, ePedestrianType_HareKrishnasGang);
         debug_assert(character);
+        ++mTrafficStats.mPedsSpawnedCount;
 
         character->mObjectFlags = (character->mObjectFlags | GameObjectFlags_Traffic);
         AiCharacterController* controller = gAiManager.CreateAiController(character);
@@ -621,6 +806,7 @@ bool TrafficManager::TryRemoveTrafficCar(Vehicle* car)
     }
 
     car->MarkForDeletion();
+    ++mTrafficStats.mCarsDestroyedCount;
     return true;
 }
 
@@ -633,5 +819,292 @@ bool TrafficManager::TryRemoveTrafficPed(Pedestrian* pedestrian)
         return false;
         
     pedestrian->MarkForDeletion();
+    ++mTrafficStats.mPedsDestroyedCount;
     return true;
+}
+
+void TrafficManager::UpdateDensityScale()
+{
+    // frame times are not reproducible so density stays fixed while replay is recorded or played back
+    // and in headless simulation
+    const bool isReplayActive = gReplayManager.IsRecording() || gReplayManager.IsPlayback();
+    if (gCvarTrafficAdaptiveDensity.mValue && !isReplayActive && !gSystem.IsHeadless() && gCarnageGame.IsInGameState())
+    {
+        const GameplayGamestate* gameplayState = static_cast<const GameplayGamestate*>(gCarnageGame.mCurrentGamestate);
+
+        // last measured times of game systems and rendering, traffic time of current frame is not known yet
+        long long frameTime = gRenderManager.mRenderFrameTime;
+        for (long long currSubsystemTime: gameplayState->mSubsystemsFrameTime)
+        {
+            frameTime += currSubsystemTime;
+        }
+
+        mAverageFrameTime = (mAverageFrameTime > 0.0f) ? 
+            glm::mix(mAverageFrameTime, (float) frameTime, FrameTimeSmoothing) : (float) frameTime;
+
+        const float targetFrameTime = gCvarTrafficTargetFrameTime.mValue * 1000.0f;
+        const float frameTimeError = glm::clamp((targetFrameTime - mAverageFrameTime) / targetFrameTime, -1.0f, 1.0f);
+        if (fabs(frameTimeError) > DensityScaleTolerance)
+        {
+            mDensityScale += frameTimeError * DensityScaleSpeed * gTimeManager.mGameFrameDelta;
+            mDensityScale = glm::clamp(mDensityScale, MinDensityScale, 1.0f);
+        }
+    }
+    else
+    {
+        mDensityScale = 1.0f;
+    }
+
+    gCvarTrafficDensityScale.mValue = mDensityScale;
+
+    mMaxPedsCount = (int) std::round(gGameParams.mTrafficGenMaxPeds * mDensityScale);
+    mMaxCarsCount = (int) std::round(gGameParams.mTrafficGenMaxCars * mDensityScale);
+
+    mTrafficStats.mAverageFrameTime = mAverageFrameTime;
+    mTrafficStats.mDensityScale = mDensityScale;
+    mTrafficStats.mMaxPedsCount = mMaxPedsCount;
+    mTrafficStats.mMaxCarsCount = mMaxCarsCount;
+}
+
+void TrafficManager::UpdateVirtualTraffic()
+{
+    if (!gGameCheatsWindow.mEnableVirtualTraffic)
+    {
+        for (std::vector<VirtualTrafficObject>& currObjects: mVirtualObjects)
+        {
+            currObjects.clear();
+        }
+    }
+
+    std::chrono::steady_clock::time_point timeStart = std::chrono::steady_clock::now();
+
+    float deltaTime = gTimeManager.mGameFrameDelta;
+    UpdateVirtualObjects(eNavAgent_Pedestrian, 
+        Convert::MetersToMapUnits(gGameParams.mPedestrianWalkSpeed * deltaTime),
+        gGameParams.mTrafficGenPedsMaxDistance + gGameParams.mTrafficVirtualPedsDistance,
+        gGameParams.mTrafficGenPedsMaxDistance);
+    UpdateVirtualObjects(eNavAgent_Car, 
+        Convert::MetersToMapUnits(gGameParams.mTrafficVirtualCarsSpeed * deltaTime),
+        gGameParams.mTrafficGenCarsMaxDistance + gGameParams.mTrafficVirtualCarsDistance,
+        gGameParams.mTrafficGenCarsMaxDistance);
+
+    std::chrono::steady_clock::time_point timeEnd = std::chrono::steady_clock::now();
+
+    mTrafficStats.mVirtualUpdateTime = std::chrono::duration<float, std::micro>(timeEnd - timeStart).count();
+    mTrafficStats.mVirtualPedsCount = (int) mVirtualObjects[eNavAgent_Pedestrian].size();
+    mTrafficStats.mVirtualCarsCount = (int) mVirtualObjects[eNavAgent_Car].size();
+}
+
+void TrafficManager::UpdateVirtualObjects(eNavAgent agent, float moveDistance, int keepDistance, int promoteDistance)
+{
+    cxx::randomizer& random = gCarnageGame.mGameRand;
+
+    const bool promoteEnabled = (agent == eNavAgent_Car) ? 
+        gGameCheatsWindow.mEnableTrafficCarsGeneration : 
+        gGameCheatsWindow.mEnableTrafficPedsGeneration;
+
+    std::vector<VirtualTrafficObject>& virtualObjects = mVirtualObjects[agent];
+    for (size_t iobject = 0; iobject < virtualObjects.size();)
+    {
+        VirtualTrafficObject& virtualObject = virtualObjects[iobject];
+
+        // move along navigation graph, object disappears in dead end
+        bool keepObject = true;
+        for (virtualObject.mBlockProgress += moveDistance; keepObject && (virtualObject.mBlockProgress >= 1.0f); 
+            virtualObject.mBlockProgress -= 1.0f)
+        {
+            keepObject = gMapNavigation.StepWander(agent, virtualObject.mMapBlock, virtualObject.mDirection, random);
+        }
+
+        // objects must not pop up on screen, those that came into view stay virtual until they leave it
+        if (keepObject && promoteEnabled && IsInsideAnyView(virtualObject.mMapBlock, promoteDistance) && 
+            !IsInsideAnyView(virtualObject.mMapBlock, 0))
+        {
+            // promote to full game object
+            cxx::angle_t heading(GetNavDirectionAngle(virtualObject.mDirection), cxx::angle_t::units::degrees);
+            const glm::ivec3& mapBlock = virtualObject.mMapBlock;
+            if (agent == eNavAgent_Car)
+            {
+                if (GenerateTrafficCar(mapBlock.x, mapBlock.y, mapBlock.z, heading, virtualObject.mCarModel))
+                {
+                    ++mTrafficStats.mCarsPromotedCount;
+                }
+            }
+            else
+            {
+                if (GenerateTrafficPedestrian(mapBlock.x, mapBlock.y, mapBlock.z, heading, virtualObject.mRemapIndex))
+                {
+                    ++mTrafficStats.mPedsPromotedCount;
+                }
+            }
+            keepObject = false;
+        }
+        else if (keepObject)
+        {
+            keepObject = IsInsideAnyView(virtualObject.mMapBlock, keepDistance);
+        }
+
+        if (keepObject)
+        {
+            ++iobject;
+            continue;
+        }
+        virtualObjects[iobject] = virtualObjects.back();
+        virtualObjects.pop_back();
+    }
+}
+
+void TrafficManager::DemoteTrafficPed(Pedestrian* pedestrian)
+{
+    // hare krishnas gang is not simulated virtually
+    if (pedestrian->mPedestrianTypeID != ePedestrianType_Civilian)
+        return;
+
+    VirtualTrafficObject virtualObject;
+    virtualObject.mMapBlock = GetMapBlockAtPosition(pedestrian->mTransform.mPosition);
+    virtualObject.mDirection = GetNavDirectionFromAngle(pedestrian->mTransform.mOrientation);
+    virtualObject.mRemapIndex = pedestrian->mRemapIndex;
+
+    if (!gMapNavigation.IsNavigable(eNavAgent_Pedestrian, virtualObject.mMapBlock.x, virtualObject.mMapBlock.z))
+        return;
+
+    if (!IsInsideAnyView(virtualObject.mMapBlock, gGameParams.mTrafficGenPedsMaxDistance + gGameParams.mTrafficVirtualPedsDistance))
+        return;
+
+    mVirtualObjects[eNavAgent_Pedestrian].push_back(virtualObject);
+    ++mTrafficStats.mPedsDemotedCount;
+}
+
+bool TrafficManager::CanDemoteTrafficPed(Pedestrian* pedestrian) const
+{
+    if (pedestrian->IsMarkedForDeletion())
+        return false;
+
+    return !pedestrian->IsDead() && !pedestrian->IsDies() && !pedestrian->IsBurn();
+}
+
+bool TrafficManager::CanDemoteTrafficCar(Vehicle* car) const
+{
+    if (car->IsMarkedForDeletion() || car->IsWrecked() || car->IsBurn())
+        return false;
+
+    // virtual car is promoted along with new traffic driver, abandoned cars stay where they are
+    Pedestrian* carDriver = car->GetCarDriver();
+    return carDriver && carDriver->IsTrafficFlag() && !carDriver->IsDead();
+}
+
+void TrafficManager::DemoteTrafficCar(Vehicle* car)
+{
+    VirtualTrafficObject virtualObject;
+    virtualObject.mMapBlock = GetMapBlockAtPosition(car->mTransform.mPosition);
+    virtualObject.mDirection = GetNavDirectionFromAngle(car->mTransform.mOrientation);
+    virtualObject.mCarModel = car->mCarInfo;
+
+    if (!gMapNavigation.IsNavigable(eNavAgent_Car, virtualObject.mMapBlock.x, virtualObject.mMapBlock.z))
+        return;
+
+    if (!IsInsideAnyView(virtualObject.mMapBlock, gGameParams.mTrafficGenCarsMaxDistance + gGameParams.mTrafficVirtualCarsDistance))
+        return;
+
+    mVirtualObjects[eNavAgent_Car].push_back(virtualObject);
+    ++mTrafficStats.mCarsDemotedCount;
+}
+
+void TrafficManager::GenerateVirtualTraffic(eNavAgent agent, int objectsCount, GameCamera& view)
+{
+    cxx::randomizer& random = gCarnageGame.mGameRand;
+
+    // new objects appear beyond generation area and get promoted once they approach the view
+    Rect innerRect;
+    Rect outerRect;
+    if (agent == eNavAgent_Car)
+    {
+        innerRect = GetViewAreaRect(view, gGameParams.mTrafficGenCarsMaxDistance + 1);
+        outerRect = GetViewAreaRect(view, gGameParams.mTrafficGenCarsMaxDistance + gGameParams.mTrafficVirtualCarsDistance);
+        GatherSpawnCandidates(innerRect, outerRect, mCarsSpawnLayers);
+    }
+    else
+    {
+        innerRect = GetViewAreaRect(view, gGameParams.mTrafficGenPedsMaxDistance + 1);
+        outerRect = GetViewAreaRect(view, gGameParams.mTrafficGenPedsMaxDistance + gGameParams.mTrafficVirtualPedsDistance);
+        GatherSpawnCandidates(innerRect, outerRect, mPedsSpawnLayers);
+    }
+
+    if (mCandidatePosArray.empty())
+        return;
+
+    // shuffle candidates
+    random.shuffle(mCandidatePosArray);
+
+    const int generationChance = (agent == eNavAgent_Car) ? gGameParams.mTrafficGenCarsChance : gGameParams.mTrafficGenPedsChance;
+    for (int numGenerated = 0; (numGenerated < objectsCount) && !mCandidatePosArray.empty(); ++numGenerated)
+    {
+        if (!random.random_chance(generationChance))
+            continue;
+
+        CandidatePos candidate = mCandidatePosArray.back();
+        mCandidatePosArray.pop_back();
+
+        VirtualTrafficObject virtualObject;
+        virtualObject.mMapBlock = glm::ivec3(candidate.mMapX, candidate.mMapLayer, candidate.mMapY);
+        virtualObject.mDirection = random.generate_int(0, 3);
+        if (agent == eNavAgent_Car)
+        {
+            const MapBlockInfo* mapBlock = gGameMap.GetBlockInfo(candidate.mMapX, candidate.mMapY, candidate.mMapLayer);
+            if (mapBlock->mUpDirection) virtualObject.mDirection = 0;
+            if (mapBlock->mRightDirection) virtualObject.mDirection = 1;
+            if (mapBlock->mDownDirection) virtualObject.mDirection = 2;
+            if (mapBlock->mLeftDirection) virtualObject.mDirection = 3;
+
+            virtualObject.mCarModel = ChooseRandomTrafficCarModel();
+            if (virtualObject.mCarModel == nullptr)
+                return;
+        }
+        mVirtualObjects[agent].push_back(virtualObject);
+    }
+}
+
+int TrafficManager::CountVirtualObjects(eNavAgent agent, const Rect& areaRect) const
+{
+    int counter = 0;
+    for (const VirtualTrafficObject& virtualObject: mVirtualObjects[agent])
+    {
+        if (areaRect.PointWithin(Point(virtualObject.mMapBlock.x, virtualObject.mMapBlock.z)))
+        {
+            ++counter;
+        }
+    }
+    return counter;
+}
+
+Rect TrafficManager::GetViewAreaRect(GameCamera& view, int expandSize) const
+{
+    Point minBlock;
+    minBlock.x = (int) Convert::MetersToMapUnits(view.mOnScreenMapArea.mMin.x);
+    minBlock.y = (int) Convert::MetersToMapUnits(view.mOnScreenMapArea.mMin.y);
+
+    Point maxBlock;
+    maxBlock.x = (int) Convert::MetersToMapUnits(view.mOnScreenMapArea.mMax.x) + 1;
+    maxBlock.y = (int) Convert::MetersToMapUnits(view.mOnScreenMapArea.mMax.y) + 1;
+
+    Rect areaRect;
+    areaRect.x = minBlock.x - expandSize;
+    areaRect.y = minBlock.y - expandSize;
+    areaRect.w = (maxBlock.x - minBlock.x) + expandSize * 2;
+    areaRect.h = (maxBlock.y - minBlock.y) + expandSize * 2;
+    return areaRect;
+}
+
+bool TrafficManager::IsInsideAnyView(const glm::ivec3& mapBlock, int expandSize) const
+{
+    for (HumanPlayer* humanPlayer: gCarnageGame.mHumanPlayers)
+    {   
+        if (humanPlayer == nullptr)
+            continue;
+
+        Rect areaRect = GetViewAreaRect(humanPlayer->mViewCamera, expandSize);
+        if (areaRect.PointWithin(Point(mapBlock.x, mapBlock.z)))
+            return true;
+    }
+    return false;
 }
\ No newline at end of file
@@ -1,12 +1,70 @@
 #pragma once
 
+#include "MapNavigation.h"
+
 class DebugRenderer;
 
-// This class generates randomly wander pedestrians and vehicles on currently visible area on map
+// traffic generation statistics info
+struct TrafficStats
+{
+public:
+    TrafficStats() = default;
+
+public:
+    // last generation tick
+    float mPedsCandidatesGatherTime = 0.0f; // microseconds
+    float mCarsCandidatesGatherTime = 0.0f; // microseconds
+    int mPedsCandidatesCount = 0;
+    int mCarsCandidatesCount = 0;
+
+    // full game objects churn since traffic startup
+    int mPedsSpawnedCount = 0;
+    int mPedsDestroyedCount = 0;
+    int mCarsSpawnedCount = 0;
+    int mCarsDestroyedCount = 0;
+    // transitions between virtual and full game objects since traffic startup
+    int mPedsPromotedCount = 0;
+    int mPedsDemotedCount = 0;
+    int mCarsPromotedCount = 0;
+    int mCarsDemotedCount = 0;
+    int mPedsDemoteSkippedCount = 0; // dead or dying, not simulated virtually
+    int mCarsDemoteSkippedCount = 0; // wrecked, burning or without traffic driver
+    float mStartupTime = 0.0f; // game time, seconds
+
+    int mVirtualPedsCount = 0;
+    int mVirtualCarsCount = 0;
+    float mVirtualUpdateTime = 0.0f; // microseconds
+
+    // adaptive density
+    float mAverageFrameTime = 0.0f; // simulation and render, microseconds
+    float mDensityScale = 1.0f;
+    int mMaxPedsCount = 0; // scaled limits
+    int mMaxCarsCount = 0;
+
+public:
+    // Get average number of events per minute since traffic startup
+    // @param eventsCount: Counter value
+    // @param currentTime: Game time, seconds
+    inline float GetRatePerMinute(int eventsCount, float currentTime) const
+    {
+        float elapsedMinutes = (currentTime - mStartupTime) / 60.0f;
+        if (elapsedMinutes < 0.001f)
+            return 0.0f;
+
+        return eventsCount / elapsedMinutes;
+    }
+};
+
+// This class generates randomly wander pedestrians and vehicles on currently visible area on map,
+// traffic that leaves visible area is kept as lightweight virtual objects moving along map navigation graph
+// and gets promoted back to full game objects when it approaches any view
 class TrafficManager final: public cxx::noncopyable
 {
     friend class GameCheatsWindow;
 
+public:
+    TrafficStats mTrafficStats;
+
 public:
     TrafficManager();
 
@@ -38,15 +96,45 @@ private:
     Pedestrian* GenerateRandomTrafficPedestrian(int posx, int posy, int posz);
     Pedestrian* GenerateHareKrishnas(int posx, int posy, int posz);
     Vehicle* GenerateRandomTrafficCar(int posx, int posy, int posz);
+    Pedestrian* GenerateTrafficPedestrian(int posx, int posy, int posz, cxx::angle_t heading, int remap);
+    Vehicle* GenerateTrafficCar(int posx, int posy, int posz, cxx::angle_t heading, VehicleInfo* carModel);
+    VehicleInfo* ChooseRandomTrafficCarModel() const;
+
+    // spawn candidates are precomputed for each map column
+    void BuildSpawnTables();
+    void UpdateSpawnTables(int mapx, int mapy);
+    void GatherSpawnCandidates(const Rect& innerRect, const Rect& outerRect, const signed char spawnLayers[MAP_DIMENSIONS][MAP_DIMENSIONS]);
 
     // attempt to remove traffic pedestrian or vehicle
     bool TryRemoveTrafficPed(Pedestrian* ped);
     bool TryRemoveTrafficCar(Vehicle* car);
 
+    // scale traffic limits and generation rates to hold target frame time
+    void UpdateDensityScale();
+
+    // virtual traffic
+    void UpdateVirtualTraffic();
+    void UpdateVirtualObjects(eNavAgent agent, float moveDistance, int keepDistance, int promoteDistance);
+    void DemoteTrafficPed(Pedestrian* pedestrian);
+    void DemoteTrafficCar(Vehicle* car);
+    // only intact objects can be promoted back later, must be checked before removal
+    bool CanDemoteTrafficPed(Pedestrian* pedestrian) const;
+    bool CanDemoteTrafficCar(Vehicle* car) const;
+    void GenerateVirtualTraffic(eNavAgent agent, int objectsCount, GameCamera& view);
+    int CountVirtualObjects(eNavAgent agent, const Rect& areaRect) const;
+    Rect GetViewAreaRect(GameCamera& view, int expandSize) const;
+    bool IsInsideAnyView(const glm::ivec3& mapBlock, int expandSize) const;
+
 private:
     float mLastGenPedsTime = 0.0;
     float mLastGenCarsTime = 0.0f;
     float mLastGenHareKrishnasTime = 0.0f;
+    bool mStartupGeneration = false; // fill view areas with full game objects right away
+
+    float mDensityScale = 1.0f;
+    float mAverageFrameTime = 0.0f; // microseconds
+    int mMaxPedsCount = 0; // generation limits scaled by density
+    int mMaxCarsCount = 0;
 
     // buffers
     struct CandidatePos
@@ -56,6 +144,21 @@ private:
         int mMapLayer;
     };
     std::vector<CandidatePos> mCandidatePosArray;
+
+    // offscreen traffic object simulated without physics
+    struct VirtualTrafficObject
+    {
+        glm::ivec3 mMapBlock; // x, layer, z
+        int mDirection = 0; // navigation direction index: n, e, s, w
+        float mBlockProgress = 0.0f; // distance travelled towards next block, map units
+        VehicleInfo* mCarModel = nullptr; // cars only
+        int mRemapIndex = NO_REMAP;
+    };
+    std::vector<VirtualTrafficObject> mVirtualObjects[eNavAgent_COUNT];
+
+    // spawn layer for each map column or -1 if column is not suitable
+    signed char mPedsSpawnLayers[MAP_DIMENSIONS][MAP_DIMENSIONS]; // y, x
+    signed char mCarsSpawnLayers[MAP_DIMENSIONS][MAP_DIMENSIONS]; // y, x
 };
 
 extern TrafficManager gTrafficManager;
\ No newline at end of file
@@ -10,6 +10,7 @@ TrimeshBuffer::~TrimeshBuffer()
 
 void TrimeshBuffer::SetVertices(unsigned int dataLength, const void* dataSource)
 {
+    mVerticesOffset = 0;
     if (mVertexBuffer == nullptr)
     {
         mVertexBuffer = gGraphicsDevice.CreateBuffer(eBufferContent_Vertices, eBufferUsage_Stream, dataLength, dataSource);
@@ -44,12 +45,45 @@ void TrimeshBuffer::Bind(const VertexFormat& vertexFormat)
     if (mVertexBuffer == nullptr)
         return;
 
-    gGraphicsDevice.BindVertexBuffer(mVertexBuffer, vertexFormat);
-    gGraphicsDevice.BindIndexBuffer(mIndexBuffer);
+    VertexFormat streamVertexFormat = vertexFormat;
+    streamVertexFormat.mBaseOffset += mVerticesOffset;
+
+    gGraphicsDevice.BindVertexBuffer(mVertexBuffer, streamVertexFormat);
+    gGraphicsDevice.BindIndexBuffer(mSharedIndexBuffer ? mSharedIndexBuffer : mIndexBuffer);
+}
+
+void* TrimeshBuffer::LockStreamVertices(unsigned int dataLength, unsigned int vertexSize)
+{
+    const unsigned int MinStreamBufferLength = 256 * 1024;
+
+    if (mVertexBuffer == nullptr)
+    {
+        mVertexBuffer = gGraphicsDevice.CreateBuffer(eBufferContent_Vertices, eBufferUsage_Stream, std::max(dataLength, MinStreamBufferLength), nullptr);
+        debug_assert(mVertexBuffer);
+        if (mVertexBuffer == nullptr)
+            return nullptr;
+    }
+    return mVertexBuffer->LockStream(dataLength, vertexSize, mVerticesOffset);
+}
+
+void TrimeshBuffer::UnlockStreamVertices()
+{
+    debug_assert(mVertexBuffer);
+    if (mVertexBuffer && !mVertexBuffer->Unlock())
+    {
+        debug_assert(false);
+    }
+}
+
+void TrimeshBuffer::SetSharedIndices(GpuBuffer* indexBuffer)
+{
+    mSharedIndexBuffer = indexBuffer;
 }
 
 void TrimeshBuffer::Deinit()
 {
+    mSharedIndexBuffer = nullptr;
+    mVerticesOffset = 0;
     if (mIndexBuffer)
     {
         gGraphicsDevice.DestroyBuffer(mIndexBuffer);
@@ -11,7 +11,21 @@ public:
     void Bind(const VertexFormat& vertexFormat);
     void Deinit();
 
+    // Streaming mode, vertices are written directly to ring buffer without intermediate copies,
+    // bound vertex format gets shifted to start of written data
+    // @param dataLength: Size of vertices data in bytes
+    // @param vertexSize: Size of single vertex in bytes
+    // @returns pointer to vertices data or null on fail
+    void* LockStreamVertices(unsigned int dataLength, unsigned int vertexSize);
+    void UnlockStreamVertices();
+
+    // Use index buffer owned by someone else instead of own one
+    // @param indexBuffer: Shared index buffer or null to use own indices
+    void SetSharedIndices(GpuBuffer* indexBuffer);
+
 public:
     GpuBuffer* mVertexBuffer = nullptr;
     GpuBuffer* mIndexBuffer = nullptr;
+    GpuBuffer* mSharedIndexBuffer = nullptr;
+    unsigned int mVerticesOffset = 0; // bytes
 };
\ No newline at end of file
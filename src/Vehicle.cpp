@@ -608,6 +608,9 @@ bool Vehicle::ReceiveDamage(const DamageInfo& damageInfo)
     if (IsWrecked())
         return false;
 
+    // resting car may be pushed or start burning
+    mPhysicsBody->SetAwake(true);
+
     if (damageInfo.mDamageCause == eDamageCause_Electricity)
     {
         if (CanResistElectricity())
@@ -113,4 +113,50 @@ public:
         this->SetAttribute(eVertexAttribute_Color0, eVertexAttributeFormat_1US, offsetof(TVertexType, mClutIndex));
         this->SetAttribute(eVertexAttribute_TextureSize, eVertexAttributeFormat_2US, offsetof(TVertexType, mTextureSize));
     }
+};
+
+// defines single sprite instance, expanded to quad in vertex shader
+struct SpriteInstance3D
+{
+public:
+    SpriteInstance3D() = default;
+public:
+    glm::vec3 mOriginHeight; // first corner position on ground plane and depth, 12 bytes
+    unsigned short mAxes[4]; // width and height axes on ground plane, half floats, 8 bytes
+    unsigned short mTexcoords[4]; // u0, v0, u1, v1, normalized, 8 bytes
+    unsigned short mClutIndex; // 2 bytes
+};
+
+const unsigned int Sizeof_SpriteInstance3D = sizeof(SpriteInstance3D);
+
+// defines draw instance format of sprite
+struct SpriteInstance3D_Format: public VertexFormat
+{
+public:
+    SpriteInstance3D_Format()
+    {
+        Setup();
+    }
+    // get format definition
+    static const SpriteInstance3D_Format& Get() 
+    { 
+        static const SpriteInstance3D_Format sDefinition; 
+        return sDefinition; 
+    }
+    using TVertexType = SpriteInstance3D;
+    // initialzie definition
+    inline void Setup()
+    {
+        this->mDataStride = Sizeof_SpriteInstance3D;
+        this->SetAttribute(eVertexAttribute_Position0, eVertexAttributeFormat_3F, offsetof(TVertexType, mOriginHeight));
+        this->SetAttribute(eVertexAttribute_Position1, eVertexAttributeFormat_4H, offsetof(TVertexType, mAxes));
+        this->SetAttribute(eVertexAttribute_Texcoord0, eVertexAttributeFormat_4US, offsetof(TVertexType, mTexcoords));
+        this->SetAttributeNormalized(eVertexAttribute_Texcoord0);
+        this->SetAttribute(eVertexAttribute_Color0, eVertexAttributeFormat_1US, offsetof(TVertexType, mClutIndex));
+        for (eVertexAttribute attribute: {eVertexAttribute_Position0, eVertexAttribute_Position1, eVertexAttribute_Texcoord0,
+            eVertexAttribute_Color0})
+        {
+            this->SetAttributePerInstance(attribute);
+        }
+    }
 };
\ No newline at end of file
@@ -16,13 +16,21 @@ extern CvarPoint gCvarGraphicsScreenDims; // screen dimensions
 extern CvarBoolean gCvarGraphicsFullscreen; // is fullscreen mode enabled
 extern CvarBoolean gCvarGraphicsVSync; // is vertical synchronization enabled
 extern CvarBoolean gCvarGraphicsTexFiltering; // is texture filtering enabled
+extern CvarBoolean gCvarGraphicsMergeCityMeshFaces; // merge adjacent city mesh lids with same texture
+extern CvarInt gCvarGraphicsSpriteCacheBudget; // memory budget of sprites with deltas atlas, kilobytes
+extern CvarBoolean gCvarGraphicsSpritesInstancing; // expand map sprites to quads on gpu when supported
 
 // physics
 extern CvarFloat gCvarPhysicsFramerate; // physical world update framerate
+extern CvarBoolean gCvarPhysicsMergeMapShapes; // merge adjacent map block columns into single collision shape
 
 // memory
 extern CvarBoolean gCvarMemEnableFrameHeapAllocator; // enable frame heap allocator
 
+// jobs
+extern CvarInt gCvarSysWorkerThreads; // number of worker threads
+extern CvarInt gCvarSysHeadlessFrames; // number of frames to simulate in headless mode
+
 // audio
 extern CvarBoolean gCvarAudioActive; // enable audio system
 extern CvarEnum<eGameMusicMode> gCvarGameMusicMode; // ingame music mode
@@ -36,13 +44,22 @@ extern CvarString gCvarCurrentBaseDir; // current gta data location
 extern CvarEnum<eGtaGameVersion> gCvarGameVersion; // current gta game version
 extern CvarString gCvarGameLanguage; // current game language
 extern CvarInt gCvarNumPlayers; // number of players in split screen mode
+extern CvarInt gCvarRandomSeed; // game randomizer seed
+extern CvarString gCvarReplayRecord; // replay file to record game session
+extern CvarString gCvarReplayPlayback; // replay file to play back game session
 extern CvarBoolean gCvarWeatherActive; // whether weather effects enabled
 extern CvarEnum<eWeatherEffect> gCvarWeatherEffect; // currently active weather
 extern CvarBoolean gCvarCarSparksActive; // enable car sparks effect
+extern CvarBoolean gCvarTrafficAdaptiveDensity; // scale traffic density to hold target frame time
+extern CvarFloat gCvarTrafficTargetFrameTime; // target frame time for adaptive traffic density, milliseconds
+extern CvarFloat gCvarTrafficDensityScale; // current traffic density scale
 
 // ui
 extern CvarFloat gCvarUiScale; // ui elements scale factor
 
+// debug
+extern CvarBoolean gCvarDbgProfiler; // enable frame profiler
+
 //////////////////////////////////////////////////////////////////////////
 // console commands
 //////////////////////////////////////////////////////////////////////////
@@ -55,6 +72,15 @@ extern CvarVoid gCvarDbgDumpSpriteDeltas; // dump sprite deltas
 extern CvarVoid gCvarDbgDumpBlockTextures; // dump block textures
 extern CvarVoid gCvarDbgDumpSprites; // dump all sprites
 extern CvarVoid gCvarDbgDumpCarSprites; // dump car sprites
+extern CvarVoid gCvarDbgBenchDestroyObjects; // benchmark game objects destruction
+extern CvarVoid gCvarDbgBenchMapCollision; // benchmark map collision shape
+extern CvarVoid gCvarDbgBenchMapMesh; // benchmark city mesh generation
+extern CvarVoid gCvarDbgBenchMapQueries; // benchmark frequent map queries
+extern CvarVoid gCvarDbgBenchNavigation; // benchmark navigation path queries
+extern CvarVoid gCvarDbgBenchPhysicsStep; // benchmark physics simulation step
+extern CvarVoid gCvarDbgBenchSpatialQueries; // benchmark game objects spatial queries
+extern CvarVoid gCvarDbgBenchSpriteSort; // benchmark sprites sorting and batching
+extern CvarVoid gCvarDbgProfilerCapture; // capture profiler frames to chrome trace file
 
 //////////////////////////////////////////////////////////////////////////
 
@@ -65,8 +91,14 @@ inline void CvarsRegisterGlobal()
     gConsole.RegisterVariable(&gCvarGraphicsFullscreen);
     gConsole.RegisterVariable(&gCvarGraphicsVSync);
     gConsole.RegisterVariable(&gCvarGraphicsTexFiltering);
+    gConsole.RegisterVariable(&gCvarGraphicsMergeCityMeshFaces);
+    gConsole.RegisterVariable(&gCvarGraphicsSpriteCacheBudget);
+    gConsole.RegisterVariable(&gCvarGraphicsSpritesInstancing);
     gConsole.RegisterVariable(&gCvarPhysicsFramerate);
+    gConsole.RegisterVariable(&gCvarPhysicsMergeMapShapes);
     gConsole.RegisterVariable(&gCvarMemEnableFrameHeapAllocator);
+    gConsole.RegisterVariable(&gCvarSysWorkerThreads);
+    gConsole.RegisterVariable(&gCvarSysHeadlessFrames);
     gConsole.RegisterVariable(&gCvarAudioActive);
     gConsole.RegisterVariable(&gCvarGtaDataPath);
     gConsole.RegisterVariable(&gCvarMapname);
@@ -74,14 +106,21 @@ inline void CvarsRegisterGlobal()
     gConsole.RegisterVariable(&gCvarGameVersion);
     gConsole.RegisterVariable(&gCvarGameLanguage);
     gConsole.RegisterVariable(&gCvarNumPlayers);
+    gConsole.RegisterVariable(&gCvarRandomSeed);
+    gConsole.RegisterVariable(&gCvarReplayRecord);
+    gConsole.RegisterVariable(&gCvarReplayPlayback);
     gConsole.RegisterVariable(&gCvarWeatherActive);
     gConsole.RegisterVariable(&gCvarWeatherEffect);
     gConsole.RegisterVariable(&gCvarGameMusicMode);
     gConsole.RegisterVariable(&gCvarCarSparksActive);
+    gConsole.RegisterVariable(&gCvarTrafficAdaptiveDensity);
+    gConsole.RegisterVariable(&gCvarTrafficTargetFrameTime);
+    gConsole.RegisterVariable(&gCvarTrafficDensityScale);
     gConsole.RegisterVariable(&gCvarMouseAiming);
     gConsole.RegisterVariable(&gCvarMusicVolume);
     gConsole.RegisterVariable(&gCvarSoundsVolume);
     gConsole.RegisterVariable(&gCvarUiScale);
+    gConsole.RegisterVariable(&gCvarDbgProfiler);
     // commands
     gConsole.RegisterVariable(&gCvarSysQuit);
     gConsole.RegisterVariable(&gCvarSysListCvars);
@@ -89,4 +128,13 @@ inline void CvarsRegisterGlobal()
     gConsole.RegisterVariable(&gCvarDbgDumpBlockTextures);
     gConsole.RegisterVariable(&gCvarDbgDumpSprites);
     gConsole.RegisterVariable(&gCvarDbgDumpCarSprites);
+    gConsole.RegisterVariable(&gCvarDbgBenchDestroyObjects);
+    gConsole.RegisterVariable(&gCvarDbgBenchMapCollision);
+    gConsole.RegisterVariable(&gCvarDbgBenchMapMesh);
+    gConsole.RegisterVariable(&gCvarDbgBenchMapQueries);
+    gConsole.RegisterVariable(&gCvarDbgBenchNavigation);
+    gConsole.RegisterVariable(&gCvarDbgBenchPhysicsStep);
+    gConsole.RegisterVariable(&gCvarDbgBenchSpatialQueries);
+    gConsole.RegisterVariable(&gCvarDbgBenchSpriteSort);
+    gConsole.RegisterVariable(&gCvarDbgProfilerCapture);
 }
\ No newline at end of file
@@ -218,6 +218,7 @@ impl_enum_strings(eVertexAttributeFormat)
     {eVertexAttributeFormat_1US, "1us"},
     {eVertexAttributeFormat_2US, "2us"},
     {eVertexAttributeFormat_4US, "4us"},
+    {eVertexAttributeFormat_4H, "4h"},
     {eVertexAttributeFormat_Unknown, "unknown"},
 };
 
@@ -646,4 +647,24 @@ impl_enum_strings(eGameMusicMode)
     {eGameMusicMode_Disabled, "disabled"},
     {eGameMusicMode_Radio, "radio"},
     {eGameMusicMode_Constant, "constant"},
+};
+
+impl_enum_strings(eGameplaySubsystem)
+{
+    {eGameplaySubsystem_BlocksAnimations, "blocks_animations"},
+    {eGameplaySubsystem_Physics, "physics"},
+    {eGameplaySubsystem_GameObjects, "game_objects"},
+    {eGameplaySubsystem_Weather, "weather"},
+    {eGameplaySubsystem_Particles, "particles"},
+    {eGameplaySubsystem_Navigation, "navigation"},
+    {eGameplaySubsystem_Traffic, "traffic"},
+    {eGameplaySubsystem_Ai, "ai"},
+    {eGameplaySubsystem_BroadcastEvents, "broadcast_events"},
+};
+
+impl_enum_strings(eAiLodTier)
+{
+    {eAiLodTier_Near, "near"},
+    {eAiLodTier_Mid, "mid"},
+    {eAiLodTier_Far, "far"},
 };
\ No newline at end of file
@@ -12,6 +12,15 @@ namespace cxx
         return true;
     }
 
+    template<typename TValue>
+    inline bool write_to_stream(std::ostream& outstream, const TValue& inputValue)
+    {
+        if (!outstream.write(reinterpret_cast<const char*>(&inputValue), sizeof(inputValue)))
+            return false;
+
+        return true;
+    }
+
 } // namespace cxx
 
 // helpers